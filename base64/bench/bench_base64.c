@@ -0,0 +1,135 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "base64.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC  1
+#else
+#define BENCH_HAVE_TSC  0
+#endif
+
+/**
+ * @brief   Base64性能测试
+ * @note    遍历 输入长度 x 内核(字符集) x 合法/非法输入，输出 GB/s 以及 cycles/byte
+ * @note    cycles 使用TSC计数，在变频的CPU上与核心周期存在偏差，仅用于横向对比
+ * @note    ./bench_base64 [每组测试的总字节数, 默认64MB]
+*/
+
+// 测试的输入长度
+static const size_t bench_sizes[] = {16, 64, 256, 1024, 4096, 65536, 1 << 20};
+
+// 防止编译器把结果优化掉
+static volatile size_t bench_sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t now_cycles(void)
+{
+#if BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 单项测试结果
+typedef struct
+{
+    double gbps;
+    double cpb;
+}stc_bench_result_t;
+
+/**
+ * @brief   重复执行 encode 或 decode 直到处理完 total 字节
+ * @param   [in] raw_bytes  每次调用对应的原始数据字节数，统一按原始数据计算吞吐
+*/
+static stc_bench_result_t bench_run(const base64_kernel_t *k, int decode,
+                                    const void *in, size_t in_len, void *out, size_t out_size,
+                                    size_t raw_bytes, size_t total)
+{
+    size_t iters = total / (raw_bytes ? raw_bytes : 1) + 1;
+    size_t n = 0;
+    // 预热
+    for (size_t i = 0; i < 16; i++)
+    {
+        if (decode) k->decode(in, in_len, out, out_size, &n);
+        else        k->encode(in, in_len, out, out_size, &n);
+    }
+    double t0 = now_sec();
+    uint64_t c0 = now_cycles();
+    for (size_t i = 0; i < iters; i++)
+    {
+        if (decode) bench_sink += (size_t)k->decode(in, in_len, out, out_size, &n);
+        else        bench_sink += (size_t)k->encode(in, in_len, out, out_size, &n);
+    }
+    uint64_t c1 = now_cycles();
+    double t1 = now_sec();
+    bench_sink += n;
+
+    double bytes = (double)iters * (double)raw_bytes;
+    stc_bench_result_t r;
+    r.gbps = bytes / (t1 - t0) / 1e9;
+    r.cpb = BENCH_HAVE_TSC ? (double)(c1 - c0) / bytes : 0.0;
+    return r;
+}
+
+static void bench_print(const base64_kernel_t *k, const char *op, size_t size, stc_bench_result_t r)
+{
+    printf("%-10s %-10s %-14s %9zu %10.3f %10.3f\n", k->name, k->codec->name, op, size, r.gbps, r.cpb);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t total = argc > 1 ? (size_t)strtoull(argv[1], NULL, 0) : (size_t)64 << 20;
+    size_t max_size = bench_sizes[sizeof(bench_sizes) / sizeof(bench_sizes[0]) - 1];
+
+    uint8_t *raw = malloc(max_size);
+    char *enc = malloc(base64_encoded_len(max_size));
+    char *bad = malloc(base64_encoded_len(max_size));
+    uint8_t *dec = malloc(max_size);
+    srand(1);
+    for (size_t i = 0; i < max_size; i++)
+    {
+        raw[i] = (uint8_t)rand();
+    }
+
+    printf("%-10s %-10s %-14s %9s %10s %10s\n", "kernel", "alphabet", "op", "bytes", "GB/s", "cyc/byte");
+    for (size_t k = 0; k < base64_kernel_count; k++)
+    {
+        const base64_kernel_t *kernel = &base64_kernels[k];
+        if (kernel->supported && !kernel->supported())
+        {
+            continue;
+        }
+        for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++)
+        {
+            size_t size = bench_sizes[s];
+            size_t enc_len = 0;
+            kernel->encode(raw, size, enc, kernel->codec->encoded_len(size), &enc_len);
+            bench_print(kernel, "encode", size,
+                        bench_run(kernel, 0, raw, size, enc, enc_len, size, total));
+            bench_print(kernel, "decode", size,
+                        bench_run(kernel, 1, enc, enc_len, dec, size, size, total));
+            // 非法输入: 非法字符位于末尾，需要扫描完整个输入才能拒绝
+            memcpy(bad, enc, enc_len);
+            bad[enc_len - 5] = '*';
+            bench_print(kernel, "decode-invalid", size,
+                        bench_run(kernel, 1, bad, enc_len, dec, size, size, total));
+        }
+    }
+
+    free(raw);
+    free(enc);
+    free(bad);
+    free(dec);
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "base64.h"
+
+/**
+ * @brief   Base64差分模糊测试
+ * @note    每个已注册的内核都与参考实现 base64_encode / base64_decode 对比，
+ *          并检查 编码->解码 以及 原地解码 的往返结果
+ * @note    libFuzzer:  cmake -D BASE64_FUZZ_LIBFUZZER=ON -D CMAKE_C_COMPILER=clang ..
+ *                      ./fuzz_base64 corpus/
+ * @note    AFL:        CC=afl-clang-fast cmake .. && make fuzz_base64
+ *                      afl-fuzz -i corpus -o findings -- ./fuzz_base64 @@
+ * @note    本地随机:   ./fuzz_base64 -n 100000   (不需要任何外部依赖)
+*/
+
+// 差分失败时直接abort，便于fuzzer保存触发的输入
+#define FUZZ_CHECK(cond, kernel, what)                                          \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            fprintf(stderr, "[%s/%s] %s failed: %s\n",                          \
+                    (kernel)->name, (kernel)->codec->name, what, #cond);        \
+            abort();                                                            \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief   把变体的字符映射为标准字符集，使参考实现可以处理所有变体
+ * @return  映射后的字符，不属于该变体字符集的字符原样返回'*'
+*/
+static char to_std_char(const base64_codec_t *codec, char c)
+{
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) return c;
+    if (c == codec->c62) return '+';
+    if (c == codec->c63) return '/';
+    return '*';
+}
+
+/**
+ * @brief   独立于所有内核的合法性判断
+ * @return  合法时返回解码后的长度，非法返回-1
+*/
+static long reference_validate(const base64_codec_t *codec, const char *s, size_t len)
+{
+    size_t pad = 0;
+    if (codec->padded)
+    {
+        if (len % 4 != 0) return -1;
+        if (len == 0) return 0;
+        if (s[len - 1] == '=') pad++;
+        if (s[len - 1] == '=' && s[len - 2] == '=') pad++;
+    }
+    else if (len % 4 == 1)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < len - pad; i++)
+    {
+        if (to_std_char(codec, s[i]) == '*') return -1;
+    }
+    if (codec->padded) return (long)(len / 4 * 3 - pad);
+    return (long)(len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0));
+}
+
+/**
+ * @brief   参考编码: 标准编码后替换字符并按需去掉填充
+*/
+static size_t reference_encode(const base64_codec_t *codec, const uint8_t *data, size_t size, char *out)
+{
+    base64_encode(data, size, out);
+    size_t n = 0;
+    for (size_t i = 0; out[i] != '\0'; i++)
+    {
+        if (out[i] == '=' && !codec->padded) continue;
+        out[n++] = out[i] == '+' ? codec->c62 : out[i] == '/' ? codec->c63 : out[i];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief   把原始数据当作二进制进行编码往返测试
+*/
+static void fuzz_roundtrip(const base64_kernel_t *k, const uint8_t *data, size_t size)
+{
+    const base64_codec_t *codec = k->codec;
+    size_t enc_len = codec->encoded_len(size);
+    // 参考实现总是带填充，按标准长度分配
+    char *ref = malloc(base64_encoded_len(size) + 1);
+    char *enc = malloc(enc_len + 1);
+    uint8_t *dec = malloc(size + 1);
+
+    FUZZ_CHECK(reference_encode(codec, data, size, ref) == enc_len, k, "encoded_len");
+
+    // 输出缓冲区少1字节必须报错
+    size_t n = 0;
+    if (enc_len > 0)
+    {
+        FUZZ_CHECK(k->encode(data, size, enc, enc_len - 1, &n) == BASE64_ERR_SPACE, k, "encode bound");
+    }
+    FUZZ_CHECK(k->encode(data, size, enc, enc_len, &n) == BASE64_OK, k, "encode");
+    FUZZ_CHECK(n == enc_len && memcmp(enc, ref, enc_len) == 0, k, "encode diff");
+
+    FUZZ_CHECK(codec->decoded_len(enc, enc_len) == size, k, "decoded_len");
+    if (size > 0)
+    {
+        FUZZ_CHECK(k->decode(enc, enc_len, dec, size - 1, &n) == BASE64_ERR_SPACE, k, "decode bound");
+    }
+    FUZZ_CHECK(k->decode(enc, enc_len, dec, size, &n) == BASE64_OK, k, "decode");
+    FUZZ_CHECK(n == size && memcmp(dec, data, size) == 0, k, "roundtrip");
+
+    // 原地解码: 输出直接写回编码缓冲区
+    FUZZ_CHECK(k->decode(enc, enc_len, (uint8_t *)enc, enc_len, &n) == BASE64_OK, k, "inplace");
+    FUZZ_CHECK(n == size && memcmp(enc, data, size) == 0, k, "inplace roundtrip");
+
+    free(ref);
+    free(enc);
+    free(dec);
+}
+
+/**
+ * @brief   把原始数据当作Base64文本进行解码测试
+ * @note    合法性以 reference_validate 为准，合法时结果必须与参考实现一致
+*/
+static void fuzz_decode(const base64_kernel_t *k, const uint8_t *data, size_t size)
+{
+    const char *text = (const char *)data;
+    long expect = reference_validate(k->codec, text, size);
+    uint8_t *dec = malloc(size + 1);
+    size_t n = 0;
+    int ret = k->decode(text, size, dec, size, &n);
+    if (expect < 0)
+    {
+        FUZZ_CHECK(ret == BASE64_ERR_INPUT, k, "reject invalid");
+    }
+    else
+    {
+        FUZZ_CHECK(ret == BASE64_OK && n == (size_t)expect, k, "accept valid");
+        if (size > 0)
+        {
+            // 参考实现要求标准字符集、带填充并以'\0'结尾
+            char *str = malloc(size + 4);
+            uint8_t *ref = malloc(size + 4);
+            int ref_len = 0;
+            size_t len = 0;
+            for (; len < size; len++)
+            {
+                str[len] = text[len] == '=' ? '=' : to_std_char(k->codec, text[len]);
+            }
+            while (len % 4 != 0)
+            {
+                str[len++] = '=';
+            }
+            str[len] = '\0';
+            base64_decode(str, ref, &ref_len);
+            FUZZ_CHECK((size_t)ref_len == n && memcmp(ref, dec, n) == 0, k, "decode diff");
+            free(str);
+            free(ref);
+        }
+    }
+    free(dec);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < base64_kernel_count; i++)
+    {
+        if (base64_kernels[i].supported && !base64_kernels[i].supported())
+        {
+            continue;
+        }
+        fuzz_roundtrip(&base64_kernels[i], data, size);
+        fuzz_decode(&base64_kernels[i], data, size);
+    }
+    return 0;
+}
+
+#ifndef BASE64_FUZZ_LIBFUZZER
+/**
+ * @brief   生成偏向Base64字符集的随机输入，提高命中合法输入的概率
+*/
+static size_t random_input(uint8_t *buf, size_t cap, unsigned int *seed)
+{
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/-_";
+    size_t len = (size_t)rand_r(seed) % cap;
+    int mode = rand_r(seed) % 4;
+    if (mode >= 2)
+    {
+        // 对齐到4的倍数，并按概率添加填充符
+        len &= ~(size_t)3;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = mode == 0 ? (uint8_t)rand_r(seed) : (uint8_t)chars[rand_r(seed) % 66];
+    }
+    if (mode == 2 && len >= 4)
+    {
+        buf[len - 1] = '=';
+        if (rand_r(seed) & 1) buf[len - 2] = '=';
+    }
+    if (mode == 3 && len > 0)
+    {
+        // 随机位置插入一个非法字符
+        buf[(size_t)rand_r(seed) % len] = "=*. \n\x80"[rand_r(seed) % 6];
+    }
+    return len;
+}
+
+/**
+ * @brief   独立运行入口
+ * @note    ./fuzz_base64 file...       逐个执行文件(AFL 的 @@ 方式)
+ * @note    ./fuzz_base64               从标准输入读取一个用例
+ * @note    ./fuzz_base64 -n N [seed]   本地执行N轮随机差分测试
+*/
+int main(int argc, char *argv[])
+{
+    static uint8_t buf[1 << 16];
+    if (argc >= 3 && strcmp(argv[1], "-n") == 0)
+    {
+        long rounds = strtol(argv[2], NULL, 0);
+        unsigned int seed = argc >= 4 ? (unsigned int)strtoul(argv[3], NULL, 0) : 1;
+        for (long r = 0; r < rounds; r++)
+        {
+            size_t len = random_input(buf, 512, &seed);
+            LLVMFuzzerTestOneInput(buf, len);
+        }
+        printf("%ld rounds x %zu kernels passed\n", rounds, base64_kernel_count);
+        return 0;
+    }
+    if (argc == 1)
+    {
+        size_t len = fread(buf, 1, sizeof(buf), stdin);
+        LLVMFuzzerTestOneInput(buf, len);
+        return 0;
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *fp = fopen(argv[i], "rb");
+        if (fp == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        size_t len = fread(buf, 1, sizeof(buf), fp);
+        fclose(fp);
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    return 0;
+}
+#endif
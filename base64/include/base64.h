@@ -0,0 +1,138 @@
+#ifndef BASE64_H_
+#define BASE64_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Base64接口返回值
+*/
+// 成功
+#define BASE64_OK           0
+// 无效的Base64输入(长度不是4的倍数、非法字符或填充位置错误)
+#define BASE64_ERR_INPUT    -1
+// 输出缓冲区空间不足
+#define BASE64_ERR_SPACE    -2
+
+/**
+ * @brief   编码后长度的常量表达式版本，可用于定义数组
+*/
+#define BASE64_ENCODED_LEN(len)     ((((len) + 2) / 3) * 4)
+
+/**
+ * @brief   计算编码后的精确长度
+ * @param   [in] len    原始数据长度
+ * @return  编码后的字符数(不包含字符串结束符'\0')
+*/
+size_t base64_encoded_len(size_t len);
+
+/**
+ * @brief   计算解码后的精确长度
+ * @param   [in] input  Base64字符串(不要求以'\0'结尾)
+ * @param   [in] len    Base64字符串长度
+ * @return  解码后的字节数，长度不是4的倍数时返回0
+ * @note    只根据长度以及末尾的填充符'='计算，不校验字符的合法性
+*/
+size_t base64_decoded_len(const char *input, size_t len);
+
+/**
+ * @brief   Base64编码(带边界检查)
+ * @param   [in]  input     原始数据
+ * @param   [in]  len       原始数据长度
+ * @param   [out] output    输出缓冲区
+ * @param   [in]  out_size  输出缓冲区大小
+ * @param   [out] out_len   实际写入的字符数，可以传入NULL
+ * @return  BASE64_OK 或 BASE64_ERR_SPACE
+ * @note    不写入字符串结束符，需要时由调用者根据 out_len 自行补充
+*/
+int base64_encode_buf(const uint8_t *input, size_t len, char *output, size_t out_size, size_t *out_len);
+
+/**
+ * @brief   Base64解码(带边界检查以及字符校验)
+ * @param   [in]  input     Base64字符串(不要求以'\0'结尾)
+ * @param   [in]  len       Base64字符串长度
+ * @param   [out] output    输出缓冲区
+ * @param   [in]  out_size  输出缓冲区大小
+ * @param   [out] out_len   实际写入的字节数，可以传入NULL
+ * @return  BASE64_OK / BASE64_ERR_INPUT / BASE64_ERR_SPACE
+ * @note    支持原地解码：output 可以等于 input，解码结果总是不长于输入，
+ *          写指针永远落后于读指针，可以直接在接收缓冲区内解码而不需要额外内存
+*/
+int base64_decode_buf(const char *input, size_t len, uint8_t *output, size_t out_size, size_t *out_len);
+
+/**
+ * @brief   原地解码
+ * @param   [in/out] buf    Base64字符串，解码后的数据从 buf 起始处写入
+ * @param   [in]     len    Base64字符串长度
+ * @param   [out]    out_len 解码后的字节数，可以传入NULL
+ * @return  BASE64_OK 或 BASE64_ERR_INPUT
+*/
+int base64_decode_inplace(char *buf, size_t len, size_t *out_len);
+
+/**
+ * @brief   Base64字符集变体
+ * @note    字符集以及填充方式在编译期确定，每个变体拥有独立的常量表以及SIMD掩码，
+ *          运行时通过选择不同的变体切换字符集，内循环中没有任何与字符集相关的分支
+ * @note    解码支持原地解码：codec->decode(buf, len, (uint8_t *)buf, len, &n)
+*/
+typedef struct
+{
+    const char *name;       // 变体名称
+    char c62;               // 第62个字符
+    char c63;               // 第63个字符
+    int padded;             // 是否使用'='填充
+    size_t (*encoded_len)(size_t len);
+    size_t (*decoded_len)(const char *input, size_t len);
+    int (*encode)(const uint8_t *input, size_t len, char *output, size_t out_size, size_t *out_len);
+    int (*decode)(const char *input, size_t len, uint8_t *output, size_t out_size, size_t *out_len);
+}base64_codec_t;
+
+// RFC 4648 标准Base64 "+/" 带填充，等价于 base64_encode_buf / base64_decode_buf
+extern const base64_codec_t base64_std_codec;
+// 标准字符集 "+/" 不填充
+extern const base64_codec_t base64_std_nopad_codec;
+// RFC 4648 base64url "-_" 带填充
+extern const base64_codec_t base64_url_codec;
+// RFC 4648 base64url "-_" 不填充，常用于token
+extern const base64_codec_t base64_url_nopad_codec;
+
+/**
+ * @brief   Base64编解码内核
+ * @note    同一变体的不同实现(标量、SIMD等)，用于性能测试以及差分测试
+*/
+typedef struct
+{
+    const char *name;               // 内核名称
+    const base64_codec_t *codec;    // 所属变体
+    int (*supported)(void);         // 当前CPU是否支持，NULL表示总是支持
+    int (*encode)(const uint8_t *input, size_t len, char *output, size_t out_size, size_t *out_len);
+    int (*decode)(const char *input, size_t len, uint8_t *output, size_t out_size, size_t *out_len);
+}base64_kernel_t;
+
+// 所有已注册的内核
+extern const base64_kernel_t base64_kernels[];
+// 已注册的内核数量
+extern const size_t base64_kernel_count;
+
+/**
+ * @brief   Base64编码(旧接口)
+ * @note    output 至少需要 base64_encoded_len(len) + 1 字节，末尾写入'\0'
+*/
+void base64_encode(const unsigned char *input, size_t len, char *output);
+
+/**
+ * @brief   Base64解码(旧接口)
+ * @note    input 必须以'\0'结尾，不校验字符以及输出缓冲区大小
+*/
+int base64_decode(const char *input, unsigned char *output, int *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include "debug_log.h"
+#include "base64.h"
 
 #define STRING_DATA 1
 #define BYTE_ARRAY  2
@@ -27,77 +28,22 @@
  * @result  结果输出： 00000000: 48 65 6C 6C 6F 20 57 6F 72 6C 64                 Hello World
  */
 
-// Base64字符集
-static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-// Base64解码表
-static const unsigned char base64_table[256] = {
-    ['A'] = 0,  ['B'] = 1,  ['C'] = 2,  ['D'] = 3,  ['E'] = 4,  ['F'] = 5,  ['G'] = 6,  ['H'] = 7,
-    ['I'] = 8,  ['J'] = 9,  ['K'] = 10, ['L'] = 11, ['M'] = 12, ['N'] = 13, ['O'] = 14, ['P'] = 15,
-    ['Q'] = 16, ['R'] = 17, ['S'] = 18, ['T'] = 19, ['U'] = 20, ['V'] = 21, ['W'] = 22, ['X'] = 23,
-    ['Y'] = 24, ['Z'] = 25, ['a'] = 26, ['b'] = 27, ['c'] = 28, ['d'] = 29, ['e'] = 30, ['f'] = 31,
-    ['g'] = 32, ['h'] = 33, ['i'] = 34, ['j'] = 35, ['k'] = 36, ['l'] = 37, ['m'] = 38, ['n'] = 39,
-    ['o'] = 40, ['p'] = 41, ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45, ['u'] = 46, ['v'] = 47,
-    ['w'] = 48, ['x'] = 49, ['y'] = 50, ['z'] = 51, ['0'] = 52, ['1'] = 53, ['2'] = 54, ['3'] = 55,
-    ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59, ['8'] = 60, ['9'] = 61, ['+'] = 62, ['/'] = 63
-};
-
-// Base64编码函数
-void base64_encode(const unsigned char *input, size_t len, char *output) {
-    char *p = output;
-    for (size_t i = 0; i < len; i += 3) {
-        unsigned int v = input[i] << 16;
-        v |= (i + 1 < len ? input[i + 1] << 8 : 0);
-        v |= (i + 2 < len ? input[i + 2] : 0);
-
-        *p++ = base64_chars[(v >> 18) & 0x3F];
-        *p++ = base64_chars[(v >> 12) & 0x3F];
-        *p++ = (i + 1 < len ? base64_chars[(v >> 6) & 0x3F] : '=');
-        *p++ = (i + 2 < len ? base64_chars[v & 0x3F] : '=');
-    }
-    *p = '\0';
-}
-
-// Base64解码函数
-int base64_decode(const char *input, unsigned char *output, int *out_len) {
-    size_t len = strlen(input);
-    if (len % 4 != 0) return -1; // 无效的Base64输入
-
-    size_t decoded_len = len / 4 * 3;
-    if (input[len - 1] == '=') decoded_len--;
-    if (input[len - 2] == '=') decoded_len--;
-
-    unsigned char *p = output;
-    for (size_t i = 0; i < len; i += 4) {
-        unsigned int v = base64_table[(unsigned char)input[i]] << 18;
-        v |= base64_table[(unsigned char)input[i + 1]] << 12;
-        v |= input[i + 2] == '=' ? 0 : base64_table[(unsigned char)input[i + 2]] << 6;
-        v |= input[i + 3] == '=' ? 0 : base64_table[(unsigned char)input[i + 3]];
-
-        *p++ = (v >> 16) & 0xFF;
-        if (input[i + 2] != '=') *p++ = (v >> 8) & 0xFF;
-        if (input[i + 3] != '=') *p++ = v & 0xFF;
-    }
-
-    *out_len = p - output;
-    return 0;
-}
-
-
 int main(void)
 {
     // 彩色打印Demo
     // debug_log_demo();
 // 字符串 编解码测试
 #if RAW_DATA_TYPE == STRING_DATA
-    const unsigned char *text = (unsigned char *)"Hello, World!";
-    char encoded[256];
-    unsigned char decoded[256];
-    // ** 传入实际字符串的长度
-    base64_encode(text, strlen((const char *)text), encoded);
-    DBG_LOGI("Encoded: %s, len= %d", encoded, (int)strlen(encoded));
-    int decoded_len = 0;
-    if (base64_decode(encoded, decoded, &decoded_len) == 0)
+    const char text[] = "Hello, World!";
+    // ** 传入实际字符串的长度(不包含'\0')
+    char encoded[BASE64_ENCODED_LEN(sizeof(text) - 1)];
+    size_t encoded_len = 0;
+    base64_encode_buf((const uint8_t *)text, sizeof(text) - 1, encoded, sizeof(encoded), &encoded_len);
+    DBG_LOGI("Encoded: %.*s, len= %d", (int)encoded_len, encoded, (int)encoded_len);
+    // 解码前即可得到精确的输出长度
+    uint8_t decoded[BASE64_ENCODED_LEN(sizeof(text) - 1)];
+    size_t decoded_len = 0;
+    if (base64_decode_buf(encoded, encoded_len, decoded, base64_decoded_len(encoded, encoded_len), &decoded_len) == BASE64_OK)
     {
         DBG_LOGI("Decoded String: %.*s", (int)decoded_len, decoded);
     }
@@ -110,17 +56,23 @@ int main(void)
 // 字节数组 编解码测试
 #if RAW_DATA_TYPE == BYTE_ARRAY
     const uint8_t text[] = {0x02, 0x01, 0x05, 0x03, 0x03, 0x54, 0x56, 0x0F, 0x09, 0x56, 0x69, 0x53, 0x4E, 0x5F, 0x53, 0x4C};
-    char encoded[256];
-    unsigned char decoded[256];
+    // 根据原始长度精确计算编码后的长度，不需要预留过大的缓冲区
+    char encoded[BASE64_ENCODED_LEN(sizeof(text))];
+    size_t encoded_len = 0;
     // ** 传入实际字节数组的长度
-    base64_encode(text, sizeof(text), encoded);
-    DBG_LOGI("Encoded: %s, len= %d", encoded, (int)strlen(encoded));
+    if (base64_encode_buf(text, sizeof(text), encoded, sizeof(encoded), &encoded_len) != BASE64_OK)
+    {
+        DBG_LOGE("Encode buffer too small");
+        return -1;
+    }
+    DBG_LOGI("Encoded: %.*s, len= %d", (int)encoded_len, encoded, (int)encoded_len);
 
-    int decoded_len = 0;
-    if (base64_decode(encoded, decoded, &decoded_len) == 0)
+    // 原地解码，解码结果直接覆盖编码缓冲区
+    size_t decoded_len = 0;
+    if (base64_decode_inplace(encoded, encoded_len, &decoded_len) == BASE64_OK)
     {
-        DBG_LOGI("Decoded Byte Array:  len= %d", decoded_len);
-        print_hex_table(decoded, decoded_len);
+        DBG_LOGI("Decoded Byte Array:  len= %d", (int)decoded_len);
+        print_hex_table((uint8_t *)encoded, decoded_len);
     }
     else
     {
@@ -0,0 +1,475 @@
+#include <string.h>
+#include "base64.h"
+
+// Base64字符集
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Base64解码表(旧接口使用，非法字符映射为0)
+static const unsigned char base64_table[256] = {
+    ['A'] = 0,  ['B'] = 1,  ['C'] = 2,  ['D'] = 3,  ['E'] = 4,  ['F'] = 5,  ['G'] = 6,  ['H'] = 7,
+    ['I'] = 8,  ['J'] = 9,  ['K'] = 10, ['L'] = 11, ['M'] = 12, ['N'] = 13, ['O'] = 14, ['P'] = 15,
+    ['Q'] = 16, ['R'] = 17, ['S'] = 18, ['T'] = 19, ['U'] = 20, ['V'] = 21, ['W'] = 22, ['X'] = 23,
+    ['Y'] = 24, ['Z'] = 25, ['a'] = 26, ['b'] = 27, ['c'] = 28, ['d'] = 29, ['e'] = 30, ['f'] = 31,
+    ['g'] = 32, ['h'] = 33, ['i'] = 34, ['j'] = 35, ['k'] = 36, ['l'] = 37, ['m'] = 38, ['n'] = 39,
+    ['o'] = 40, ['p'] = 41, ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45, ['u'] = 46, ['v'] = 47,
+    ['w'] = 48, ['x'] = 49, ['y'] = 50, ['z'] = 51, ['0'] = 52, ['1'] = 53, ['2'] = 54, ['3'] = 55,
+    ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59, ['8'] = 60, ['9'] = 61, ['+'] = 62, ['/'] = 63
+};
+
+/**
+ * @brief   编解码表在编译期生成
+ * @note    字符集的前62个字符固定为 A-Z a-z 0-9，第62、63个字符以及是否填充由变体决定，
+ *          每个变体都有自己独立的常量表，不需要在运行时翻译字符
+*/
+#define B64_INVALID     0xFF
+#define B64_ENC(i, c62, c63)                                \
+    ((i) < 26 ? 'A' + (i) :                                 \
+     (i) < 52 ? 'a' + (i) - 26 :                            \
+     (i) < 62 ? '0' + (i) - 52 :                            \
+     (i) == 62 ? (c62) : (c63))
+#define B64_DEC(c, c62, c63)                                \
+    ((c) >= 'A' && (c) <= 'Z' ? (c) - 'A' :                 \
+     (c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 26 :            \
+     (c) >= '0' && (c) <= '9' ? (c) - '0' + 52 :            \
+     (c) == (c62) ? 62 : (c) == (c63) ? 63 : B64_INVALID)
+#define B64_R4(f, n, a, b)  f(n, a, b), f((n) + 1, a, b), f((n) + 2, a, b), f((n) + 3, a, b)
+#define B64_R16(f, n, a, b) B64_R4(f, n, a, b), B64_R4(f, (n) + 4, a, b), B64_R4(f, (n) + 8, a, b), B64_R4(f, (n) + 12, a, b)
+#define B64_R64(f, n, a, b) B64_R16(f, n, a, b), B64_R16(f, (n) + 16, a, b), B64_R16(f, (n) + 32, a, b), B64_R16(f, (n) + 48, a, b)
+
+// 编译器展开模板函数，使字符集以及填充方式作为常量参与优化
+#define B64_INLINE  inline __attribute__((always_inline))
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+#define B64_HAVE_SSSE3  1
+#define B64_SSSE3       __attribute__((target("ssse3")))
+#else
+#define B64_HAVE_SSSE3  0
+#endif
+
+/**
+ * @brief   编码后的长度
+*/
+static B64_INLINE size_t b64_encoded_len(size_t len, int padded)
+{
+    return padded ? (len + 2) / 3 * 4 : len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0);
+}
+
+/**
+ * @brief   解码后的长度，长度非法时返回0
+*/
+static B64_INLINE size_t b64_decoded_len(const char *input, size_t len, int padded)
+{
+    if (padded)
+    {
+        if (len == 0 || len % 4 != 0)
+        {
+            return 0;
+        }
+        size_t n = len / 4 * 3;
+        if (input[len - 1] == '=') n--;
+        if (input[len - 2] == '=') n--;
+        return n;
+    }
+    return len / 4 * 3 + (len % 4 > 1 ? len % 4 - 1 : 0);
+}
+
+/**
+ * @brief   标量编码模板
+ * @param   [in] i      起始位置(SIMD处理之后剩余的部分)
+ * @return  写指针
+*/
+static B64_INLINE char *b64_encode_scalar(const uint8_t *input, size_t i, size_t len, char *p,
+                                          const char *enc, int padded)
+{
+    // 完整的3字节分组
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t v = (uint32_t)input[i] << 16 | (uint32_t)input[i + 1] << 8 | input[i + 2];
+        *p++ = enc[(v >> 18) & 0x3F];
+        *p++ = enc[(v >> 12) & 0x3F];
+        *p++ = enc[(v >> 6) & 0x3F];
+        *p++ = enc[v & 0x3F];
+    }
+    // 末尾剩余的1~2字节，按需补齐'='
+    if (i < len)
+    {
+        uint32_t v = (uint32_t)input[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)input[i + 1] << 8;
+        *p++ = enc[(v >> 18) & 0x3F];
+        *p++ = enc[(v >> 12) & 0x3F];
+        if (i + 1 < len)
+        {
+            *p++ = enc[(v >> 6) & 0x3F];
+        }
+        else if (padded)
+        {
+            *p++ = '=';
+        }
+        if (padded) *p++ = '=';
+    }
+    return p;
+}
+
+/**
+ * @brief   标量解码模板
+ * @param   [in/out] check  所有查表结果按位或，出现非法字符时最高位被置1
+ * @return  写指针
+ * @note    ** 先读完4个字符再写3个字节，保证原地解码时不会覆盖未读取的数据
+*/
+static B64_INLINE uint8_t *b64_decode_scalar(const uint8_t *s, size_t i, size_t len, uint8_t *p,
+                                             const uint8_t *dec, int padded, uint8_t *check)
+{
+    // 带填充时最后一组单独处理，不带填充时只剩下不足4个的字符
+    size_t full_end = padded ? len - 4 : len & ~(size_t)3;
+    uint8_t chk = *check;
+    for (; i < full_end; i += 4)
+    {
+        uint8_t a = dec[s[i]];
+        uint8_t b = dec[s[i + 1]];
+        uint8_t c = dec[s[i + 2]];
+        uint8_t d = dec[s[i + 3]];
+        chk |= a | b | c | d;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+        *p++ = (v >> 16) & 0xFF;
+        *p++ = (v >> 8) & 0xFF;
+        *p++ = v & 0xFF;
+    }
+    if (padded)
+    {
+        // 最后一组, 处理填充符
+        uint8_t a = dec[s[i]];
+        uint8_t b = dec[s[i + 1]];
+        uint8_t c = s[i + 2] == '=' && s[i + 3] == '=' ? 0 : dec[s[i + 2]];
+        uint8_t d = s[i + 3] == '=' ? 0 : dec[s[i + 3]];
+        chk |= a | b | c | d;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+        *p++ = (v >> 16) & 0xFF;
+        if (s[i + 2] != '=') *p++ = (v >> 8) & 0xFF;
+        if (s[i + 3] != '=') *p++ = v & 0xFF;
+    }
+    else if (i + 2 <= len)
+    {
+        // 剩余2~3个字符
+        uint8_t a = dec[s[i]];
+        uint8_t b = dec[s[i + 1]];
+        uint8_t c = i + 3 <= len ? dec[s[i + 2]] : 0;
+        chk |= a | b | c;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+        *p++ = (v >> 16) & 0xFF;
+        if (i + 3 <= len) *p++ = (v >> 8) & 0xFF;
+    }
+    *check = chk;
+    return p;
+}
+
+#if B64_HAVE_SSSE3
+/**
+ * @brief   SSSE3编码，每次处理12字节输入，输出16个字符
+ * @note    参考 Wojciech Muła 的 pshufb 查表法，第62、63个字符的偏移量由变体决定
+ * @param   [in/out] i  输入位置
+ * @return  写指针
+*/
+static B64_SSSE3 B64_INLINE char *b64_encode_ssse3(const uint8_t *input, size_t *i, size_t len, char *p,
+                                                   char c62, char c63)
+{
+    const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, (char)(c62 - 62), (char)(c63 - 63), 'A', 0, 0);
+    size_t n = *i;
+    // 每次读取16字节(只使用12字节)，保证不会越界读取
+    for (; n + 16 <= len; n += 12)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(input + n));
+        in = _mm_shuffle_epi8(in, shuf);
+        // 拆分为4个6bit索引
+        __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(t1, t3);
+        // 索引映射为字符
+        __m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+        r = _mm_or_si128(r, _mm_and_si128(less, _mm_set1_epi8(13)));
+        r = _mm_shuffle_epi8(shift_lut, r);
+        _mm_storeu_si128((__m128i *)p, _mm_add_epi8(r, idx));
+        p += 16;
+    }
+    *i = n;
+    return p;
+}
+
+/**
+ * @brief   SSSE3解码，每次处理16个字符，输出12字节
+ * @note    通过区间比较完成字符到6bit值的映射以及合法性检查，内循环没有分支
+ * @note    每组只写12字节，原地解码时写指针始终落后于读指针
+ * @param   [in/out] i      输入位置
+ * @param   [in/out] check  出现非法字符时最高位被置1
+ * @return  写指针
+*/
+static B64_SSSE3 B64_INLINE uint8_t *b64_decode_ssse3(const uint8_t *s, size_t *i, size_t len, uint8_t *p,
+                                                      char c62, char c63, uint8_t *check)
+{
+    const __m128i v62 = _mm_set1_epi8(c62);
+    const __m128i v63 = _mm_set1_epi8(c63);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    __m128i bad = _mm_setzero_si128();
+    size_t n = *i;
+    // 不处理最后一组，填充符以及不足4个的字符由标量代码处理
+    for (; n + 16 < len; n += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + n));
+        // 最高位为1的字符按有符号比较为负数，不会落入任何区间
+        __m128i az_u = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        __m128i az_l = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i is62 = _mm_cmpeq_epi8(v, v62);
+        __m128i is63 = _mm_cmpeq_epi8(v, v63);
+        __m128i shift = _mm_and_si128(az_u, _mm_set1_epi8(-'A'));
+        shift = _mm_or_si128(shift, _mm_and_si128(az_l, _mm_set1_epi8(26 - 'a')));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+        shift = _mm_or_si128(shift, _mm_and_si128(is62, _mm_set1_epi8((char)(62 - c62))));
+        shift = _mm_or_si128(shift, _mm_and_si128(is63, _mm_set1_epi8((char)(63 - c63))));
+        __m128i valid = _mm_or_si128(_mm_or_si128(az_u, az_l), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+        bad = _mm_or_si128(bad, _mm_cmpeq_epi8(valid, _mm_setzero_si128()));
+        __m128i val = _mm_add_epi8(v, shift);
+        // 4个6bit合并为3字节
+        __m128i merged = _mm_maddubs_epi16(val, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        merged = _mm_shuffle_epi8(merged, pack);
+        // 只写入12个有效字节，避免越界写
+        _mm_storel_epi64((__m128i *)p, merged);
+        uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(merged, 8));
+        memcpy(p + 8, &last, 4);
+        p += 12;
+    }
+    if (_mm_movemask_epi8(bad))
+    {
+        *check |= B64_INVALID;
+    }
+    *i = n;
+    return p;
+}
+
+static int b64_cpu_ssse3(void)
+{
+    return __builtin_cpu_supports("ssse3");
+}
+#endif
+
+/**
+ * @brief   带长度以及边界检查的编解码入口模板
+*/
+#define B64_ENCODE_BODY(simd)                                                   \
+    size_t need = b64_encoded_len(len, padded);                                 \
+    if (out_size < need)                                                        \
+    {                                                                           \
+        return BASE64_ERR_SPACE;                                                \
+    }                                                                           \
+    size_t i = 0;                                                               \
+    char *p = output;                                                           \
+    simd;                                                                       \
+    b64_encode_scalar(input, i, len, p, enc, padded);                           \
+    if (out_len) *out_len = need;                                               \
+    return BASE64_OK;
+
+#define B64_DECODE_BODY(simd)                                                   \
+    if ((padded && len % 4 != 0) || (!padded && len % 4 == 1))                  \
+    {                                                                           \
+        return BASE64_ERR_INPUT;                                                \
+    }                                                                           \
+    if (len == 0)                                                               \
+    {                                                                           \
+        if (out_len) *out_len = 0;                                              \
+        return BASE64_OK;                                                       \
+    }                                                                           \
+    if (out_size < b64_decoded_len(input, len, padded))                         \
+    {                                                                           \
+        return BASE64_ERR_SPACE;                                                \
+    }                                                                           \
+    const uint8_t *s = (const uint8_t *)input;                                  \
+    uint8_t *p = output;                                                        \
+    uint8_t check = 0;                                                          \
+    size_t i = 0;                                                               \
+    simd;                                                                       \
+    p = b64_decode_scalar(s, i, len, p, dec, padded, &check);                   \
+    if (check & 0x80)                                                           \
+    {                                                                           \
+        return BASE64_ERR_INPUT;                                                \
+    }                                                                           \
+    if (out_len) *out_len = (size_t)(p - output);                               \
+    return BASE64_OK;
+
+#if B64_HAVE_SSSE3
+#define B64_DEFINE_SSSE3(name, c62, c63, pad)                                                           \
+    static B64_SSSE3 int name##_encode_ssse3(const uint8_t *input, size_t len, char *output,            \
+                                             size_t out_size, size_t *out_len)                          \
+    {                                                                                                   \
+        const char *enc = name##_enc;                                                                   \
+        const int padded = pad;                                                                         \
+        B64_ENCODE_BODY(p = b64_encode_ssse3(input, &i, len, p, c62, c63))                              \
+    }                                                                                                   \
+    static B64_SSSE3 int name##_decode_ssse3(const char *input, size_t len, uint8_t *output,            \
+                                             size_t out_size, size_t *out_len)                          \
+    {                                                                                                   \
+        const uint8_t *dec = name##_dec;                                                                \
+        const int padded = pad;                                                                         \
+        B64_DECODE_BODY(p = b64_decode_ssse3(s, &i, len, p, c62, c63, &check))                          \
+    }
+#define B64_DISPATCH(name, op, ...) \
+    return b64_cpu_ssse3() ? name##_##op##_ssse3(__VA_ARGS__) : name##_##op##_scalar(__VA_ARGS__)
+#else
+#define B64_DEFINE_SSSE3(name, c62, c63, pad)
+#define B64_DISPATCH(name, op, ...) \
+    return name##_##op##_scalar(__VA_ARGS__)
+#endif
+
+/**
+ * @brief   生成一个字符集变体
+ * @param   name    变体名称
+ * @param   c62     第62个字符
+ * @param   c63     第63个字符
+ * @param   pad     是否使用'='填充
+ * @note    生成独立的编解码表、标量内核、SSSE3内核以及 base64_<name>_codec，
+ *          CPU特性只在函数入口判断一次，内循环中没有任何与字符集相关的分支
+*/
+#define BASE64_DEFINE_VARIANT(name, c62, c63, pad)                                                      \
+    static const char name##_enc[64] = { B64_R64(B64_ENC, 0, c62, c63) };                               \
+    static const uint8_t name##_dec[256] = {                                                            \
+        B64_R64(B64_DEC, 0, c62, c63), B64_R64(B64_DEC, 64, c62, c63),                                  \
+        B64_R64(B64_DEC, 128, c62, c63), B64_R64(B64_DEC, 192, c62, c63)                                \
+    };                                                                                                  \
+    static size_t name##_encoded_len(size_t len)                                                        \
+    {                                                                                                   \
+        return b64_encoded_len(len, pad);                                                               \
+    }                                                                                                   \
+    static size_t name##_decoded_len(const char *input, size_t len)                                     \
+    {                                                                                                   \
+        return b64_decoded_len(input, len, pad);                                                        \
+    }                                                                                                   \
+    static int name##_encode_scalar(const uint8_t *input, size_t len, char *output,                     \
+                                    size_t out_size, size_t *out_len)                                   \
+    {                                                                                                   \
+        const char *enc = name##_enc;                                                                   \
+        const int padded = pad;                                                                         \
+        B64_ENCODE_BODY((void)0)                                                                        \
+    }                                                                                                   \
+    static int name##_decode_scalar(const char *input, size_t len, uint8_t *output,                     \
+                                    size_t out_size, size_t *out_len)                                   \
+    {                                                                                                   \
+        const uint8_t *dec = name##_dec;                                                                \
+        const int padded = pad;                                                                         \
+        B64_DECODE_BODY((void)0)                                                                        \
+    }                                                                                                   \
+    B64_DEFINE_SSSE3(name, c62, c63, pad)                                                               \
+    static int name##_encode(const uint8_t *input, size_t len, char *output,                            \
+                             size_t out_size, size_t *out_len)                                          \
+    {                                                                                                   \
+        B64_DISPATCH(name, encode, input, len, output, out_size, out_len);                              \
+    }                                                                                                   \
+    static int name##_decode(const char *input, size_t len, uint8_t *output,                            \
+                             size_t out_size, size_t *out_len)                                          \
+    {                                                                                                   \
+        B64_DISPATCH(name, decode, input, len, output, out_size, out_len);                              \
+    }                                                                                                   \
+    const base64_codec_t base64_##name##_codec =                                                        \
+    {                                                                                                   \
+        #name, c62, c63, pad, name##_encoded_len, name##_decoded_len, name##_encode, name##_decode      \
+    };
+
+// RFC 4648 标准Base64
+BASE64_DEFINE_VARIANT(std, '+', '/', 1)
+// 标准字符集，不填充
+BASE64_DEFINE_VARIANT(std_nopad, '+', '/', 0)
+// RFC 4648 base64url
+BASE64_DEFINE_VARIANT(url, '-', '_', 1)
+// base64url，不填充(常用于token)
+BASE64_DEFINE_VARIANT(url_nopad, '-', '_', 0)
+
+size_t base64_encoded_len(size_t len)
+{
+    return std_encoded_len(len);
+}
+
+size_t base64_decoded_len(const char *input, size_t len)
+{
+    return std_decoded_len(input, len);
+}
+
+int base64_encode_buf(const uint8_t *input, size_t len, char *output, size_t out_size, size_t *out_len)
+{
+    return std_encode(input, len, output, out_size, out_len);
+}
+
+int base64_decode_buf(const char *input, size_t len, uint8_t *output, size_t out_size, size_t *out_len)
+{
+    return std_decode(input, len, output, out_size, out_len);
+}
+
+int base64_decode_inplace(char *buf, size_t len, size_t *out_len)
+{
+    // 解码结果不会长于输入，不会出现空间不足
+    return base64_decode_buf(buf, len, (uint8_t *)buf, len, out_len);
+}
+
+#if B64_HAVE_SSSE3
+#define B64_KERNELS(name)                                                                       \
+    {"scalar", &base64_##name##_codec, NULL, name##_encode_scalar, name##_decode_scalar},       \
+    {"ssse3", &base64_##name##_codec, b64_cpu_ssse3, name##_encode_ssse3, name##_decode_ssse3},
+#else
+#define B64_KERNELS(name)                                                                       \
+    {"scalar", &base64_##name##_codec, NULL, name##_encode_scalar, name##_decode_scalar},
+#endif
+
+// 内核注册表
+const base64_kernel_t base64_kernels[] =
+{
+    B64_KERNELS(std)
+    B64_KERNELS(std_nopad)
+    B64_KERNELS(url)
+    B64_KERNELS(url_nopad)
+};
+const size_t base64_kernel_count = sizeof(base64_kernels) / sizeof(base64_kernels[0]);
+
+// Base64编码函数
+void base64_encode(const unsigned char *input, size_t len, char *output) {
+    char *p = output;
+    for (size_t i = 0; i < len; i += 3) {
+        unsigned int v = input[i] << 16;
+        v |= (i + 1 < len ? input[i + 1] << 8 : 0);
+        v |= (i + 2 < len ? input[i + 2] : 0);
+
+        *p++ = base64_chars[(v >> 18) & 0x3F];
+        *p++ = base64_chars[(v >> 12) & 0x3F];
+        *p++ = (i + 1 < len ? base64_chars[(v >> 6) & 0x3F] : '=');
+        *p++ = (i + 2 < len ? base64_chars[v & 0x3F] : '=');
+    }
+    *p = '\0';
+}
+
+// Base64解码函数
+int base64_decode(const char *input, unsigned char *output, int *out_len) {
+    size_t len = strlen(input);
+    if (len % 4 != 0) return -1; // 无效的Base64输入
+
+    size_t decoded_len = len / 4 * 3;
+    if (input[len - 1] == '=') decoded_len--;
+    if (input[len - 2] == '=') decoded_len--;
+
+    unsigned char *p = output;
+    for (size_t i = 0; i < len; i += 4) {
+        unsigned int v = base64_table[(unsigned char)input[i]] << 18;
+        v |= base64_table[(unsigned char)input[i + 1]] << 12;
+        v |= input[i + 2] == '=' ? 0 : base64_table[(unsigned char)input[i + 2]] << 6;
+        v |= input[i + 3] == '=' ? 0 : base64_table[(unsigned char)input[i + 3]];
+
+        *p++ = (v >> 16) & 0xFF;
+        if (input[i + 2] != '=') *p++ = (v >> 8) & 0xFF;
+        if (input[i + 3] != '=') *p++ = v & 0xFF;
+    }
+
+    *out_len = p - output;
+    return 0;
+}
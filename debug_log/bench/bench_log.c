@@ -0,0 +1,159 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "debug_log.h"
+#include "dbg_async.h"
+
+/**
+ * @brief   日志输出性能测试
+ * @note    1~64个线程同时输出日志，统计每秒输出的行数
+ * @note    printf  原来的输出方式: 颜色、[func]:、正文、复位、换行分5次printf
+ * @note    sync    dbg_sync_log: 线程私有缓冲区格式化后一次write
+ * @note    async   dbg_async_log: 写入线程私有环形缓冲区，由后台线程批量write
+ * @note    ./bench_log [每个线程的行数, 默认100000] [输出文件, 默认/dev/null]
+*/
+
+// 测试的线程数
+static const int bench_threads[] = {1, 2, 4, 8, 16, 32, 64};
+
+typedef void (*bench_fn_t)(int id, int i);
+
+static long bench_lines;
+static pthread_barrier_t bench_barrier;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void log_printf(int id, int i)
+{
+    printf(ANSI_COLOR_GREEN);
+    printf("[%s]: ", __func__);
+    printf("thread %d line %d value 0x%08x name %s", id, i, (unsigned)i * 2654435761u, "bench");
+    printf(ANSI_COLOR_RESET);
+    printf("\n");
+}
+
+static void log_sync(int id, int i)
+{
+    dbg_sync_log(ANSI_COLOR_GREEN, __func__, "thread %d line %d value 0x%08x name %s",
+                 id, i, (unsigned)i * 2654435761u, "bench");
+}
+
+static void log_async(int id, int i)
+{
+    dbg_async_log(ANSI_COLOR_GREEN, __func__, "thread %d line %d value 0x%08x name %s",
+                  id, i, (unsigned)i * 2654435761u, "bench");
+}
+
+typedef struct
+{
+    bench_fn_t fn;
+    int id;
+    double start;       // 开始输出的时间
+}bench_arg_t;
+
+static void *bench_thread(void *p)
+{
+    bench_arg_t *arg = p;
+    pthread_barrier_wait(&bench_barrier);
+    arg->start = now_sec();
+    for (long i = 0; i < bench_lines; i++)
+    {
+        arg->fn(arg->id, (int)i);
+    }
+    return NULL;
+}
+
+/**
+ * @brief   nthreads 个线程同时输出，返回每秒行数
+*/
+static double bench_run(bench_fn_t fn, int nthreads)
+{
+    pthread_t threads[64];
+    bench_arg_t args[64];
+    pthread_barrier_init(&bench_barrier, NULL, (unsigned)nthreads + 1);
+    for (int i = 0; i < nthreads; i++)
+    {
+        args[i].fn = fn;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, bench_thread, &args[i]);
+    }
+    pthread_barrier_wait(&bench_barrier);
+    // 主线程从屏障返回时工作线程可能已经输出了一段时间，以最早开始的线程为起点
+    double t0 = 0;
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (i == 0 || args[i].start < t0)
+        {
+            t0 = args[i].start;
+        }
+    }
+    // 计入缓冲区中尚未输出的部分
+    fflush(stdout);
+    if (fn == log_async)
+    {
+        dbg_async_flush();
+    }
+    double t1 = now_sec();
+    pthread_barrier_destroy(&bench_barrier);
+    return (double)bench_lines * nthreads / (t1 - t0);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_lines = argc > 1 ? atol(argv[1]) : 100000;
+    const char *path = argc > 2 ? argv[2] : "/dev/null";
+    if (bench_lines <= 0)
+    {
+        fprintf(stderr, "usage: %s [lines per thread] [output file]\n", argv[0]);
+        return 2;
+    }
+
+    // 日志输出重定向到测试文件，结果输出到stderr
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror(path);
+        return 1;
+    }
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    static const struct
+    {
+        const char *name;
+        bench_fn_t fn;
+    }modes[] =
+    {
+        {"printf", log_printf},
+        {"sync", log_sync},
+        {"async", log_async},
+    };
+
+    fprintf(stderr, "%-8s", "threads");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        fprintf(stderr, "%14s", modes[m].name);
+    }
+    fprintf(stderr, "   (lines/s, %ld lines per thread -> %s)\n", bench_lines, path);
+    for (size_t t = 0; t < sizeof(bench_threads) / sizeof(bench_threads[0]); t++)
+    {
+        fprintf(stderr, "%-8d", bench_threads[t]);
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            fprintf(stderr, "%14.0f", bench_run(modes[m].fn, bench_threads[t]));
+        }
+        fprintf(stderr, "\n");
+    }
+    return 0;
+}
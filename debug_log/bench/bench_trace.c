@@ -0,0 +1,74 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#define DBG_TRACE   1
+#include "debug_log.h"
+
+/**
+ * @brief   区间计时开销测试
+ * @note    1~8个线程各自反复记录空的 DBG_TRACE_SCOPE，统计每个事件的平均耗时
+ * @note    按线程CPU时间计算，CPU核数少于线程数时结果不受调度影响
+ * @note    ./bench_trace [每个线程的区间数, 默认10000000]
+*/
+
+// 测试的线程数
+static const int bench_threads[] = {1, 2, 4, 8};
+
+static long bench_spans;
+static pthread_barrier_t bench_barrier;
+
+static double cpu_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *bench_thread(void *arg)
+{
+    double *sec = arg;
+    // 第一次记录时分配缓冲区，不计入测试时间
+    DBG_TRACE_BEGIN("warmup");
+    DBG_TRACE_END("warmup");
+    pthread_barrier_wait(&bench_barrier);
+    double start = cpu_sec();
+    for (long i = 0; i < bench_spans; i++)
+    {
+        DBG_TRACE_SCOPE("span");
+        __asm__ volatile("" ::: "memory");
+    }
+    *sec = cpu_sec() - start;
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_spans = argc > 1 ? atol(argv[1]) : 10000000;
+    printf("threads    ns/event\n");
+    for (size_t t = 0; t < sizeof(bench_threads) / sizeof(bench_threads[0]); t++)
+    {
+        int n = bench_threads[t];
+        pthread_t *threads = malloc(sizeof(pthread_t) * n);
+        double *secs = malloc(sizeof(double) * n);
+        pthread_barrier_init(&bench_barrier, NULL, n + 1);
+        for (int i = 0; i < n; i++)
+        {
+            pthread_create(&threads[i], NULL, bench_thread, &secs[i]);
+        }
+        pthread_barrier_wait(&bench_barrier);
+        double sec = 0;
+        for (int i = 0; i < n; i++)
+        {
+            pthread_join(threads[i], NULL);
+            sec += secs[i];
+        }
+        pthread_barrier_destroy(&bench_barrier);
+        free(threads);
+        free(secs);
+        // 每个区间两个事件
+        printf("%7d %11.2f\n", n, sec * 1e9 / (bench_spans * 2.0 * n));
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#ifndef DBG_ASYNC_H_
+#define DBG_ASYNC_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   异步日志后端
+ * @note    调用线程只把格式化后的记录写入线程私有的无锁SPSC环形缓冲区，
+ *          后台线程轮询所有环形缓冲区，按时间戳归并排序后批量write输出
+ * @note    每个线程第一次输出日志时分配环形缓冲区，线程退出后由后台线程回收
+*/
+
+/************************** 异步后端配置 *********************************/
+/**
+ * @brief   每个线程的环形缓冲区大小(字节)，必须是2的幂
+*/
+#ifndef DBG_ASYNC_RING_SIZE
+#define DBG_ASYNC_RING_SIZE     (64 * 1024)
+#endif
+
+/**
+ * @brief   单条记录的最大长度，超出部分被截断
+*/
+#ifndef DBG_ASYNC_MAX_RECORD
+#define DBG_ASYNC_MAX_RECORD    1024
+#endif
+
+/**
+ * @brief   环形缓冲区满时的处理方式
+*/
+// 阻塞等待后台线程腾出空间，不丢失日志
+#define DBG_ASYNC_BLOCK         0
+// 直接丢弃
+#define DBG_ASYNC_DROP          1
+// 丢弃并计数，后台线程定期输出丢弃的数量
+#define DBG_ASYNC_DROP_COUNT    2
+
+#ifndef DBG_ASYNC_POLICY
+#define DBG_ASYNC_POLICY        DBG_ASYNC_BLOCK
+#endif
+
+/**
+ * @brief   写入一条日志记录
+ * @param   [in] color  颜色转义序列，可以为NULL
+ * @param   [in] func   函数名，为NULL时不输出 [func]: 前缀
+ * @param   [in] fmt    printf格式字符串
+ * @return  dbg_async_vlog 返回写入的字节数，被丢弃时返回0
+*/
+void dbg_async_log(const char *color, const char *func, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+size_t dbg_async_vlog(const char *color, const char *func, const char *fmt, va_list ap);
+
+/**
+ * @brief   设置缓冲区满时的处理方式 DBG_ASYNC_xxx
+*/
+void dbg_async_set_policy(int policy);
+
+/**
+ * @brief   获取累计丢弃的记录数
+*/
+uint64_t dbg_async_dropped(void);
+
+/**
+ * @brief   等待调用时刻之前写入的记录全部输出
+*/
+void dbg_async_flush(void);
+
+/**
+ * @brief   输出所有剩余记录并停止后台线程
+ * @note    进程退出时自动调用，之后的记录(例如其他 atexit 函数中的日志)在调用线程中直接输出
+*/
+void dbg_async_stop(void);
+
+/************************** 内部接口 *********************************/
+// 二进制记录，由后台线程写入二进制日志文件
+#define DBG_ASYNC_RECORD_BINARY 0x02
+
+/**
+ * @brief   日志时间戳(dbg_clock 计数)，见 dbg_clock.h
+*/
+uint64_t dbg_async_now(void);
+
+/**
+ * @brief   在当前线程的环形缓冲区中预留 DBG_ASYNC_MAX_RECORD 字节
+ * @return  记录正文的写入位置，缓冲区满并且不阻塞时返回NULL
+*/
+void *dbg_async_reserve(void);
+
+/**
+ * @brief   提交 dbg_async_reserve 预留的记录
+ * @param   [in] body   dbg_async_reserve 的返回值
+ * @param   [in] len    实际写入的长度
+ * @param   [in] ts     时间戳，用于后台线程归并排序
+ * @param   [in] flags  DBG_ASYNC_RECORD_xxx
+*/
+void dbg_async_commit(void *body, size_t len, uint64_t ts, uint32_t flags);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef DBG_BINARY_H_
+#define DBG_BINARY_H_
+#include <stdarg.h>
+#include <stdint.h>
+#include "dbg_clock.h"
+#include "dbg_site.h"
+
+/**
+ * @brief   二进制延迟格式化日志
+ * @note    调用线程只写入 调用点ID + 时间戳 + 原始参数，不做任何printf格式化，
+ *          记录经异步后端的线程私有环形缓冲区由后台线程批量写入二进制日志文件
+ * @note    使用 tools/dbg_decode 把二进制日志还原为文本格式
+ * @note    文件内容为本机字节序，需要在相同架构的机器上解码
+*/
+
+/************************** 二进制文件格式 *********************************/
+/**
+ * @brief   文件结构: 文件头 + 条目序列
+ *          条目: DBG_BIN_SITE 调用点描述(文件打开时写入全部调用点) 或 DBG_BIN_LOG 日志记录
+*/
+#define DBG_BIN_MAGIC       "DBGBIN01"
+#define DBG_BIN_VERSION     2
+
+// 条目类型
+#define DBG_BIN_SITE        1
+#define DBG_BIN_LOG         2
+
+// 文件头
+typedef struct
+{
+    char magic[8];              // DBG_BIN_MAGIC
+    uint32_t version;           // DBG_BIN_VERSION
+    uint32_t reserved;
+    dbg_clock_calib_t clock;    // 时间戳换算参数
+}dbg_bin_header_t;
+
+// 调用点描述，后面依次跟随 格式字符串、函数名、文件名以及 nargs 个参数类型
+typedef struct
+{
+    uint8_t type;               // DBG_BIN_SITE
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t reserved;
+    uint32_t id;
+    uint32_t line;
+    uint16_t fmt_len;
+    uint16_t func_len;
+    uint16_t file_len;
+    uint16_t reserved2;
+}dbg_bin_site_t;
+
+/**
+ * @brief   日志记录，后面跟随 len 字节的参数
+ * @note    参数按调用点的参数类型依次存放: INT 4字节, LONG/LLONG/DOUBLE/PTR 8字节,
+ *          LDOUBLE 16字节, STR 2字节长度 + 字符串内容(不含'\0')
+*/
+typedef struct
+{
+    uint8_t type;               // DBG_BIN_LOG
+    uint8_t reserved;
+    uint16_t len;               // 参数总长度
+    uint32_t id;                // 调用点ID
+    uint64_t ts;                // 时间戳(dbg_clock 计数)
+}dbg_bin_log_t;
+
+/************************** 运行时接口 *********************************/
+/**
+ * @brief   默认的二进制日志文件，可以通过环境变量 DBG_BIN_FILE 修改
+*/
+#ifndef DBG_BIN_PATH
+#define DBG_BIN_PATH        "debug_log.bin"
+#endif
+
+/**
+ * @brief   指定二进制日志文件
+ * @note    需要在第一条二进制日志之前调用，否则使用默认文件
+ * @return  成功返回0，失败返回-1
+*/
+int dbg_bin_open(const char *path);
+
+/**
+ * @brief   写入一条二进制日志(由 DBG_LOGx 宏调用)
+ * @param   [in] site   调用点描述符，参数类型在编译期确定
+ * @return  dbg_bin_vlog 返回记录的字节数，被丢弃时返回0
+*/
+void dbg_bin_log(const dbg_site_t *site, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+size_t dbg_bin_vlog(const dbg_site_t *site, const char *fmt, va_list ap);
+
+/**
+ * @brief   获取二进制日志文件描述符(后台线程使用)
+ * @note    第一次调用时打开文件并写入文件头以及所有调用点描述
+*/
+int dbg_bin_fd(void);
+
+#endif
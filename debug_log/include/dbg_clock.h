@@ -0,0 +1,108 @@
+#ifndef DBG_CLOCK_H_
+#define DBG_CLOCK_H_
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief   日志时间戳
+ * @note    记录日志时只读取计数(TSC或者CLOCK_MONOTONIC)，输出时才换算为墙上时间
+ * @note    时钟来源在进程启动时确定，之后不再改变，所有时间戳都可以用同一组参数换算:
+ *          CPU支持 invariant TSC 并且TSC在递增时使用TSC，否则使用 clock_gettime(vDSO)
+ * @note    TSC模式在进程启动时只记录一次校准的起点(不等待)，
+ *          第一次需要换算时(输出时间、写入文件头等)再采样一次完成校准，
+ *          距离起点不足校准间隔时只等待剩余的时间
+*/
+
+/************************** 时钟配置 *********************************/
+// 使用 clock_gettime(CLOCK_MONOTONIC)，计数单位为纳秒
+#define DBG_CLOCK_MONOTONIC     0
+// 使用 rdtsc，计数单位为TSC周期
+#define DBG_CLOCK_TSC           1
+
+/**
+ * @brief   时钟来源，编译时选择
+*/
+#ifndef DBG_CLOCK
+#if defined(__x86_64__) || defined(__i386__)
+#define DBG_CLOCK               DBG_CLOCK_TSC
+#else
+#define DBG_CLOCK               DBG_CLOCK_MONOTONIC
+#endif
+#endif
+
+/**
+ * @brief   是否在每条日志前输出时间
+*/
+#ifndef DBG_TIMESTAMP
+#define DBG_TIMESTAMP           1
+#endif
+
+/**
+ * @brief   计数与时间的换算参数
+ * @note    monotonic_ns = base_ns + ((ticks - base_ticks) * mult) >> DBG_CLOCK_SHIFT
+ * @note    realtime_ns = monotonic_ns + realtime_offset
+*/
+#define DBG_CLOCK_SHIFT         32
+
+typedef struct
+{
+    uint64_t base_ticks;        // 校准时刻的计数
+    uint64_t base_ns;           // 校准时刻的 CLOCK_MONOTONIC(纳秒)
+    uint64_t mult;              // 每个计数对应的纳秒数 << DBG_CLOCK_SHIFT
+    int64_t realtime_offset;    // CLOCK_REALTIME 与 CLOCK_MONOTONIC 的差值(纳秒)
+}dbg_clock_calib_t;
+
+// 校准结果，读取之前先调用 dbg_clock_calibrate
+extern dbg_clock_calib_t dbg_clock_calib;
+// 运行时是否使用TSC，进程启动时确定
+extern int dbg_clock_use_tsc;
+
+/**
+ * @brief   读取当前计数
+*/
+static inline uint64_t dbg_clock_now(void)
+{
+#if DBG_CLOCK == DBG_CLOCK_TSC
+    if (__builtin_expect(dbg_clock_use_tsc, 1))
+    {
+        return __rdtsc();
+    }
+#endif
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief   计数换算为 CLOCK_MONOTONIC 纳秒
+*/
+static inline uint64_t dbg_clock_to_ns(const dbg_clock_calib_t *calib, uint64_t ticks)
+{
+    int64_t delta = (int64_t)(ticks - calib->base_ticks);
+    __int128 ns = ((__int128)delta * (__int128)calib->mult) >> DBG_CLOCK_SHIFT;
+    return calib->base_ns + (uint64_t)(int64_t)ns;
+}
+
+/**
+ * @brief   完成校准
+ * @note    只有第一次调用会采样，之后直接返回；换算计数之前调用
+*/
+void dbg_clock_calibrate(void);
+
+/**
+ * @brief   纳秒换算为计数
+ * @note    还没有完成校准时先完成校准
+*/
+uint64_t dbg_clock_ticks(uint64_t ns);
+
+/**
+ * @brief   格式化计数对应的本地时间 "HH:MM:SS.uuuuuu "
+ * @return  写入的长度
+*/
+size_t dbg_clock_format(uint64_t ticks, char *buf, size_t size);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef DBG_FLIGHT_H_
+#define DBG_FLIGHT_H_
+#include <stdarg.h>
+#include <stdint.h>
+#include "dbg_clock.h"
+#include "dbg_site.h"
+
+/**
+ * @brief   飞行记录器
+ * @note    日志写入 mmap(MAP_SHARED) 映射的文件中的环形缓冲区，只有内存写入的开销，
+ *          进程崩溃(SIGSEGV/SIGKILL)后内容仍保留在内核页缓存中并写回文件
+ * @note    每个线程独占一个分段，写入不需要加锁；分段用完时新线程的日志被丢弃并计数(文件头的 dropped)，
+ *          之后定期重新尝试，拿到分段时先写入一条记录说明丢失了多少条
+ * @note    使用 tools/dbg_flight 按时间顺序导出记录
+ * @note    保留: 默认文件名带进程ID，重启后的进程写入新文件，崩溃进程的记录保留到手动删除；
+ *          打开的文件已经存在时(固定文件名或者进程ID重复)先改名为 <文件名>.prev，只保留上一次的记录
+*/
+
+/************************** 飞行记录器配置 *********************************/
+/**
+ * @brief   默认的记录文件，可以通过环境变量 DBG_FLIGHT_FILE 修改
+ * @note    路径中的 %p 替换为进程ID
+*/
+#ifndef DBG_FLIGHT_PATH
+#define DBG_FLIGHT_PATH         "debug_log.%p.flight"
+#endif
+
+/**
+ * @brief   分段数量(同时写入的最大线程数)以及每个分段的大小(字节，必须是2的幂)
+*/
+#ifndef DBG_FLIGHT_SEGMENTS
+#define DBG_FLIGHT_SEGMENTS     64
+#endif
+#ifndef DBG_FLIGHT_SEG_SIZE
+#define DBG_FLIGHT_SEG_SIZE     (64 * 1024)
+#endif
+
+/**
+ * @brief   没有空闲分段时，每隔多少条记录重新尝试分配
+*/
+#ifndef DBG_FLIGHT_RETRY
+#define DBG_FLIGHT_RETRY        64
+#endif
+
+/**
+ * @brief   单条记录正文的最大长度，超出部分被截断
+*/
+#ifndef DBG_FLIGHT_MAX_RECORD
+#define DBG_FLIGHT_MAX_RECORD   512
+#endif
+
+/************************** 文件格式 *********************************/
+/**
+ * @brief   文件结构: 文件头 + DBG_FLIGHT_SEGMENTS 个分段，分段 = 分段头 + 数据区
+ * @note    记录在数据区中首尾相接循环写入: 记录头 + 正文 + 4字节记录总长度，
+ *          导出时从 head 开始根据末尾的长度向前遍历
+*/
+#define DBG_FLIGHT_MAGIC        "DBGFLT01"
+#define DBG_FLIGHT_VERSION      1
+
+// 文件头
+typedef struct
+{
+    char magic[8];              // DBG_FLIGHT_MAGIC
+    uint32_t version;           // DBG_FLIGHT_VERSION
+    uint32_t segments;          // 分段数量
+    uint32_t seg_size;          // 分段数据区大小
+    uint32_t pid;               // 进程ID
+    uint64_t dropped;           // 没有空闲分段而丢弃的记录数
+    dbg_clock_calib_t clock;    // 时间戳换算参数
+    uint8_t reserved[8];
+}dbg_flight_header_t;
+
+// 分段头，独占一个缓存行
+typedef struct
+{
+    uint32_t owner;             // 当前写入线程ID，0表示空闲
+    uint32_t reserved;
+    uint64_t head;              // 累计写入的字节数，记录写完后才更新
+    uint8_t pad[48];
+}dbg_flight_seg_t;
+
+// 记录头，后面跟随正文以及4字节的记录总长度
+typedef struct
+{
+    uint32_t len;               // 记录总长度(记录头 + 正文 + 末尾长度)
+    uint32_t tid;               // 线程ID
+    uint64_t ts;                // 时间戳(dbg_clock 计数)
+    uint32_t level;             // 日志等级
+    uint32_t reserved;
+}dbg_flight_record_t;
+
+/************************** 运行时接口 *********************************/
+/**
+ * @brief   指定记录文件
+ * @note    需要在第一条记录之前调用，否则使用默认文件
+ * @return  成功返回0，失败返回-1
+*/
+int dbg_flight_open(const char *path);
+
+/**
+ * @brief   写入一条记录(由 dbg_site_log 调用)
+ * @param   [in] site   调用点描述符
+ * @param   [in] ts     时间戳(dbg_clock 计数)
+*/
+void dbg_flight_vlog(const dbg_site_t *site, uint64_t ts, const char *fmt, va_list ap);
+
+#endif
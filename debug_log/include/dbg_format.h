@@ -0,0 +1,41 @@
+#ifndef DBG_FORMAT_H_
+#define DBG_FORMAT_H_
+#include <stdarg.h>
+#include <stddef.h>
+
+/**
+ * @brief   日志格式化
+ * @note    整数(%d %i %u %x %X)、字符串(%s)、字符(%c)、指针(%p) 以及 '-' '0' 宽度标志
+ *          直接格式化，不经过 vsnprintf
+ * @note    其他转换说明(浮点、'+' '#' 标志、整数精度等)逐个交给 snprintf 处理，
+ *          输出结果与 printf 一致
+*/
+
+/**
+ * @brief   格式化到缓冲区
+ * @param   [out] buf   输出缓冲区，结果总是以'\0'结尾
+ * @param   [in] size   缓冲区大小
+ * @return  写入的长度(不含'\0')，超出部分被截断
+*/
+size_t dbg_vformat(char *buf, size_t size, const char *fmt, va_list ap);
+
+size_t dbg_format(char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief   格式化一行日志: 颜色 + [func]: + 正文 + 复位颜色 + 换行
+ * @param   [in] color  颜色转义序列，可以为NULL
+ * @param   [in] func   函数名，为NULL时不输出 [func]: 前缀
+ * @return  写入的长度(结果不以'\0'结尾)，正文过长时截断，保证以复位颜色以及换行结尾
+*/
+size_t dbg_vformat_line(char *buf, size_t size, const char *color, const char *func,
+                        const char *fmt, va_list ap);
+
+/**
+ * @brief   展开文件路径中的 %p 为进程ID
+ * @param   [out] buf   输出缓冲区，结果总是以'\0'结尾
+ * @return  写入的长度(不含'\0')
+*/
+size_t dbg_format_path(char *buf, size_t size, const char *path);
+
+#endif
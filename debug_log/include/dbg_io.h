@@ -0,0 +1,32 @@
+#ifndef DBG_IO_H_
+#define DBG_IO_H_
+#include <errno.h>
+#include <stddef.h>
+#include <unistd.h>
+
+/**
+ * @brief   日志库内部使用的文件写入
+*/
+
+/**
+ * @brief   写入全部数据，处理被信号中断以及部分写入的情况
+ * @return  成功返回0，失败返回-1
+*/
+static inline int dbg_write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+#endif
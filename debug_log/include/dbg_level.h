@@ -0,0 +1,48 @@
+#ifndef DBG_LEVEL_H_
+#define DBG_LEVEL_H_
+
+/**
+ * @brief   运行时日志等级控制
+ * @note    DBG_LOG_LEVEL 是编译期的上限，超出的调用点不会被编译；
+ *          编译进来的调用点默认全部启用，运行时可以按模块或者按调用点关闭/打开
+ * @note    每个调用点只检查一个静态标志 dbg_site_t.enabled，关闭时不会对参数求值
+*/
+
+/**
+ * @brief   等级配置格式
+ * @note    由逗号、空白或者换行分隔的规则，按顺序匹配，后面的规则覆盖前面的规则
+ *          [目标=]等级
+ *          目标:   *           所有调用点(省略目标时相同)
+ *                  模块名      DBG_MODULE 或者去掉目录以及扩展名的源文件名
+ *                  文件名:行号 单个调用点，文件名不含目录
+ *          等级:   off error warning info debug 或者 0~4
+ * @note    配置文件中 '#' 到行尾为注释
+ * @note    例: "warning,net=debug,main.c:42=off"
+*/
+
+/**
+ * @brief   启动时读取的环境变量
+ * @note    DBG_LOG_LEVELS       等级配置
+ * @note    DBG_LOG_LEVELS_FILE  等级配置文件，文件修改或者收到 SIGHUP 时重新加载
+*/
+#define DBG_LEVEL_ENV           "DBG_LOG_LEVELS"
+#define DBG_LEVEL_FILE_ENV      "DBG_LOG_LEVELS_FILE"
+
+/**
+ * @brief   应用等级配置
+ * @note    先恢复环境变量 DBG_LOG_LEVELS 的配置，再应用 spec
+ * @param   [in] spec   等级配置，可以为NULL
+ * @return  成功返回0，格式错误返回-1 (不修改任何调用点)
+*/
+int dbg_level_apply(const char *spec);
+
+/**
+ * @brief   监视等级配置文件
+ * @note    启动后台线程，文件修改(按修改时间检测)或者收到信号 signo 时重新加载
+ * @param   [in] path   配置文件路径
+ * @param   [in] signo  触发重新加载的信号，为0时只检测文件修改
+ * @return  成功返回0，失败返回-1
+*/
+int dbg_level_watch(const char *path, int signo);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef DBG_RATE_H_
+#define DBG_RATE_H_
+#include <stdint.h>
+#include "dbg_site.h"
+
+/**
+ * @brief   按调用点限流以及合并重复行
+ * @note    每个调用点使用令牌桶(GCRA算法，只有一个原子变量)限制每秒输出的行数
+ * @note    开启 DBG_RATE_REPEAT 后，同一调用点在 DBG_RATE_REPEAT_MS 内连续输出参数完全相同的日志时只输出第一条，
+ *          之后输出 "last message repeated N times"；ERROR 等级不合并
+ * @note    被限流以及被合并的行数在该调用点下一次输出时报告，
+ *          第一次合并或者丢弃时启动一个后台线程，每隔 DBG_RATE_REPORT_MS 报告一次剩余的计数，进程退出时再报告一次
+ * @note    状态保存在调用点描述符中，只使用原子操作，不加锁
+ * @note    二进制后端同样限流，但不合并重复行: 写入一条记录只是拷贝参数，比计算参数的哈希还要便宜
+*/
+
+/************************** 限流配置 *********************************/
+/**
+ * @brief   每个调用点每秒最多输出的行数，0表示不限制
+ * @note    默认都不限制，需要时编译时定义或者运行时调用 dbg_rate_set 开启，
+ *          开启 ERROR 等级的限流时错误日志也可能被丢弃
+*/
+#ifndef DBG_RATE_ERROR
+#define DBG_RATE_ERROR          0
+#endif
+#ifndef DBG_RATE_WARNING
+#define DBG_RATE_WARNING        0
+#endif
+#ifndef DBG_RATE_INFO
+#define DBG_RATE_INFO           0
+#endif
+#ifndef DBG_RATE_DEBUG
+#define DBG_RATE_DEBUG          0
+#endif
+
+/**
+ * @brief   允许突发输出的行数
+*/
+#ifndef DBG_RATE_BURST
+#define DBG_RATE_BURST          100
+#endif
+
+/**
+ * @brief   后台报告被限流以及被合并行数的间隔(毫秒)
+*/
+#ifndef DBG_RATE_REPORT_MS
+#define DBG_RATE_REPORT_MS      1000
+#endif
+
+/**
+ * @brief   是否合并重复行，默认关闭
+ * @note    开启后每条日志需要计算参数的哈希值(字符串需要遍历内容)
+*/
+#ifndef DBG_RATE_REPEAT
+#define DBG_RATE_REPEAT         0
+#endif
+
+/**
+ * @brief   合并重复行的时间窗口(毫秒)，距离上一次输出超过该时间时重复行也会输出
+*/
+#ifndef DBG_RATE_REPEAT_MS
+#define DBG_RATE_REPEAT_MS      1000
+#endif
+
+/************************** 运行时接口 *********************************/
+// dbg_rate_check 的返回值
+#define DBG_RATE_PASS           0   // 输出
+#define DBG_RATE_DROP           1   // 丢弃
+
+/**
+ * @brief   修改某个等级的限流参数
+ * @param   [in] level  日志等级 DBG_LOG_xxx
+ * @param   [in] rate   每秒最多输出的行数，0表示不限制
+ * @param   [in] burst  允许突发输出的行数
+*/
+void dbg_rate_set(int level, uint32_t rate, uint32_t burst);
+
+/**
+ * @brief   检查调用点本次是否可以输出
+ * @param   [in] site   调用点描述符
+ * @param   [in] hash   参数的哈希值，用于判断是否与上一条重复，0表示不合并
+ * @param   [in] now    当前时间(dbg_clock 计数)
+ * @param   [out] repeated  需要报告的重复行数
+ * @param   [out] dropped   需要报告的被限流行数
+ * @return  DBG_RATE_xxx
+*/
+int dbg_rate_check(dbg_site_t *site, uint64_t hash, uint64_t now, uint32_t *repeated, uint32_t *dropped);
+
+/**
+ * @brief   立即报告所有调用点剩余的计数
+ * @note    后台线程定期报告，进程退出时也会报告，一般不需要调用
+*/
+void dbg_rate_flush(void);
+
+#endif
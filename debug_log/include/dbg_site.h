@@ -0,0 +1,167 @@
+#ifndef DBG_SITE_H_
+#define DBG_SITE_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   日志调用点描述符
+ * @note    每个 DBG_LOGx 调用点在编译期生成一个静态描述符，记录格式字符串、函数名、
+ *          等级以及参数类型，描述符的指针放在 dbg_sites 段中，运行时可以遍历所有调用点
+ * @note    进程启动时按段内顺序为每个调用点分配ID
+*/
+
+/**
+ * @brief   调用点所属的模块名
+ * @note    在包含头文件之前定义，例如 #define DBG_MODULE "net"
+ * @note    未定义时使用源文件名(去掉目录以及扩展名)作为模块名
+*/
+#ifndef DBG_MODULE
+#define DBG_MODULE          NULL
+#endif
+
+/**
+ * @brief   参数类型(按默认参数提升之后的类型)
+*/
+#define DBG_ARG_END         0   // 结束标志
+#define DBG_ARG_INT         1   // char/short/int 以及对应的无符号类型
+#define DBG_ARG_LONG        2   // long/unsigned long/size_t
+#define DBG_ARG_LLONG       3   // long long/unsigned long long
+#define DBG_ARG_DOUBLE      4   // float/double
+#define DBG_ARG_LDOUBLE     5   // long double
+#define DBG_ARG_PTR         6   // 指针，按 %p 等处理
+#define DBG_ARG_STR         7   // char/signed char/unsigned char 字符串，写入时拷贝内容，
+                                // 按 %p 输出这些指针时需要转换为 void *
+
+// 格式字符串之后最多支持的参数个数
+#define DBG_MAX_ARGS        15
+
+// 调用点描述符
+typedef struct
+{
+    uint32_t id;            // 调用点ID(启动时分配)
+    uint8_t level;          // 日志等级
+    uint8_t nargs;          // 参数个数
+    uint8_t enabled;        // 运行时开关，由 dbg_level.c 修改
+    uint8_t backend;        // 日志后端 DBG_BACKEND_xxx
+    uint32_t line;          // 行号
+    const char *module;     // 模块名，为NULL时使用文件名
+    const char *file;       // 文件名
+    const char *func;       // 函数名
+    const char *fmt;        // 格式字符串，不是字符串字面量时为NULL
+    const uint8_t *types;   // 参数类型 DBG_ARG_xxx
+    // 限流状态，见 dbg_rate.h
+    uint64_t rate_tat;      // 令牌桶: 理论上下一行的到达时间
+    uint64_t rate_hash;     // 上一条日志参数的哈希值
+    uint64_t rate_last;     // 上一次输出的时间
+    uint32_t rate_repeats;  // 合并的重复行数
+    uint32_t rate_dropped;  // 被限流丢弃的行数
+}dbg_site_t;
+
+/**
+ * @brief   编译期获取参数类型
+*/
+#define DBG_ARG_TYPE(x) _Generic((x),                                   \
+    _Bool: DBG_ARG_INT, char: DBG_ARG_INT,                              \
+    signed char: DBG_ARG_INT, unsigned char: DBG_ARG_INT,               \
+    short: DBG_ARG_INT, unsigned short: DBG_ARG_INT,                    \
+    int: DBG_ARG_INT, unsigned int: DBG_ARG_INT,                        \
+    long: DBG_ARG_LONG, unsigned long: DBG_ARG_LONG,                    \
+    long long: DBG_ARG_LLONG, unsigned long long: DBG_ARG_LLONG,        \
+    float: DBG_ARG_DOUBLE, double: DBG_ARG_DOUBLE,                      \
+    long double: DBG_ARG_LDOUBLE,                                       \
+    char *: DBG_ARG_STR, const char *: DBG_ARG_STR,                     \
+    signed char *: DBG_ARG_STR, const signed char *: DBG_ARG_STR,       \
+    unsigned char *: DBG_ARG_STR, const unsigned char *: DBG_ARG_STR,   \
+    default: DBG_ARG_PTR)
+
+// 统计参数个数(包括格式字符串)
+#define DBG_NARGS(...)  DBG_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DBG_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define DBG_CAT(a, b)   DBG_CAT_(a, b)
+#define DBG_CAT_(a, b)  a##b
+
+// 展开格式字符串之后每个参数的类型
+#define DBG_ARG_TYPES(...)  DBG_CAT(DBG_TYPES_, DBG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define DBG_TYPES_1(f)
+#define DBG_TYPES_2(f, a)       DBG_ARG_TYPE(a),
+#define DBG_TYPES_3(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_2(f, __VA_ARGS__)
+#define DBG_TYPES_4(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_3(f, __VA_ARGS__)
+#define DBG_TYPES_5(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_4(f, __VA_ARGS__)
+#define DBG_TYPES_6(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_5(f, __VA_ARGS__)
+#define DBG_TYPES_7(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_6(f, __VA_ARGS__)
+#define DBG_TYPES_8(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_7(f, __VA_ARGS__)
+#define DBG_TYPES_9(f, a, ...)  DBG_ARG_TYPE(a), DBG_TYPES_8(f, __VA_ARGS__)
+#define DBG_TYPES_10(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_9(f, __VA_ARGS__)
+#define DBG_TYPES_11(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_10(f, __VA_ARGS__)
+#define DBG_TYPES_12(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_11(f, __VA_ARGS__)
+#define DBG_TYPES_13(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_12(f, __VA_ARGS__)
+#define DBG_TYPES_14(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_13(f, __VA_ARGS__)
+#define DBG_TYPES_15(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_14(f, __VA_ARGS__)
+#define DBG_TYPES_16(f, a, ...) DBG_ARG_TYPE(a), DBG_TYPES_15(f, __VA_ARGS__)
+
+// 格式字符串本身
+#define DBG_FMT(...)        DBG_FMT_(__VA_ARGS__, 0)
+#define DBG_FMT_(f, ...)    f
+
+/**
+ * @brief   描述符中保存的格式字符串
+ * @note    只有编译期常量可以放进静态描述符，格式字符串是变量时为NULL，
+ *          这样的调用点仍然可以编译，每次输出使用调用时传入的格式字符串，二进制后端改为输出文本记录
+*/
+#define DBG_SITE_FMT(f)     __builtin_choose_expr(__builtin_constant_p(f), (f), (const char *)NULL)
+
+/**
+ * @brief   在当前作用域定义调用点描述符
+ * @param   name    描述符变量名
+ * @param   lvl     日志等级
+ * @note    参数类型表是静态常量，描述符的指针放在 dbg_sites 段中
+*/
+#define DBG_SITE_DEFINE(name, lvl, ...)                                                         \
+    static const uint8_t name##_types[] = { DBG_ARG_TYPES(__VA_ARGS__) DBG_ARG_END };           \
+    static dbg_site_t name =                                                                    \
+    {                                                                                           \
+        .level = (lvl), .nargs = DBG_NARGS(__VA_ARGS__) - 1, .enabled = 1,                      \
+        .backend = DBG_BACKEND, .line = __LINE__, .module = DBG_MODULE,                         \
+        .file = __FILE__, .func = __func__,                                                     \
+        .fmt = DBG_SITE_FMT(DBG_FMT(__VA_ARGS__)), .types = name##_types                        \
+    };                                                                                          \
+    static dbg_site_t *const name##_ptr __attribute__((section("dbg_sites"), used)) = &name
+
+/**
+ * @brief   调用点是否启用
+ * @note    只有一次普通的读操作，调用点关闭时不会对参数求值
+*/
+#define DBG_SITE_ENABLED(site)  __builtin_expect(__atomic_load_n(&(site).enabled, __ATOMIC_RELAXED), 0)
+
+// dbg_site_log 的 flags
+#define DBG_SITE_LOG_FLIGHT     0x01    // 写入飞行记录器
+
+/**
+ * @brief   输出一条带调用点的日志(由 DBG_LOGx 宏调用)
+ * @note    依次处理: 飞行记录器、运行时开关、限流以及重复行合并、日志后端、统计计数
+ * @param   [in] site   调用点描述符
+ * @param   [in] color  颜色转义序列
+ * @param   [in] flags  DBG_SITE_LOG_xxx
+*/
+void dbg_site_log(dbg_site_t *site, const char *color, int flags, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief   输出调用点被合并以及被限流的行数
+ * @return  输出的字节数
+*/
+size_t dbg_site_report(const dbg_site_t *site, const char *color, uint32_t repeated, uint32_t dropped);
+
+/**
+ * @brief   遍历所有调用点
+ * @return  调用点数量
+*/
+size_t dbg_site_count(void);
+
+/**
+ * @brief   根据ID获取调用点
+*/
+dbg_site_t *dbg_site_get(uint32_t id);
+
+#endif
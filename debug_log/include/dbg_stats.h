@@ -0,0 +1,95 @@
+#ifndef DBG_STATS_H_
+#define DBG_STATS_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   按调用点统计日志输出
+ * @note    每个调用点统计触发次数、被限流或者被合并的次数以及输出的字节数，
+ *          调用点通过 dbg_sites 段自动注册，不需要手动登记
+ * @note    计数保存在线程私有的分片中(按调用点ID索引)，每个线程只写自己的分片，
+ *          不会产生跨核的缓存行竞争；读取时合并所有线程的分片
+ * @note    线程退出时分片合并到全局计数后释放
+*/
+
+/************************** 统计配置 *********************************/
+/**
+ * @brief   是否启用统计
+*/
+#ifndef DBG_STATS
+#define DBG_STATS           1
+#endif
+
+/************************** 运行时接口 *********************************/
+// 导出格式
+#define DBG_STATS_TABLE     0   // 文本表格，按触发次数降序，只包含触发过的调用点
+#define DBG_STATS_JSON      1   // JSON，包含所有调用点
+
+// 单个调用点的计数
+typedef struct
+{
+    uint64_t hits;          // 触发次数(运行时开关打开)
+    uint64_t suppressed;    // 被限流或者被合并的次数
+    uint64_t bytes;         // 交给日志后端的字节数
+}dbg_stats_t;
+
+// 当前线程的分片，为NULL时尚未分配
+extern __thread dbg_stats_t *dbg_stats_shard;
+
+/**
+ * @brief   为当前线程分配分片
+ * @return  分片，失败返回NULL
+*/
+dbg_stats_t *dbg_stats_shard_new(void);
+
+/**
+ * @brief   记录一次触发(由 dbg_site_log 调用)
+ * @param   [in] id         调用点ID
+ * @param   [in] suppressed 本次是否被限流或者被合并
+ * @param   [in] bytes      本次输出的字节数
+ * @note    只有当前线程写入分片，原子写入只是为了读取时不会读到撕裂的值
+*/
+static inline void dbg_stats_add(uint32_t id, int suppressed, size_t bytes)
+{
+    dbg_stats_t *shard = dbg_stats_shard;
+    if (__builtin_expect(shard == NULL, 0))
+    {
+        shard = dbg_stats_shard_new();
+        if (shard == NULL)
+        {
+            return;
+        }
+    }
+    dbg_stats_t *s = &shard[id];
+    __atomic_store_n(&s->hits, s->hits + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->suppressed, s->suppressed + (suppressed != 0), __ATOMIC_RELAXED);
+    __atomic_store_n(&s->bytes, s->bytes + bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   读取调用点的计数(合并所有线程)
+ * @param   [in] id     调用点ID
+ * @param   [out] out   计数
+ * @return  成功返回0，ID无效返回-1
+*/
+int dbg_stats_get(uint32_t id, dbg_stats_t *out);
+
+/**
+ * @brief   导出所有调用点的计数
+ * @param   [in] fd     输出的文件描述符
+ * @param   [in] format DBG_STATS_xxx
+ * @return  成功返回0，失败返回-1
+*/
+int dbg_stats_dump(int fd, int format);
+
+/**
+ * @brief   收到信号时导出计数
+ * @note    信号处理函数只写入管道，由后台线程导出
+ * @param   [in] signo  触发导出的信号，例如 SIGUSR1
+ * @param   [in] path   输出文件，每次导出时覆盖，为NULL时输出到标准错误
+ * @param   [in] format DBG_STATS_xxx
+ * @return  成功返回0，失败返回-1
+*/
+int dbg_stats_signal(int signo, const char *path, int format);
+
+#endif
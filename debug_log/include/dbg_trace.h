@@ -0,0 +1,138 @@
+#ifndef DBG_TRACE_H_
+#define DBG_TRACE_H_
+#include <stdint.h>
+#include "dbg_clock.h"
+#include "dbg_site.h"
+
+/**
+ * @brief   代码区间计时
+ * @note    DBG_TRACE_BEGIN/DBG_TRACE_END 以及 DBG_TRACE_SCOPE 记录开始以及结束事件，
+ *          事件只包含时间戳(dbg_clock 计数)以及名称指针，写入线程私有的环形缓冲区
+ * @note    导出为 Chrome trace-event JSON，可以在 chrome://tracing 或者 ui.perfetto.dev 中查看
+ * @note    DBG_TRACE 为0时所有宏展开为空，没有任何开销
+ * @note    名称必须是静态存储的字符串(字符串常量或者 __func__)，只保存指针
+ * @note    线程退出后缓冲区保留到被新线程复用为止，缓冲区的数量不超过同时记录事件的最大线程数
+*/
+
+/************************** 计时配置 *********************************/
+/**
+ * @brief   是否启用计时
+*/
+#ifndef DBG_TRACE
+#define DBG_TRACE               0
+#endif
+
+/**
+ * @brief   每个线程缓冲区的事件数(必须是2的幂)，写满后覆盖最早的事件
+*/
+#ifndef DBG_TRACE_EVENTS
+#define DBG_TRACE_EVENTS        (64 * 1024)
+#endif
+
+/**
+ * @brief   进程退出时导出的文件，为NULL时不导出，可以通过环境变量 DBG_TRACE_FILE 指定
+ * @note    路径中的 %p 替换为进程ID
+*/
+#ifndef DBG_TRACE_PATH
+#define DBG_TRACE_PATH          NULL
+#endif
+
+/************************** 事件缓冲区 *********************************/
+// 时间戳的最高位表示结束事件
+#define DBG_TRACE_END_FLAG      (1ull << 63)
+
+// 事件
+typedef struct
+{
+    uint64_t ts;                // 时间戳 | DBG_TRACE_END_FLAG
+    const char *name;           // 区间名称
+}dbg_trace_event_t;
+
+// 线程缓冲区
+typedef struct dbg_trace_buf
+{
+    struct dbg_trace_buf *next;
+    uint32_t tid;               // 线程ID
+    char thread_name[16];       // 线程名
+    uint64_t pos;               // 累计写入的事件数
+    int exited;                 // 线程已经退出，可以被新线程复用
+    dbg_trace_event_t events[DBG_TRACE_EVENTS];
+}dbg_trace_buf_t;
+
+// 当前线程的缓冲区，为NULL时尚未分配
+extern __thread dbg_trace_buf_t *dbg_trace_tls;
+
+/**
+ * @brief   为当前线程分配缓冲区
+ * @return  缓冲区，失败返回NULL
+*/
+dbg_trace_buf_t *dbg_trace_buf_new(void);
+
+/**
+ * @brief   记录一个事件
+ * @param   [in] name   区间名称
+ * @param   [in] flag   0 或者 DBG_TRACE_END_FLAG
+*/
+static inline void dbg_trace_event(const char *name, uint64_t flag)
+{
+    dbg_trace_buf_t *buf = dbg_trace_tls;
+    if (__builtin_expect(buf == NULL, 0))
+    {
+        buf = dbg_trace_buf_new();
+        if (buf == NULL)
+        {
+            return;
+        }
+    }
+    uint64_t pos = buf->pos;
+    dbg_trace_event_t *e = &buf->events[pos & (DBG_TRACE_EVENTS - 1)];
+    e->ts = dbg_clock_now() | flag;
+    e->name = name;
+    __atomic_store_n(&buf->pos, pos + 1, __ATOMIC_RELEASE);
+}
+
+// 作用域结束时由 cleanup 属性调用
+static inline void dbg_trace_scope_end(const char *const *name)
+{
+    dbg_trace_event(*name, DBG_TRACE_END_FLAG);
+}
+
+/************************** 计时宏 *********************************/
+#if DBG_TRACE
+/**
+ * @brief   开始/结束一个区间，同一线程内必须成对并且按嵌套顺序调用
+*/
+#define DBG_TRACE_BEGIN(name)   dbg_trace_event((name), 0)
+#define DBG_TRACE_END(name)     dbg_trace_event((name), DBG_TRACE_END_FLAG)
+
+/**
+ * @brief   从当前位置到所在作用域结束的区间
+*/
+#define DBG_TRACE_SCOPE(name)                                                   \
+    const char *const DBG_CAT(_dbg_trace_, __LINE__)                            \
+        __attribute__((cleanup(dbg_trace_scope_end))) = (name);                 \
+    dbg_trace_event(DBG_CAT(_dbg_trace_, __LINE__), 0)
+
+/**
+ * @brief   整个函数的区间，名称为函数名
+*/
+#define DBG_TRACE_FUNC()        DBG_TRACE_SCOPE(__func__)
+#else
+#define DBG_TRACE_BEGIN(name)   ((void)0)
+#define DBG_TRACE_END(name)     ((void)0)
+#define DBG_TRACE_SCOPE(name)   ((void)0)
+#define DBG_TRACE_FUNC()        ((void)0)
+#endif
+
+/************************** 导出 *********************************/
+/**
+ * @brief   把所有线程的事件导出为 Chrome trace-event JSON
+ * @note    只有设置了环境变量 DBG_TRACE_FILE 或者 DBG_TRACE_PATH 时进程退出时自动导出，否则需要显式调用
+ * @note    包括已经退出但缓冲区还没有被复用的线程的事件
+ * @note    导出时其他线程可以继续记录，导出期间被新事件覆盖的旧事件不输出
+ * @param   [in] path   输出文件，路径中的 %p 替换为进程ID
+ * @return  成功返回导出的事件数，失败返回-1
+*/
+long dbg_trace_write(const char *path);
+
+#endif
@@ -1,5 +1,7 @@
 ﻿#ifndef DEBUG_LOG_H_
 #define DEBUG_LOG_H_
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -28,9 +30,41 @@
  * @note    1. 只会打印当前等级及其以上的等级的信息
  * @note    2. 假设 指定的打印等级 = DBG_LOG_WARNING,
  *          则只会打印 DBG_LOG_WARNING 和 DBG_LOG_ERROR两个等级的信息
+ * @note    3. 这是编译期的上限，运行时可以按模块或者调用点调整，见 dbg_level.h
 */
 #define DBG_LOG_LEVEL       DBG_LOG_DEBUG
 
+/**
+ * @brief   日志输出后端
+ * @note    DBG_BACKEND_SYNC    在调用线程中直接输出
+ * @note    DBG_BACKEND_ASYNC   写入线程私有的无锁环形缓冲区，由后台线程批量输出，见 dbg_async.h
+ * @note    DBG_BACKEND_BINARY  只记录调用点ID以及原始参数，由后台线程写入二进制文件，
+ *                              使用 tools/dbg_decode 还原为文本，见 dbg_binary.h
+ * @note    宏接口保持不变，切换后端不需要修改调用代码
+*/
+#ifndef DBG_BACKEND
+#define DBG_BACKEND         DBG_BACKEND_SYNC
+#endif
+
+/**
+ * @brief   飞行记录器
+ * @note    开启后等级不高于 DBG_FLIGHT_LEVEL 的日志始终写入 mmap 文件中的环形缓冲区，
+ *          不受运行时等级控制，进程崩溃后使用 tools/dbg_flight 导出，见 dbg_flight.h
+*/
+#ifndef DBG_FLIGHT
+#define DBG_FLIGHT          0
+#endif
+#ifndef DBG_FLIGHT_LEVEL
+#define DBG_FLIGHT_LEVEL    DBG_LOG_DEBUG
+#endif
+
+/**
+ * @brief   同步后端单行日志的最大长度，超出部分被截断
+*/
+#ifndef DBG_LOG_LINE_MAX
+#define DBG_LOG_LINE_MAX    1024
+#endif
+
 
 /*************************** 调试输出保留宏 ********************************/
 /**
@@ -45,6 +79,13 @@
 // [调试]输出等级
 #define DBG_LOG_DEBUG       4
 
+// 同步输出
+#define DBG_BACKEND_SYNC    0
+// 异步输出
+#define DBG_BACKEND_ASYNC   1
+// 二进制延迟格式化输出
+#define DBG_BACKEND_BINARY  2
+
 #define ANSI_COLOR_RED      "\x1b[31m"
 #define ANSI_COLOR_GREEN    "\x1b[32m"
 #define ANSI_COLOR_YELLOW   "\x1b[33m"
@@ -60,40 +101,75 @@
 #endif
 
 
+#include "dbg_site.h"
+#include "dbg_level.h"
+#include "dbg_rate.h"
+#include "dbg_stats.h"
+#include "dbg_trace.h"
+#if DBG_BACKEND >= DBG_BACKEND_ASYNC
+#include "dbg_async.h"
+#endif
+#if DBG_BACKEND == DBG_BACKEND_BINARY
+#include "dbg_binary.h"
+#endif
+
 // 调试输出总开关 处于打开状态
 #if DBG_ENABLE
 // 日志打印格式
+#if DBG_BACKEND >= DBG_BACKEND_ASYNC
+#define DBG_LOG(color, ...)                 \
+        dbg_async_log(color, __func__, __VA_ARGS__);
+#else
 #define DBG_LOG(color, ...)                 \
-        PRINT_ANSI_COLOR(color);            \
-        printf("[%s]: ", __func__);         \
-        printf(__VA_ARGS__);                \
-        PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-        printf("\n");                       
+        dbg_sync_log(color, __func__, __VA_ARGS__);
+#endif
+
+// 带等级的日志输出
+#if DBG_FLIGHT
+#define DBG_LOG_FLIGHT(level)   ((level) <= DBG_FLIGHT_LEVEL)
+#else
+#define DBG_LOG_FLIGHT(level)   0
+#endif
+
+// 调用点描述符在编译期生成，关闭的调用点只有一次读以及比较，不会对参数求值
+// 格式字符串可以是变量，这样的调用点在二进制后端输出文本记录，见 DBG_SITE_FMT
+// 开启飞行记录器的等级始终调用 dbg_site_log，参数只求值一次
+#define DBG_LOG_AT(level, color, ...)                                   \
+        do                                                              \
+        {                                                               \
+            DBG_SITE_DEFINE(_dbg_site, level, __VA_ARGS__);             \
+            if (DBG_LOG_FLIGHT(level) || DBG_SITE_ENABLED(_dbg_site))   \
+            {                                                           \
+                dbg_site_log(&_dbg_site, color,                         \
+                             DBG_LOG_FLIGHT(level)                      \
+                             ? DBG_SITE_LOG_FLIGHT : 0, __VA_ARGS__);   \
+            }                                                           \
+        } while (0)
 
 // [调试]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_DEBUG
-#define DBG_LOGD(...) DBG_LOG(ANSI_COLOR_BLUE, __VA_ARGS__);
+#define DBG_LOGD(...) DBG_LOG_AT(DBG_LOG_DEBUG, ANSI_COLOR_BLUE, __VA_ARGS__);
 #else
 #define DBG_LOGD(...)
 #endif
 
 // [普通]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_INFO
-#define DBG_LOGI(...) DBG_LOG(ANSI_COLOR_GREEN, __VA_ARGS__);
+#define DBG_LOGI(...) DBG_LOG_AT(DBG_LOG_INFO, ANSI_COLOR_GREEN, __VA_ARGS__);
 #else
 #define DBG_LOGI(...)
 #endif
 
 // [警告]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_WARNING
-#define DBG_LOGW(...) DBG_LOG(ANSI_COLOR_YELLOW, __VA_ARGS__);
+#define DBG_LOGW(...) DBG_LOG_AT(DBG_LOG_WARNING, ANSI_COLOR_YELLOW, __VA_ARGS__);
 #else
 #define DBG_LOGW(...)
 #endif
 
 // [错误]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_ERROR
-#define DBG_LOGE(...) DBG_LOG(ANSI_COLOR_RED, __VA_ARGS__);
+#define DBG_LOGE(...) DBG_LOG_AT(DBG_LOG_ERROR, ANSI_COLOR_RED, __VA_ARGS__);
 #else
 #define DBG_LOGE(...)
 #endif
@@ -110,20 +186,34 @@
  * @note    第一个参数传入颜色，第二个参数传入需要打印的信息
  * @note    最好传入两个宏以避免警告
 */
+#if DBG_BACKEND >= DBG_BACKEND_ASYNC
+#define ADVANCED_LOG(color, ...) \
+    dbg_async_log(color, NULL, __VA_ARGS__);
+#else
 #define ADVANCED_LOG(color, ...) \
-    PRINT_ANSI_COLOR(color); \
-    printf(__VA_ARGS__); \
-    PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-    printf("\n");
+    dbg_sync_log(color, NULL, __VA_ARGS__);
+#endif
 
 
+/**
+ * @brief   同步输出一行日志
+ * @note    整行在线程私有缓冲区中格式化后一次write输出，多线程输出的行不会交错
+ * @param   [in] color  颜色转义序列，可以为NULL
+ * @param   [in] func   函数名，为NULL时不输出时间以及 [func]: 前缀
+ * @return  dbg_sync_vlog 返回输出的字节数
+*/
+void dbg_sync_log(const char *color, const char *func, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+size_t dbg_sync_vlog(const char *color, const char *func, const char *fmt, va_list ap);
+
 /**
  * @brief   以16进制打印数据
  * @param   [in] data   打印的数据数据
  * @param   [in] len    数据长度 
- * @note    输出格式 = %02X
+ * @note    输出格式 = %02X, 带表头以及ASCII列
+ * @note    整行格式化后批量write输出，见 hexdump.h
 */
-void print_hex_table(uint8_t *data, uint16_t len);
+void print_hex_table(const uint8_t *data, size_t len);
 
 /**
  * @brief   彩色打印示例
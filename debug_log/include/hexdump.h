@@ -0,0 +1,80 @@
+#ifndef HEXDUMP_H_
+#define HEXDUMP_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   高性能16进制转储
+ * @note    按行在缓冲区内完成格式化(半字节查表)，缓冲区满或结束时才调用一次write，
+ *          转储1MB数据只需要十几次系统调用
+ * @note    不带颜色和表头时输出与 `xxd -g 1` 一致(HEXDUMP_UPPER 对应 `xxd -u -g 1`)
+*/
+
+/************************** 输出格式选项 *********************************/
+// 大写16进制
+#define HEXDUMP_UPPER       0x01
+// 输出ASCII列，不可打印字符显示为'.'
+#define HEXDUMP_ASCII       0x02
+// 彩色输出(偏移量青色，数据品红色)
+#define HEXDUMP_COLOR       0x04
+// 输出表头 00 01 ... 0F
+#define HEXDUMP_HEADER      0x08
+// 与 xxd -g 1 兼容的格式
+#define HEXDUMP_XXD         (HEXDUMP_ASCII)
+
+// 每行字节数
+#define HEXDUMP_ROW_BYTES   16
+// 输出缓冲区大小
+#define HEXDUMP_BUF_SIZE    (64 * 1024)
+
+/**
+ * @brief   流式转储上下文
+ * @note    数据可以分多次传入，不足一行的数据会暂存到下次调用
+*/
+typedef struct
+{
+    int fd;                             // 输出文件描述符
+    unsigned int flags;                 // 输出格式选项
+    size_t offset;                      // 下一行的起始偏移量
+    uint8_t row[HEXDUMP_ROW_BYTES];     // 不足一行的数据
+    size_t row_len;                     // 不足一行的数据长度
+    size_t used;                        // 输出缓冲区已使用的长度
+    char out[HEXDUMP_BUF_SIZE];         // 输出缓冲区
+}hexdump_t;
+
+/**
+ * @brief   初始化流式转储
+ * @param   [out] hd    转储上下文
+ * @param   [in]  fd    输出文件描述符
+ * @param   [in]  flags 输出格式选项 HEXDUMP_xxx
+*/
+void hexdump_init(hexdump_t *hd, int fd, unsigned int flags);
+
+/**
+ * @brief   追加需要转储的数据
+ * @return  成功返回0，写入失败返回-1(errno有效)
+*/
+int hexdump_update(hexdump_t *hd, const void *data, size_t len);
+
+/**
+ * @brief   输出不足一行的剩余数据并刷新缓冲区
+ * @return  成功返回0，写入失败返回-1(errno有效)
+*/
+int hexdump_finish(hexdump_t *hd);
+
+/**
+ * @brief   一次性转储内存中的数据
+ * @note    上下文分配在堆上，可以在栈很小的线程中调用
+ * @return  成功返回0，失败返回-1(errno有效)
+*/
+int hexdump_buffer(int fd, const void *data, size_t len, unsigned int flags);
+
+/**
+ * @brief   从文件描述符读取数据并转储，直到文件结束
+ * @param   [in] in_fd  输入文件描述符(文件、管道、套接字均可)
+ * @param   [in] out_fd 输出文件描述符
+ * @return  成功返回0，失败返回-1(errno有效)
+*/
+int hexdump_stream(int in_fd, int out_fd, unsigned int flags);
+
+#endif
@@ -1,10 +1,26 @@
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "debug_log.h"
+#include "hexdump.h"
 
 
-int main(void)
+int main(int argc, char *argv[])
 {
+    // 16进制转储文件, 输出格式与 xxd -u -g 1 一致: ./main <file>
+    if (argc > 1)
+    {
+        int fd = open(argv[1], O_RDONLY);
+        if (fd < 0)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        int ret = hexdump_stream(fd, STDOUT_FILENO, HEXDUMP_XXD | HEXDUMP_UPPER);
+        close(fd);
+        return ret == 0 ? 0 : 1;
+    }
     // 彩色打印Demo
     debug_log_demo();
     return 0;
-}
\ No newline at end of file
+}
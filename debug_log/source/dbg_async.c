@@ -0,0 +1,527 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "debug_log.h"
+#include "dbg_async.h"
+#include "dbg_binary.h"
+#include "dbg_clock.h"
+#include "dbg_format.h"
+#include "dbg_io.h"
+
+// 记录按16字节对齐，保证环形缓冲区末尾剩余空间要么为0要么能放下一个记录头
+#define RECORD_ALIGN        16
+#define RECORD_ALIGN_UP(n)  (((n) + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1))
+// 填充记录，表示从当前位置跳到缓冲区起始处
+#define RECORD_FLAG_PAD     0x01
+// 输出时在记录前加上时间
+#define RECORD_FLAG_TIME    0x04
+// 批量输出缓冲区大小
+#define OUT_BUF_SIZE        (64 * 1024)
+// 缓存行大小
+#define CACHE_LINE          64
+
+// 记录头
+typedef struct
+{
+    uint64_t ts;        // 时间戳(dbg_clock 计数)
+    uint32_t len;       // 正文长度
+    uint32_t flags;     // RECORD_FLAG_xxx
+}stc_record_t;
+
+// 线程私有的SPSC环形缓冲区
+typedef struct dbg_ring
+{
+    // 生产者写位置，只增不减
+    _Alignas(CACHE_LINE) _Atomic size_t tail;
+    // 生产者缓存的消费者读位置，减少对 head 所在缓存行的访问
+    size_t cached_head;
+    // 消费者读位置，只增不减
+    _Alignas(CACHE_LINE) _Atomic size_t head;
+    // 丢弃的记录数
+    _Alignas(CACHE_LINE) _Atomic uint64_t dropped;
+    // 所属线程已经退出
+    _Atomic int closed;
+    struct dbg_ring *next;
+    char buf[DBG_ASYNC_RING_SIZE];
+}dbg_ring_t;
+
+_Static_assert((DBG_ASYNC_RING_SIZE & (DBG_ASYNC_RING_SIZE - 1)) == 0, "DBG_ASYNC_RING_SIZE must be a power of 2");
+_Static_assert(DBG_ASYNC_MAX_RECORD + 2 * sizeof(stc_record_t) < DBG_ASYNC_RING_SIZE / 2, "DBG_ASYNC_MAX_RECORD too large");
+
+// 当前线程的环形缓冲区
+static __thread dbg_ring_t *tls_ring;
+// 所有环形缓冲区，只在注册以及回收时加锁
+static dbg_ring_t *ring_list;
+static pthread_mutex_t ring_lock = PTHREAD_MUTEX_INITIALIZER;
+// 线程退出时关闭环形缓冲区
+static pthread_key_t ring_key;
+
+static pthread_once_t async_once = PTHREAD_ONCE_INIT;
+static pthread_t async_thread;
+static _Atomic int async_running;
+// dbg_async_stop 之后的记录不再进入环形缓冲区，提交时直接写出
+static _Atomic int async_stopped;
+static _Atomic int async_policy = DBG_ASYNC_POLICY;
+static _Atomic uint64_t async_dropped;
+// 后台线程完成的输出轮数
+static _Atomic uint64_t async_passes;
+// 正在等待 dbg_async_flush 的线程数，期间不回收线程缓冲区
+static _Atomic int async_flushing;
+// 停止之后直接写出的记录
+static __thread struct
+{
+    stc_record_t hdr;
+    char body[DBG_ASYNC_MAX_RECORD];
+}tls_direct;
+static pthread_mutex_t direct_lock = PTHREAD_MUTEX_INITIALIZER;
+
+uint64_t dbg_async_now(void)
+{
+    return dbg_clock_now();
+}
+
+static void sleep_us(long us)
+{
+    struct timespec ts = {0, us * 1000};
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief   批量输出缓冲区
+*/
+typedef struct
+{
+    int fd;
+    size_t used;
+    char buf[OUT_BUF_SIZE];
+}stc_out_t;
+
+static void out_flush(stc_out_t *out)
+{
+    if (out->used > 0)
+    {
+        if (out->fd >= 0)
+        {
+            dbg_write_all(out->fd, out->buf, out->used);
+        }
+        out->used = 0;
+    }
+}
+
+static void out_append(stc_out_t *out, const char *s, size_t len)
+{
+    if (out->used + len > sizeof(out->buf))
+    {
+        out_flush(out);
+    }
+    memcpy(out->buf + out->used, s, len);
+    out->used += len;
+}
+
+/**
+ * @brief   读取环形缓冲区中下一条记录，跳过填充记录
+ * @return  没有记录时返回NULL
+*/
+static stc_record_t *ring_peek(dbg_ring_t *ring, size_t tail)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (head != tail)
+    {
+        stc_record_t *rec = (stc_record_t *)(ring->buf + (head & (DBG_ASYNC_RING_SIZE - 1)));
+        if (!(rec->flags & RECORD_FLAG_PAD))
+        {
+            return rec;
+        }
+        // 跳到缓冲区起始处
+        head += DBG_ASYNC_RING_SIZE - (head & (DBG_ASYNC_RING_SIZE - 1));
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+    }
+    return NULL;
+}
+
+static void ring_pop(dbg_ring_t *ring, stc_record_t *rec)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + sizeof(*rec) + RECORD_ALIGN_UP(rec->len), memory_order_release);
+}
+
+static void report_dropped(stc_out_t *out, uint64_t n)
+{
+    char line[96];
+    int len = snprintf(line, sizeof(line), "%s[dbg_async]: %llu records dropped%s\n",
+                       COLOR_ENABLE ? ANSI_COLOR_YELLOW : "", (unsigned long long)n,
+                       COLOR_ENABLE ? ANSI_COLOR_RESET : "");
+    out_append(out, line, (size_t)len);
+}
+
+/**
+ * @brief   输出所有环形缓冲区中当前可见的记录
+ * @note    对每个缓冲区先取一次 tail 快照，再按时间戳做多路归并，
+ *          同一批次内不同线程的记录按时间顺序输出
+ * @return  输出的记录数
+*/
+static size_t drain_once(stc_out_t *out, stc_out_t *bin)
+{
+    // 本轮归并的缓冲区以及 tail 快照，只由后台线程使用，线程数增加时扩容
+    static dbg_ring_t **rings;
+    static size_t *tails;
+    static size_t capacity;
+    // 扩容失败时只归并一部分，下一轮从 skip 个之后开始，保证每个缓冲区都会被输出
+    static size_t skip;
+    size_t count = 0;
+    size_t total = 0;
+
+    pthread_mutex_lock(&ring_lock);
+    size_t nrings = 0;
+    for (dbg_ring_t *ring = ring_list; ring != NULL; ring = ring->next)
+    {
+        nrings++;
+    }
+    if (nrings > capacity)
+    {
+        size_t n = capacity ? capacity : 64;
+        while (n < nrings) n *= 2;
+        dbg_ring_t **r = realloc(rings, n * sizeof(*rings));
+        if (r != NULL) rings = r;
+        size_t *t = realloc(tails, n * sizeof(*tails));
+        if (t != NULL) tails = t;
+        if (r != NULL && t != NULL) capacity = n;
+    }
+    if (skip >= nrings) skip = 0;
+    size_t index = 0;
+    // 回收已经退出并且输出完毕的线程缓冲区，dbg_async_flush 等待期间不回收
+    int reclaim = atomic_load(&async_flushing) == 0;
+    for (dbg_ring_t **pp = &ring_list; *pp != NULL; index++)
+    {
+        dbg_ring_t *ring = *pp;
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (reclaim && atomic_load(&ring->closed) && atomic_load(&ring->head) == tail
+            && atomic_load(&ring->dropped) == 0)
+        {
+            *pp = ring->next;
+            free(ring);
+            continue;
+        }
+        if (index >= skip && count < capacity)
+        {
+            rings[count] = ring;
+            tails[count] = tail;
+            count++;
+        }
+        pp = &ring->next;
+    }
+    skip = count < nrings - skip ? skip + count : 0;
+    pthread_mutex_unlock(&ring_lock);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t n = atomic_exchange(&rings[i]->dropped, 0);
+        if (n > 0)
+        {
+            atomic_fetch_add(&async_dropped, n);
+            report_dropped(out, n);
+        }
+    }
+
+    while (1)
+    {
+        // 选出时间戳最小的记录
+        stc_record_t *best = NULL;
+        size_t best_i = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            stc_record_t *rec = ring_peek(rings[i], tails[i]);
+            if (rec != NULL && (best == NULL || rec->ts < best->ts))
+            {
+                best = rec;
+                best_i = i;
+            }
+        }
+        if (best == NULL)
+        {
+            break;
+        }
+        if (best->flags & DBG_ASYNC_RECORD_BINARY)
+        {
+            // 二进制记录写入二进制日志文件，第一次使用时打开
+            if (bin->fd < 0) bin->fd = dbg_bin_fd();
+            out_append(bin, (const char *)(best + 1), best->len);
+        }
+        else
+        {
+            if (best->flags & RECORD_FLAG_TIME)
+            {
+                // 输出时才把计数换算为墙上时间
+                char ts[32];
+                out_append(out, ts, dbg_clock_format(best->ts, ts, sizeof(ts)));
+            }
+            out_append(out, (const char *)(best + 1), best->len);
+        }
+        ring_pop(rings[best_i], best);
+        total++;
+    }
+    out_flush(out);
+    out_flush(bin);
+    atomic_fetch_add_explicit(&async_passes, 1, memory_order_release);
+    return total;
+}
+
+static void *async_main(void *arg)
+{
+    (void)arg;
+    static stc_out_t out = {STDOUT_FILENO, 0, {0}};
+    static stc_out_t bin = {-1, 0, {0}};
+    long idle_us = 50;
+    while (atomic_load(&async_running))
+    {
+        if (drain_once(&out, &bin) > 0)
+        {
+            idle_us = 50;
+            continue;
+        }
+        // 空闲时逐步延长休眠时间
+        sleep_us(idle_us);
+        if (idle_us < 2000) idle_us *= 2;
+    }
+    // 退出前输出剩余记录
+    while (drain_once(&out, &bin) > 0)
+    {
+    }
+    return NULL;
+}
+
+static void ring_close(void *arg)
+{
+    dbg_ring_t *ring = arg;
+    atomic_store(&ring->closed, 1);
+    tls_ring = NULL;
+}
+
+static void async_init(void)
+{
+    pthread_key_create(&ring_key, ring_close);
+    atomic_store(&async_running, 1);
+    pthread_create(&async_thread, NULL, async_main, NULL);
+    atexit(dbg_async_stop);
+}
+
+static dbg_ring_t *ring_get(void)
+{
+    if (tls_ring != NULL)
+    {
+        return tls_ring;
+    }
+    pthread_once(&async_once, async_init);
+    dbg_ring_t *ring = aligned_alloc(CACHE_LINE, sizeof(dbg_ring_t));
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+    memset(ring, 0, offsetof(dbg_ring_t, buf));
+    pthread_mutex_lock(&ring_lock);
+    ring->next = ring_list;
+    ring_list = ring;
+    pthread_mutex_unlock(&ring_lock);
+    pthread_setspecific(ring_key, ring);
+    tls_ring = ring;
+    return ring;
+}
+
+/**
+ * @brief   在环形缓冲区中预留一块连续空间
+ * @return  记录头指针，空间不足并且不阻塞时返回NULL
+*/
+static stc_record_t *ring_reserve(dbg_ring_t *ring, size_t need)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t offset = tail & (DBG_ASYNC_RING_SIZE - 1);
+    // 末尾剩余空间不足时需要先写入填充记录
+    size_t pad = (offset + need > DBG_ASYNC_RING_SIZE) ? DBG_ASYNC_RING_SIZE - offset : 0;
+    long wait_us = 50;
+    while (tail + pad + need - ring->cached_head > DBG_ASYNC_RING_SIZE)
+    {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail + pad + need - ring->cached_head <= DBG_ASYNC_RING_SIZE)
+        {
+            break;
+        }
+        // 后台线程已经停止(进程退出阶段)时不再阻塞
+        if (atomic_load_explicit(&async_policy, memory_order_relaxed) != DBG_ASYNC_BLOCK
+            || !atomic_load_explicit(&async_running, memory_order_relaxed))
+        {
+            if (atomic_load_explicit(&async_policy, memory_order_relaxed) == DBG_ASYNC_DROP_COUNT)
+            {
+                atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            }
+            return NULL;
+        }
+        // 逐步延长等待时间，大量线程同时阻塞时不会抢占后台线程的CPU
+        sleep_us(wait_us);
+        if (wait_us < 1000) wait_us *= 2;
+    }
+    if (pad > 0)
+    {
+        stc_record_t *rec = (stc_record_t *)(ring->buf + offset);
+        rec->flags = RECORD_FLAG_PAD;
+        rec->len = 0;
+        tail += pad;
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        offset = 0;
+    }
+    return (stc_record_t *)(ring->buf + offset);
+}
+
+void *dbg_async_reserve(void)
+{
+    if (atomic_load_explicit(&async_stopped, memory_order_relaxed))
+    {
+        return tls_direct.body;
+    }
+    dbg_ring_t *ring = ring_get();
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+    stc_record_t *rec = ring_reserve(ring, sizeof(stc_record_t) + DBG_ASYNC_MAX_RECORD);
+    return rec != NULL ? rec + 1 : NULL;
+}
+
+/**
+ * @brief   后台线程停止之后同步写出一条记录
+*/
+static void direct_write(const char *body, size_t len, uint64_t ts, uint32_t flags)
+{
+    if (flags & DBG_ASYNC_RECORD_BINARY)
+    {
+        // 多个线程的二进制记录不能交错
+        pthread_mutex_lock(&direct_lock);
+        int fd = dbg_bin_fd();
+        if (fd >= 0)
+        {
+            dbg_write_all(fd, body, len);
+        }
+        pthread_mutex_unlock(&direct_lock);
+        return;
+    }
+    char line[32 + DBG_ASYNC_MAX_RECORD];
+    size_t pos = (flags & RECORD_FLAG_TIME) ? dbg_clock_format(ts, line, 32) : 0;
+    memcpy(line + pos, body, len);
+    dbg_write_all(STDOUT_FILENO, line, pos + len);
+}
+
+void dbg_async_commit(void *body, size_t len, uint64_t ts, uint32_t flags)
+{
+    if (body == tls_direct.body)
+    {
+        direct_write(body, len, ts, flags);
+        return;
+    }
+    dbg_ring_t *ring = tls_ring;
+    stc_record_t *rec = (stc_record_t *)body - 1;
+    rec->ts = ts;
+    rec->len = (uint32_t)len;
+    rec->flags = flags;
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + sizeof(*rec) + RECORD_ALIGN_UP(len), memory_order_release);
+}
+
+void dbg_async_log(const char *color, const char *func, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    dbg_async_vlog(color, func, fmt, ap);
+    va_end(ap);
+}
+
+size_t dbg_async_vlog(const char *color, const char *func, const char *fmt, va_list ap)
+{
+    uint64_t ts = dbg_async_now();
+    char *body = dbg_async_reserve();
+    if (body == NULL)
+    {
+        return 0;
+    }
+
+    // 直接在环形缓冲区内格式化，时间在输出时由后台线程加上
+    size_t len = dbg_vformat_line(body, DBG_ASYNC_MAX_RECORD, color, func, fmt, ap);
+
+    dbg_async_commit(body, len, ts, (DBG_TIMESTAMP && func != NULL) ? RECORD_FLAG_TIME : 0);
+    return len;
+}
+
+void dbg_async_set_policy(int policy)
+{
+    atomic_store(&async_policy, policy);
+}
+
+uint64_t dbg_async_dropped(void)
+{
+    uint64_t n = atomic_load(&async_dropped);
+    pthread_mutex_lock(&ring_lock);
+    for (dbg_ring_t *ring = ring_list; ring != NULL; ring = ring->next)
+    {
+        n += atomic_load(&ring->dropped);
+    }
+    pthread_mutex_unlock(&ring_lock);
+    return n;
+}
+
+void dbg_async_flush(void)
+{
+    if (!atomic_load(&async_running))
+    {
+        return;
+    }
+    // 记录调用时刻每个缓冲区的写位置，等待期间缓冲区不会被回收
+    atomic_fetch_add(&async_flushing, 1);
+    pthread_mutex_lock(&ring_lock);
+    size_t count = 0;
+    for (dbg_ring_t *ring = ring_list; ring != NULL; ring = ring->next)
+    {
+        count++;
+    }
+    dbg_ring_t **rings = malloc((count + 1) * sizeof(*rings));
+    size_t *tails = malloc((count + 1) * sizeof(*tails));
+    count = 0;
+    for (dbg_ring_t *ring = ring_list; ring != NULL && rings != NULL && tails != NULL; ring = ring->next)
+    {
+        rings[count] = ring;
+        tails[count] = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        count++;
+    }
+    pthread_mutex_unlock(&ring_lock);
+    // 一轮输出可能只归并部分缓冲区，逐个等待读位置越过快照
+    for (size_t i = 0; i < count; i++)
+    {
+        while (atomic_load(&async_running)
+               && (intptr_t)(tails[i] - atomic_load_explicit(&rings[i]->head, memory_order_acquire)) > 0)
+        {
+            sleep_us(50);
+        }
+    }
+    free(rings);
+    free(tails);
+    // 最后一条记录所在的一轮结束时输出缓冲区才写出
+    uint64_t pass = atomic_load_explicit(&async_passes, memory_order_acquire);
+    while (atomic_load(&async_running) && atomic_load_explicit(&async_passes, memory_order_acquire) < pass + 1)
+    {
+        sleep_us(50);
+    }
+    atomic_fetch_sub(&async_flushing, 1);
+}
+
+void dbg_async_stop(void)
+{
+    // 之后的记录直接写出，不会留在没有线程输出的缓冲区中
+    atomic_store(&async_stopped, 1);
+    if (atomic_exchange(&async_running, 0))
+    {
+        pthread_join(async_thread, NULL);
+    }
+}
@@ -0,0 +1,166 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "dbg_async.h"
+#include "dbg_binary.h"
+#include "dbg_io.h"
+
+static pthread_mutex_t bin_lock = PTHREAD_MUTEX_INITIALIZER;
+static int bin_fd = -1;
+
+/**
+ * @brief   写入文件头以及所有调用点描述
+*/
+static int bin_write_dictionary(int fd)
+{
+    dbg_bin_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, DBG_BIN_MAGIC, sizeof(hdr.magic));
+    hdr.version = DBG_BIN_VERSION;
+    dbg_clock_calibrate();
+    hdr.clock = dbg_clock_calib;
+    if (dbg_write_all(fd, &hdr, sizeof(hdr)) != 0) return -1;
+
+    size_t count = dbg_site_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        const dbg_site_t *site = dbg_site_get((uint32_t)i);
+        dbg_bin_site_t s;
+        memset(&s, 0, sizeof(s));
+        s.type = DBG_BIN_SITE;
+        s.level = site->level;
+        s.nargs = site->nargs;
+        s.id = site->id;
+        s.line = site->line;
+        s.fmt_len = site->fmt != NULL ? (uint16_t)strlen(site->fmt) : 0;
+        s.func_len = (uint16_t)strlen(site->func);
+        s.file_len = (uint16_t)strlen(site->file);
+        if (dbg_write_all(fd, &s, sizeof(s)) != 0
+            || dbg_write_all(fd, site->fmt, s.fmt_len) != 0
+            || dbg_write_all(fd, site->func, s.func_len) != 0
+            || dbg_write_all(fd, site->file, s.file_len) != 0
+            || dbg_write_all(fd, site->types, s.nargs) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int dbg_bin_open(const char *path)
+{
+    int ret = 0;
+    pthread_mutex_lock(&bin_lock);
+    if (bin_fd < 0)
+    {
+        bin_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (bin_fd < 0 || bin_write_dictionary(bin_fd) != 0)
+        {
+            ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&bin_lock);
+    return ret;
+}
+
+int dbg_bin_fd(void)
+{
+    if (bin_fd < 0)
+    {
+        const char *path = getenv("DBG_BIN_FILE");
+        dbg_bin_open(path != NULL ? path : DBG_BIN_PATH);
+    }
+    return bin_fd;
+}
+
+void dbg_bin_log(const dbg_site_t *site, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    dbg_bin_vlog(site, fmt, ap);
+    va_end(ap);
+}
+
+size_t dbg_bin_vlog(const dbg_site_t *site, const char *fmt, va_list ap)
+{
+    (void)fmt;
+    uint64_t ts = dbg_async_now();
+    uint8_t *rec = dbg_async_reserve();
+    if (rec == NULL)
+    {
+        return 0;
+    }
+    uint8_t *p = rec + sizeof(dbg_bin_log_t);
+    uint8_t *end = rec + DBG_ASYNC_MAX_RECORD;
+
+    for (const uint8_t *t = site->types; *t != DBG_ARG_END; t++)
+    {
+        switch (*t)
+        {
+        case DBG_ARG_INT:
+        {
+            int v = va_arg(ap, int);
+            memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+            break;
+        }
+        case DBG_ARG_LONG:
+        case DBG_ARG_LLONG:
+        {
+            long long v = *t == DBG_ARG_LONG ? va_arg(ap, long) : va_arg(ap, long long);
+            memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+            break;
+        }
+        case DBG_ARG_DOUBLE:
+        {
+            double v = va_arg(ap, double);
+            memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+            break;
+        }
+        case DBG_ARG_LDOUBLE:
+        {
+            long double v = va_arg(ap, long double);
+            memset(p, 0, 16);
+            memcpy(p, &v, sizeof(v) < 16 ? sizeof(v) : 16);
+            p += 16;
+            break;
+        }
+        case DBG_ARG_STR:
+        {
+            // 字符串在调用时刻拷贝，超出剩余空间的部分被截断
+            const char *s = va_arg(ap, const char *);
+            if (s == NULL) s = "(null)";
+            size_t left = (size_t)(end - p);
+            size_t reserve = sizeof(uint16_t) + DBG_MAX_ARGS * 16;
+            uint16_t n = (uint16_t)strnlen(s, left > reserve ? left - reserve : 0);
+            memcpy(p, &n, sizeof(n));
+            memcpy(p + sizeof(n), s, n);
+            p += sizeof(n) + n;
+            break;
+        }
+        default:
+        {
+            uint64_t v = (uint64_t)(uintptr_t)va_arg(ap, void *);
+            memcpy(p, &v, sizeof(v));
+            p += sizeof(v);
+            break;
+        }
+        }
+    }
+
+    dbg_bin_log_t hdr;
+    hdr.type = DBG_BIN_LOG;
+    hdr.reserved = 0;
+    hdr.len = (uint16_t)(p - rec - sizeof(hdr));
+    hdr.id = site->id;
+    hdr.ts = ts;
+    memcpy(rec, &hdr, sizeof(hdr));
+    dbg_async_commit(rec, (size_t)(p - rec), ts, DBG_ASYNC_RECORD_BINARY);
+    return (size_t)(p - rec);
+}
@@ -0,0 +1,164 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include "dbg_clock.h"
+
+// 校准时 rdtsc 与 clock_gettime 交替采样的次数，取耗时最短的一次
+#define CALIB_SAMPLES       8
+// 两次采样之间的最短间隔(纳秒)
+#define CALIB_INTERVAL_NS   10000000
+
+// 默认按纳秒换算，对应 DBG_CLOCK_MONOTONIC
+dbg_clock_calib_t dbg_clock_calib = { 0, 0, (uint64_t)1 << DBG_CLOCK_SHIFT, 0 };
+int dbg_clock_use_tsc;
+static pthread_once_t calib_once = PTHREAD_ONCE_INIT;
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#if DBG_CLOCK == DBG_CLOCK_TSC
+/**
+ * @brief   CPU是否支持 invariant TSC (CPUID.80000007H:EDX[8])
+*/
+static int tsc_invariant(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000007
+        || !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+    {
+        return 0;
+    }
+    return (edx >> 8) & 1;
+}
+
+/**
+ * @brief   同时读取TSC以及 CLOCK_MONOTONIC
+*/
+static void tsc_sample(uint64_t *tsc, uint64_t *ns)
+{
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < CALIB_SAMPLES; i++)
+    {
+        uint64_t t0 = __rdtsc();
+        uint64_t n = monotonic_ns();
+        uint64_t t1 = __rdtsc();
+        if (t1 - t0 < best)
+        {
+            best = t1 - t0;
+            *tsc = t0 + (t1 - t0) / 2;
+            *ns = n;
+        }
+    }
+}
+#endif
+
+#if DBG_CLOCK == DBG_CLOCK_TSC
+// 进程启动时的采样
+static uint64_t calib_tsc0;
+static uint64_t calib_ns0;
+#endif
+
+/**
+ * @brief   进程启动时选择时钟来源并记录校准的起点，优先于其他构造函数执行
+ * @note    这里不等待，第二次采样推迟到 dbg_clock_calibrate；
+ *          起点之后再读一次TSC，没有递增时(TSC不可用)在第一个时间戳之前改用 CLOCK_MONOTONIC
+*/
+__attribute__((constructor(101))) static void dbg_clock_init(void)
+{
+    struct timespec rt;
+    uint64_t mono = monotonic_ns();
+    clock_gettime(CLOCK_REALTIME, &rt);
+    dbg_clock_calib.realtime_offset = (int64_t)rt.tv_sec * 1000000000 + rt.tv_nsec - (int64_t)mono;
+
+#if DBG_CLOCK == DBG_CLOCK_TSC
+    if (tsc_invariant())
+    {
+        tsc_sample(&calib_tsc0, &calib_ns0);
+        dbg_clock_use_tsc = __rdtsc() > calib_tsc0;
+    }
+#endif
+}
+
+/**
+ * @brief   第二次采样，按两次采样计算换算参数
+*/
+static void clock_calibrate(void)
+{
+#if DBG_CLOCK == DBG_CLOCK_TSC
+    if (!dbg_clock_use_tsc)
+    {
+        return;
+    }
+    uint64_t elapsed = monotonic_ns() - calib_ns0;
+    if (elapsed < CALIB_INTERVAL_NS)
+    {
+        // 进程刚启动就需要换算，只等待剩余的时间
+        struct timespec ts = {0, (long)(CALIB_INTERVAL_NS - elapsed)};
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+    }
+    uint64_t tsc1, ns1;
+    tsc_sample(&tsc1, &ns1);
+    dbg_clock_calib.base_ticks = calib_tsc0;
+    dbg_clock_calib.base_ns = calib_ns0;
+    // 时钟来源已经确定，不再切换；采样异常时保持每个计数1纳秒，时间戳之间仍然可以比较
+    if (tsc1 > calib_tsc0 && ns1 > calib_ns0)
+    {
+        dbg_clock_calib.mult = (uint64_t)(((unsigned __int128)(ns1 - calib_ns0) << DBG_CLOCK_SHIFT)
+                                          / (tsc1 - calib_tsc0));
+    }
+#endif
+}
+
+void dbg_clock_calibrate(void)
+{
+    pthread_once(&calib_once, clock_calibrate);
+}
+
+uint64_t dbg_clock_ticks(uint64_t ns)
+{
+    dbg_clock_calibrate();
+    return (uint64_t)(((unsigned __int128)ns << DBG_CLOCK_SHIFT) / dbg_clock_calib.mult);
+}
+
+size_t dbg_clock_format(uint64_t ticks, char *buf, size_t size)
+{
+    // 同一秒内只调用一次 localtime_r
+    static __thread int64_t cached_sec = -1;
+    static __thread char cached[16];
+
+    dbg_clock_calibrate();
+    int64_t ns = (int64_t)dbg_clock_to_ns(&dbg_clock_calib, ticks) + dbg_clock_calib.realtime_offset;
+    int64_t sec = ns / 1000000000;
+    if (sec != cached_sec)
+    {
+        time_t t = (time_t)sec;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(cached, sizeof(cached), "%H:%M:%S", &tm);
+        cached_sec = sec;
+    }
+    // HH:MM:SS.uuuuuu + 空格
+    char tmp[16];
+    long us = (long)(ns % 1000000000 / 1000);
+    memcpy(tmp, cached, 8);
+    tmp[8] = '.';
+    for (int i = 14; i >= 9; i--)
+    {
+        tmp[i] = (char)('0' + us % 10);
+        us /= 10;
+    }
+    tmp[15] = ' ';
+    size_t n = size > sizeof(tmp) ? sizeof(tmp) : (size > 0 ? size - 1 : 0);
+    memcpy(buf, tmp, n);
+    if (size > 0) buf[n] = '\0';
+    return n;
+}
@@ -0,0 +1,203 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "dbg_flight.h"
+#include "dbg_format.h"
+
+_Static_assert((DBG_FLIGHT_SEG_SIZE & (DBG_FLIGHT_SEG_SIZE - 1)) == 0, "DBG_FLIGHT_SEG_SIZE must be a power of 2");
+_Static_assert(sizeof(dbg_flight_seg_t) == 64, "dbg_flight_seg_t must fill one cache line");
+
+// 记录的最大总长度
+#define FLIGHT_RECORD_MAX   (sizeof(dbg_flight_record_t) + DBG_FLIGHT_MAX_RECORD + sizeof(uint32_t))
+
+static pthread_mutex_t flight_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t flight_once = PTHREAD_ONCE_INIT;
+// 映射的文件，为NULL时表示未打开或者打开失败
+static dbg_flight_header_t *flight_map;
+// 线程退出时释放分段
+static pthread_key_t flight_key;
+
+// 当前线程的分段，为NULL时没有分配
+static __thread dbg_flight_seg_t *tls_seg;
+static __thread uint32_t tls_tid;
+// 当前线程没有空闲分段时，再过多少条记录重新尝试
+static __thread uint32_t tls_retry;
+// 当前线程没有分段期间丢弃的记录数
+static __thread uint32_t tls_dropped;
+
+static dbg_flight_seg_t *seg_at(dbg_flight_header_t *map, uint32_t i)
+{
+    return (dbg_flight_seg_t *)((char *)(map + 1) + (size_t)i * (sizeof(dbg_flight_seg_t) + DBG_FLIGHT_SEG_SIZE));
+}
+
+int dbg_flight_open(const char *path)
+{
+    int ret = 0;
+    pthread_mutex_lock(&flight_lock);
+    if (flight_map == NULL)
+    {
+        char file[256];
+        char prev[sizeof(file) + 8];
+        dbg_format_path(file, sizeof(file), path);
+        // 不覆盖上一次运行的记录
+        snprintf(prev, sizeof(prev), "%s.prev", file);
+        rename(file, prev);
+        size_t size = sizeof(dbg_flight_header_t)
+                      + (size_t)DBG_FLIGHT_SEGMENTS * (sizeof(dbg_flight_seg_t) + DBG_FLIGHT_SEG_SIZE);
+        int fd = open(file, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        void *map = MAP_FAILED;
+        if (fd >= 0 && ftruncate(fd, (off_t)size) == 0)
+        {
+            map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        if (map == MAP_FAILED)
+        {
+            ret = -1;
+        }
+        else
+        {
+            dbg_flight_header_t *hdr = map;
+            hdr->version = DBG_FLIGHT_VERSION;
+            hdr->segments = DBG_FLIGHT_SEGMENTS;
+            hdr->seg_size = DBG_FLIGHT_SEG_SIZE;
+            hdr->pid = (uint32_t)getpid();
+            dbg_clock_calibrate();
+            hdr->clock = dbg_clock_calib;
+            // 最后写入魔数，导出工具据此判断文件是否完整
+            memcpy(hdr->magic, DBG_FLIGHT_MAGIC, sizeof(hdr->magic));
+            __atomic_store_n(&flight_map, hdr, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&flight_lock);
+    return ret;
+}
+
+static void flight_release(void *arg)
+{
+    dbg_flight_seg_t *seg = arg;
+    // 分段内容保留，下一个线程从当前位置继续写入
+    __atomic_store_n(&seg->owner, 0, __ATOMIC_RELEASE);
+    tls_seg = NULL;
+}
+
+static void flight_init(void)
+{
+    pthread_key_create(&flight_key, flight_release);
+    if (__atomic_load_n(&flight_map, __ATOMIC_ACQUIRE) == NULL)
+    {
+        const char *path = getenv("DBG_FLIGHT_FILE");
+        dbg_flight_open(path != NULL ? path : DBG_FLIGHT_PATH);
+    }
+}
+
+/**
+ * @brief   为当前线程分配一个空闲分段
+ * @note    分段用完时不是永久放弃: 每 DBG_FLIGHT_RETRY 条记录重新扫描一次，其他线程退出后可以拿到空出的分段
+*/
+static dbg_flight_seg_t *seg_get(void)
+{
+    if (tls_seg != NULL)
+    {
+        return tls_seg;
+    }
+    if (tls_retry > 0)
+    {
+        tls_retry--;
+        return NULL;
+    }
+    pthread_once(&flight_once, flight_init);
+    dbg_flight_header_t *map = __atomic_load_n(&flight_map, __ATOMIC_ACQUIRE);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    if (tls_tid == 0)
+    {
+        tls_tid = (uint32_t)syscall(SYS_gettid);
+    }
+    for (uint32_t i = 0; i < DBG_FLIGHT_SEGMENTS; i++)
+    {
+        dbg_flight_seg_t *seg = seg_at(map, (tls_tid + i) % DBG_FLIGHT_SEGMENTS);
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&seg->owner, &expected, tls_tid, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            pthread_setspecific(flight_key, seg);
+            tls_seg = seg;
+            return seg;
+        }
+    }
+    tls_retry = DBG_FLIGHT_RETRY;
+    return NULL;
+}
+
+/**
+ * @brief   写入一条记录到当前线程的分段
+*/
+static void seg_vwrite(dbg_flight_seg_t *seg, uint64_t ts, uint32_t level, const char *func,
+                       const char *fmt, va_list ap)
+{
+    // 记录头 + "[func]: " + 正文 + 记录总长度
+    char rec[FLIGHT_RECORD_MAX + 1];
+    char *body = rec + sizeof(dbg_flight_record_t);
+    size_t n = dbg_format(body, DBG_FLIGHT_MAX_RECORD + 1, "[%s]: ", func);
+    n += dbg_vformat(body + n, DBG_FLIGHT_MAX_RECORD + 1 - n, fmt, ap);
+
+    dbg_flight_record_t hdr = { 0 };
+    hdr.len = (uint32_t)(sizeof(hdr) + n + sizeof(uint32_t));
+    hdr.tid = tls_tid;
+    hdr.ts = ts;
+    hdr.level = level;
+    memcpy(rec, &hdr, sizeof(hdr));
+    memcpy(body + n, &hdr.len, sizeof(hdr.len));
+
+    // 数据区首尾相接，单个线程独占分段，写完后再发布 head
+    char *data = (char *)(seg + 1);
+    uint64_t head = seg->head;
+    size_t off = head & (DBG_FLIGHT_SEG_SIZE - 1);
+    size_t first = DBG_FLIGHT_SEG_SIZE - off < hdr.len ? DBG_FLIGHT_SEG_SIZE - off : hdr.len;
+    memcpy(data + off, rec, first);
+    memcpy(data, rec + first, hdr.len - first);
+    __atomic_store_n(&seg->head, head + hdr.len, __ATOMIC_RELEASE);
+}
+
+static void seg_write(dbg_flight_seg_t *seg, uint64_t ts, uint32_t level, const char *func, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    seg_vwrite(seg, ts, level, func, fmt, ap);
+    va_end(ap);
+}
+
+void dbg_flight_vlog(const dbg_site_t *site, uint64_t ts, const char *fmt, va_list ap)
+{
+    dbg_flight_seg_t *seg = seg_get();
+    if (seg == NULL)
+    {
+        dbg_flight_header_t *map = __atomic_load_n(&flight_map, __ATOMIC_ACQUIRE);
+        if (map != NULL)
+        {
+            __atomic_fetch_add(&map->dropped, 1, __ATOMIC_RELAXED);
+            tls_dropped++;
+        }
+        return;
+    }
+    if (tls_dropped > 0)
+    {
+        // 在本线程的记录中标出丢失的位置
+        seg_write(seg, ts, site->level, "dbg_flight", "%u records lost waiting for a free segment",
+                  tls_dropped);
+        tls_dropped = 0;
+    }
+    seg_vwrite(seg, ts, site->level, site->func, fmt, ap);
+}
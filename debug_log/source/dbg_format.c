@@ -0,0 +1,394 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "debug_log.h"
+#include "dbg_format.h"
+
+// 长度修饰符
+#define LEN_NONE    0
+#define LEN_HH      1
+#define LEN_H       2
+#define LEN_L       3
+#define LEN_LL      4
+#define LEN_Z       5
+#define LEN_J       6
+#define LEN_T       7
+#define LEN_BIG_L   8
+
+// 解析后的转换说明
+typedef struct
+{
+    int left;           // '-'
+    int zero;           // '0'
+    int simple;         // 没有 '+' ' ' '#' '\'' 标志
+    int width;
+    int prec;           // 未指定时为-1
+    int len;            // LEN_xxx
+    char conv;
+}fmt_spec_t;
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+/**
+ * @brief   按宽度填充输出 prefix + body
+ * @note    zero 填充时 '0' 放在前缀(符号或0x)之后
+*/
+static char *emit(char *p, char *end, const fmt_spec_t *spec, const char *prefix, size_t prefix_len,
+                  const char *body, size_t body_len)
+{
+    size_t total = prefix_len + body_len;
+    size_t pad = spec->width > 0 && (size_t)spec->width > total ? (size_t)spec->width - total : 0;
+    char fill = spec->zero && !spec->left ? '0' : ' ';
+    if (!spec->left && fill == ' ')
+    {
+        for (; pad > 0 && p < end; pad--) *p++ = ' ';
+    }
+    for (size_t i = 0; i < prefix_len && p < end; i++) *p++ = prefix[i];
+    if (!spec->left && fill == '0')
+    {
+        for (; pad > 0 && p < end; pad--) *p++ = '0';
+    }
+    size_t n = (size_t)(end - p) < body_len ? (size_t)(end - p) : body_len;
+    memcpy(p, body, n);
+    p += n;
+    for (; pad > 0 && p < end; pad--) *p++ = ' ';
+    return p;
+}
+
+static size_t utoa_rev(char *tmp, unsigned long long v, unsigned base, const char *digits)
+{
+    size_t n = 0;
+    do
+    {
+        tmp[n++] = digits[v % base];
+        v /= base;
+    } while (v != 0);
+    return n;
+}
+
+static char *emit_uint(char *p, char *end, const fmt_spec_t *spec, const char *prefix, size_t prefix_len,
+                       unsigned long long v, unsigned base, const char *digits)
+{
+    char tmp[24];
+    char body[24];
+    size_t n = utoa_rev(tmp, v, base, digits);
+    for (size_t i = 0; i < n; i++)
+    {
+        body[i] = tmp[n - 1 - i];
+    }
+    return emit(p, end, spec, prefix, prefix_len, body, n);
+}
+
+/**
+ * @brief   交给 snprintf 处理单个转换说明
+*/
+static char *fallback(char *p, char *end, const fmt_spec_t *spec, const char *flags, size_t flags_len,
+                      va_list *ap)
+{
+    static const char *const len_str[] = { "", "hh", "h", "l", "ll", "z", "j", "t", "L" };
+    char f[48];
+    size_t n = 0;
+    f[n++] = '%';
+    // '*' 给出的负宽度等价于 '-'
+    if (spec->left) f[n++] = '-';
+    for (size_t i = 0; i < flags_len; i++)
+    {
+        if (flags[i] != '-') f[n++] = flags[i];
+    }
+    if (spec->width > 0) n += (size_t)snprintf(f + n, sizeof(f) - n, "%d", spec->width);
+    if (spec->prec >= 0) n += (size_t)snprintf(f + n, sizeof(f) - n, ".%d", spec->prec);
+    n += (size_t)snprintf(f + n, sizeof(f) - n, "%s%c", len_str[spec->len], spec->conv);
+
+    size_t room = (size_t)(end - p) + 1;
+    int ret;
+    switch (spec->conv)
+    {
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        if (spec->len == LEN_BIG_L)
+            ret = snprintf(p, room, f, va_arg(*ap, long double));
+        else
+            ret = snprintf(p, room, f, va_arg(*ap, double));
+        break;
+    case 's': case 'p':
+        ret = snprintf(p, room, f, va_arg(*ap, void *));
+        break;
+    default:
+        switch (spec->len)
+        {
+        case LEN_L:     ret = snprintf(p, room, f, va_arg(*ap, long)); break;
+        case LEN_LL:    ret = snprintf(p, room, f, va_arg(*ap, long long)); break;
+        case LEN_Z:     ret = snprintf(p, room, f, va_arg(*ap, size_t)); break;
+        case LEN_J:     ret = snprintf(p, room, f, va_arg(*ap, intmax_t)); break;
+        case LEN_T:     ret = snprintf(p, room, f, va_arg(*ap, ptrdiff_t)); break;
+        default:        ret = snprintf(p, room, f, va_arg(*ap, int)); break;
+        }
+        break;
+    }
+    if (ret > 0)
+    {
+        p += (size_t)ret < room ? (size_t)ret : room - 1;
+    }
+    return p;
+}
+
+// 按长度修饰符读取有符号整数
+static long long arg_signed(const fmt_spec_t *spec, va_list *ap)
+{
+    switch (spec->len)
+    {
+    case LEN_HH:    return (signed char)va_arg(*ap, int);
+    case LEN_H:     return (short)va_arg(*ap, int);
+    case LEN_L:     return va_arg(*ap, long);
+    case LEN_LL:    return va_arg(*ap, long long);
+    case LEN_Z:     return (long long)va_arg(*ap, size_t);
+    case LEN_J:     return va_arg(*ap, intmax_t);
+    case LEN_T:     return va_arg(*ap, ptrdiff_t);
+    default:        return va_arg(*ap, int);
+    }
+}
+
+// 按长度修饰符读取无符号整数
+static unsigned long long arg_unsigned(const fmt_spec_t *spec, va_list *ap)
+{
+    switch (spec->len)
+    {
+    case LEN_HH:    return (unsigned char)va_arg(*ap, unsigned int);
+    case LEN_H:     return (unsigned short)va_arg(*ap, unsigned int);
+    case LEN_L:     return va_arg(*ap, unsigned long);
+    case LEN_LL:    return va_arg(*ap, unsigned long long);
+    case LEN_Z:     return va_arg(*ap, size_t);
+    case LEN_J:     return va_arg(*ap, uintmax_t);
+    case LEN_T:     return (unsigned long long)va_arg(*ap, ptrdiff_t);
+    default:        return va_arg(*ap, unsigned int);
+    }
+}
+
+size_t dbg_vformat(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    char *p = buf;
+    char *end = buf + size - 1;
+    va_list args;
+    va_copy(args, ap);
+
+    while (*fmt != '\0' && p < end)
+    {
+        if (*fmt != '%')
+        {
+            // 复制到下一个 '%'
+            const char *pct = strchr(fmt, '%');
+            size_t n = pct != NULL ? (size_t)(pct - fmt) : strlen(fmt);
+            if (n > (size_t)(end - p)) n = (size_t)(end - p);
+            memcpy(p, fmt, n);
+            p += n;
+            fmt += n;
+            continue;
+        }
+        fmt++;
+        if (*fmt == '%')
+        {
+            *p++ = '%';
+            fmt++;
+            continue;
+        }
+
+        fmt_spec_t spec = { 0, 0, 1, 0, -1, LEN_NONE, 0 };
+        const char *flags = fmt;
+        for (;; fmt++)
+        {
+            if (*fmt == '-') spec.left = 1;
+            else if (*fmt == '0') spec.zero = 1;
+            else if (*fmt == '+' || *fmt == ' ' || *fmt == '#' || *fmt == '\'') spec.simple = 0;
+            else break;
+        }
+        size_t flags_len = (size_t)(fmt - flags);
+        if (*fmt == '*')
+        {
+            spec.width = va_arg(args, int);
+            if (spec.width < 0)
+            {
+                spec.left = 1;
+                spec.width = -spec.width;
+            }
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9')
+        {
+            spec.width = spec.width * 10 + (*fmt++ - '0');
+        }
+        if (*fmt == '.')
+        {
+            fmt++;
+            spec.prec = 0;
+            if (*fmt == '*')
+            {
+                spec.prec = va_arg(args, int);
+                fmt++;
+            }
+            while (*fmt >= '0' && *fmt <= '9')
+            {
+                spec.prec = spec.prec * 10 + (*fmt++ - '0');
+            }
+        }
+        switch (*fmt)
+        {
+        case 'h':
+            spec.len = fmt[1] == 'h' ? LEN_HH : LEN_H;
+            fmt += spec.len == LEN_HH ? 2 : 1;
+            break;
+        case 'l':
+            spec.len = fmt[1] == 'l' ? LEN_LL : LEN_L;
+            fmt += spec.len == LEN_LL ? 2 : 1;
+            break;
+        case 'q': spec.len = LEN_LL; fmt++; break;
+        case 'z': spec.len = LEN_Z; fmt++; break;
+        case 'j': spec.len = LEN_J; fmt++; break;
+        case 't': spec.len = LEN_T; fmt++; break;
+        case 'L': spec.len = LEN_BIG_L; fmt++; break;
+        default: break;
+        }
+        spec.conv = *fmt;
+        if (spec.conv == '\0')
+        {
+            break;
+        }
+        fmt++;
+        // '-' 与 '0' 同时出现时忽略 '0'，整数指定精度时也忽略 '0'
+        if (spec.left) spec.zero = 0;
+
+        switch (spec.conv)
+        {
+        case 'd':
+        case 'i':
+            if (spec.simple && spec.prec < 0)
+            {
+                long long v = arg_signed(&spec, &args);
+                unsigned long long u = v < 0 ? 0ull - (unsigned long long)v : (unsigned long long)v;
+                p = emit_uint(p, end, &spec, "-", v < 0, u, 10, hex_lower);
+                continue;
+            }
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+            if (spec.simple && spec.prec < 0)
+            {
+                unsigned long long v = arg_unsigned(&spec, &args);
+                p = emit_uint(p, end, &spec, NULL, 0, v, spec.conv == 'u' ? 10 : 16,
+                              spec.conv == 'X' ? hex_upper : hex_lower);
+                continue;
+            }
+            break;
+        case 'c':
+            if (spec.len == LEN_NONE)
+            {
+                char c = (char)va_arg(args, int);
+                spec.zero = 0;
+                p = emit(p, end, &spec, NULL, 0, &c, 1);
+                continue;
+            }
+            break;
+        case 's':
+            if (spec.len == LEN_NONE)
+            {
+                const char *s = va_arg(args, const char *);
+                if (s == NULL)
+                {
+                    // 与 glibc 一致: 精度不足6时输出空字符串
+                    s = spec.prec < 0 || spec.prec >= 6 ? "(null)" : "";
+                }
+                size_t n = spec.prec >= 0 ? strnlen(s, (size_t)spec.prec) : strlen(s);
+                spec.zero = 0;
+                p = emit(p, end, &spec, NULL, 0, s, n);
+                continue;
+            }
+            break;
+        case 'p':
+            if (spec.simple && spec.prec < 0)
+            {
+                void *ptr = va_arg(args, void *);
+                spec.zero = 0;
+                if (ptr == NULL)
+                {
+                    p = emit(p, end, &spec, NULL, 0, "(nil)", 5);
+                }
+                else
+                {
+                    p = emit_uint(p, end, &spec, "0x", 2, (uintptr_t)ptr, 16, hex_lower);
+                }
+                continue;
+            }
+            break;
+        case 'n':
+            // 不支持，跳过对应的参数
+            (void)va_arg(args, void *);
+            continue;
+        default:
+            break;
+        }
+        p = fallback(p, end, &spec, flags, flags_len, &args);
+    }
+    va_end(args);
+    *p = '\0';
+    return (size_t)(p - buf);
+}
+
+size_t dbg_format(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = dbg_vformat(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+static size_t append_str(char *p, size_t pos, size_t cap, const char *s)
+{
+    size_t n = strlen(s);
+    if (pos + n > cap) n = pos < cap ? cap - pos : 0;
+    memcpy(p + pos, s, n);
+    return pos + n;
+}
+
+size_t dbg_vformat_line(char *buf, size_t size, const char *color, const char *func,
+                        const char *fmt, va_list ap)
+{
+    // 预留复位颜色以及换行的空间
+    const size_t cap = size - sizeof(ANSI_COLOR_RESET);
+    size_t pos = 0;
+    if (COLOR_ENABLE && color != NULL) pos = append_str(buf, pos, cap, color);
+    if (func != NULL)
+    {
+        pos = append_str(buf, pos, cap, "[");
+        pos = append_str(buf, pos, cap, func);
+        pos = append_str(buf, pos, cap, "]: ");
+    }
+    pos += dbg_vformat(buf + pos, cap - pos + 1, fmt, ap);
+    if (COLOR_ENABLE && color != NULL) pos = append_str(buf, pos, size, ANSI_COLOR_RESET);
+    buf[pos++] = '\n';
+    return pos;
+}
+
+size_t dbg_format_path(char *buf, size_t size, const char *path)
+{
+    size_t n = 0;
+    for (const char *p = path; *p != '\0' && n + 1 < size; p++)
+    {
+        if (p[0] == '%' && p[1] == 'p')
+        {
+            n += dbg_format(buf + n, size - n, "%d", (int)getpid());
+            p++;
+        }
+        else
+        {
+            buf[n++] = *p;
+        }
+    }
+    buf[n] = '\0';
+    return n;
+}
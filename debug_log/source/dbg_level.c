@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "debug_log.h"
+#include "dbg_level.h"
+#include "dbg_site.h"
+
+// 单次配置最多的规则数
+#define LEVEL_MAX_RULES     128
+// 配置文件最大长度
+#define LEVEL_FILE_MAX      (64 * 1024)
+// 检测配置文件修改的间隔(毫秒)
+#define LEVEL_POLL_MS       1000
+
+// 规则类型
+#define RULE_ALL            0
+#define RULE_MODULE         1
+#define RULE_SITE           2
+
+// 解析后的规则，name 指向配置字符串内部
+typedef struct
+{
+    int type;
+    const char *name;
+    size_t name_len;
+    uint32_t line;
+    int level;
+}level_rule_t;
+
+static pthread_mutex_t level_lock = PTHREAD_MUTEX_INITIALIZER;
+// 监视线程
+static const char *watch_path;
+static int watch_pipe[2] = {-1, -1};
+
+static const char *base_name(const char *path)
+{
+    const char *p = strrchr(path, '/');
+    return p != NULL ? p + 1 : path;
+}
+
+static int parse_level(const char *s, size_t len)
+{
+    static const char *const names[] = { "off", "error", "warning", "info", "debug" };
+    if (len == 1 && s[0] >= '0' && s[0] <= '0' + DBG_LOG_DEBUG)
+    {
+        return s[0] - '0';
+    }
+    for (int i = 0; i <= DBG_LOG_DEBUG; i++)
+    {
+        if (strlen(names[i]) == len && strncasecmp(s, names[i], len) == 0)
+        {
+            return i;
+        }
+    }
+    if (len == 4 && strncasecmp(s, "warn", 4) == 0)
+    {
+        return DBG_LOG_WARNING;
+    }
+    if (len == 4 && strncasecmp(s, "none", 4) == 0)
+    {
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief   解析一条规则 [目标=]等级
+*/
+static int parse_rule(const char *s, size_t len, level_rule_t *rule)
+{
+    const char *eq = memchr(s, '=', len);
+    const char *lvl = eq != NULL ? eq + 1 : s;
+    rule->level = parse_level(lvl, (size_t)(s + len - lvl));
+    if (rule->level < 0)
+    {
+        return -1;
+    }
+    rule->type = RULE_ALL;
+    rule->name = s;
+    rule->name_len = eq != NULL ? (size_t)(eq - s) : 0;
+    if (rule->name_len == 0 || (rule->name_len == 1 && s[0] == '*'))
+    {
+        return eq != NULL && rule->name_len == 0 ? -1 : 0;
+    }
+    rule->type = RULE_MODULE;
+    const char *colon = memchr(s, ':', rule->name_len);
+    if (colon != NULL)
+    {
+        char *end;
+        unsigned long line = strtoul(colon + 1, &end, 10);
+        if (end != eq || end == colon + 1)
+        {
+            return -1;
+        }
+        rule->type = RULE_SITE;
+        rule->name_len = (size_t)(colon - s);
+        rule->line = (uint32_t)line;
+    }
+    return 0;
+}
+
+/**
+ * @brief   解析等级配置，忽略 '#' 注释
+ * @return  规则数，格式错误返回-1
+*/
+static int parse_spec(const char *spec, level_rule_t *rules, int count)
+{
+    const char *p = spec;
+    while (p != NULL && *p != '\0')
+    {
+        if (*p == '#')
+        {
+            p = strchr(p, '\n');
+            continue;
+        }
+        if (*p == ',' || isspace((unsigned char)*p))
+        {
+            p++;
+            continue;
+        }
+        const char *start = p;
+        while (*p != '\0' && *p != ',' && *p != '#' && !isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if (count >= LEVEL_MAX_RULES || parse_rule(start, (size_t)(p - start), &rules[count]) != 0)
+        {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+static int rule_match(const level_rule_t *rule, const dbg_site_t *site)
+{
+    const char *name;
+    size_t len;
+    switch (rule->type)
+    {
+    case RULE_ALL:
+        return 1;
+    case RULE_MODULE:
+        if (site->module != NULL)
+        {
+            name = site->module;
+            len = strlen(name);
+        }
+        else
+        {
+            // 源文件名去掉扩展名
+            name = base_name(site->file);
+            const char *dot = strrchr(name, '.');
+            len = dot != NULL ? (size_t)(dot - name) : strlen(name);
+        }
+        break;
+    default:
+        if (site->line != rule->line)
+        {
+            return 0;
+        }
+        name = base_name(site->file);
+        len = strlen(name);
+        break;
+    }
+    return len == rule->name_len && memcmp(name, rule->name, len) == 0;
+}
+
+int dbg_level_apply(const char *spec)
+{
+    level_rule_t rules[LEVEL_MAX_RULES];
+    int count = parse_spec(getenv(DBG_LEVEL_ENV), rules, 0);
+    if (count < 0)
+    {
+        count = 0;
+    }
+    count = parse_spec(spec, rules, count);
+    if (count < 0)
+    {
+        return -1;
+    }
+
+    // 先算出最终等级再写入，修改过程中不会出现中间状态
+    pthread_mutex_lock(&level_lock);
+    size_t sites = dbg_site_count();
+    for (size_t i = 0; i < sites; i++)
+    {
+        dbg_site_t *site = dbg_site_get((uint32_t)i);
+        int level = DBG_LOG_LEVEL;
+        for (int r = 0; r < count; r++)
+        {
+            if (rule_match(&rules[r], site))
+            {
+                level = rules[r].level;
+            }
+        }
+        __atomic_store_n(&site->enabled, site->level <= level, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&level_lock);
+    return 0;
+}
+
+/**
+ * @brief   读取并应用配置文件
+*/
+static void level_reload(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    char *buf = malloc(LEVEL_FILE_MAX + 1);
+    ssize_t n = buf != NULL ? read(fd, buf, LEVEL_FILE_MAX) : -1;
+    close(fd);
+    if (n >= 0)
+    {
+        buf[n] = '\0';
+        if (dbg_level_apply(buf) != 0)
+        {
+            fprintf(stderr, "%s: invalid log level config\n", path);
+        }
+    }
+    free(buf);
+}
+
+static void level_signal(int signo)
+{
+    (void)signo;
+    int saved = errno;
+    char c = 0;
+    ssize_t ret = write(watch_pipe[1], &c, 1);
+    (void)ret;
+    errno = saved;
+}
+
+/**
+ * @brief   监视线程: 收到信号或者文件修改时间变化时重新加载
+*/
+static void *level_watch_main(void *arg)
+{
+    (void)arg;
+    struct stat last;
+    if (stat(watch_path, &last) != 0)
+    {
+        memset(&last, 0, sizeof(last));
+    }
+    for (;;)
+    {
+        struct pollfd pfd = { watch_pipe[0], POLLIN, 0 };
+        int ret = poll(&pfd, 1, LEVEL_POLL_MS);
+        int reload = 0;
+        if (ret > 0)
+        {
+            char buf[64];
+            while (read(watch_pipe[0], buf, sizeof(buf)) > 0)
+            {
+            }
+            reload = 1;
+        }
+        struct stat st;
+        if (stat(watch_path, &st) == 0
+            && (st.st_mtim.tv_sec != last.st_mtim.tv_sec
+                || st.st_mtim.tv_nsec != last.st_mtim.tv_nsec
+                || st.st_size != last.st_size))
+        {
+            last = st;
+            reload = 1;
+        }
+        if (reload)
+        {
+            level_reload(watch_path);
+        }
+    }
+    return NULL;
+}
+
+int dbg_level_watch(const char *path, int signo)
+{
+    pthread_mutex_lock(&level_lock);
+    if (watch_path != NULL)
+    {
+        pthread_mutex_unlock(&level_lock);
+        return -1;
+    }
+    watch_path = strdup(path);
+    pthread_mutex_unlock(&level_lock);
+    if (watch_path == NULL || pipe2(watch_pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        return -1;
+    }
+    level_reload(watch_path);
+
+    if (signo != 0)
+    {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = level_signal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(signo, &sa, NULL);
+    }
+
+    // 监视线程屏蔽所有信号，信号由应用线程处理
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_t thread;
+    int ret = pthread_create(&thread, NULL, level_watch_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (ret != 0)
+    {
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+/**
+ * @brief   进程启动时读取环境变量
+*/
+__attribute__((constructor)) static void dbg_level_init(void)
+{
+    const char *path = getenv(DBG_LEVEL_FILE_ENV);
+    if (path != NULL && *path != '\0')
+    {
+        dbg_level_watch(path, SIGHUP);
+    }
+    else if (getenv(DBG_LEVEL_ENV) != NULL)
+    {
+        dbg_level_apply(NULL);
+    }
+    level_rule_t rules[LEVEL_MAX_RULES];
+    if (parse_spec(getenv(DBG_LEVEL_ENV), rules, 0) < 0)
+    {
+        fprintf(stderr, DBG_LEVEL_ENV ": invalid log level config\n");
+    }
+}
@@ -0,0 +1,184 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "debug_log.h"
+#include "dbg_clock.h"
+#include "dbg_rate.h"
+
+// 每个等级的限流参数(dbg_clock 计数)
+typedef struct
+{
+    uint64_t interval;      // 两行之间的最小间隔，0表示不限制
+    uint64_t tolerance;     // 允许提前的时间 = interval * (burst - 1)
+}rate_limit_t;
+
+static rate_limit_t rate_limits[DBG_LOG_DEBUG + 1];
+static uint64_t rate_repeat_ticks;
+static pthread_once_t rate_once = PTHREAD_ONCE_INIT;
+static pthread_once_t rate_init_once = PTHREAD_ONCE_INIT;
+// 报告计数时持有，进程退出之后报告线程不再输出
+static pthread_mutex_t rate_lock = PTHREAD_MUTEX_INITIALIZER;
+static int rate_stopped;
+
+static void rate_flush_all(void);
+
+static void rate_set(int level, uint32_t rate, uint32_t burst)
+{
+    if (level < 0 || level > DBG_LOG_DEBUG)
+    {
+        return;
+    }
+    uint64_t interval = rate > 0 ? dbg_clock_ticks(1000000000u / rate) : 0;
+    __atomic_store_n(&rate_limits[level].interval, interval, __ATOMIC_RELAXED);
+    __atomic_store_n(&rate_limits[level].tolerance, interval * (burst > 0 ? burst - 1 : 0), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   第一次检查时初始化默认参数
+ * @note    放在第一条日志时而不是进程启动时，进程启动时时钟还没有校准
+*/
+static void rate_init(void)
+{
+    rate_set(DBG_LOG_ERROR, DBG_RATE_ERROR, DBG_RATE_BURST);
+    rate_set(DBG_LOG_WARNING, DBG_RATE_WARNING, DBG_RATE_BURST);
+    rate_set(DBG_LOG_INFO, DBG_RATE_INFO, DBG_RATE_BURST);
+    rate_set(DBG_LOG_DEBUG, DBG_RATE_DEBUG, DBG_RATE_BURST);
+    if (DBG_RATE_REPEAT)
+    {
+        rate_repeat_ticks = dbg_clock_ticks((uint64_t)DBG_RATE_REPEAT_MS * 1000000u);
+    }
+}
+
+void dbg_rate_set(int level, uint32_t rate, uint32_t burst)
+{
+    // 先完成默认参数的初始化，之后不会覆盖这里的设置
+    pthread_once(&rate_init_once, rate_init);
+    rate_set(level, rate, burst);
+}
+
+/**
+ * @brief   后台报告线程: 每隔 DBG_RATE_REPORT_MS 报告一次所有调用点的计数
+ * @note    调用点之后不再输出时，合并以及被限流的行数也能及时报告，不需要等到下一次命中
+*/
+static void *rate_reporter(void *arg)
+{
+    (void)arg;
+    struct timespec ts = { DBG_RATE_REPORT_MS / 1000, (long)(DBG_RATE_REPORT_MS % 1000) * 1000000 };
+    for (;;)
+    {
+        nanosleep(&ts, NULL);
+        pthread_mutex_lock(&rate_lock);
+        if (rate_stopped)
+        {
+            pthread_mutex_unlock(&rate_lock);
+            return NULL;
+        }
+        rate_flush_all();
+        pthread_mutex_unlock(&rate_lock);
+    }
+}
+
+/**
+ * @brief   进程退出时报告剩余的计数，之后报告线程不再输出
+*/
+static void rate_exit(void)
+{
+    pthread_mutex_lock(&rate_lock);
+    rate_flush_all();
+    rate_stopped = 1;
+    pthread_mutex_unlock(&rate_lock);
+}
+
+// 第一次合并或者丢弃时启动报告线程并注册退出处理，保证在异步后端停止之前执行
+static void rate_once_init(void)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_create(&thread, &attr, rate_reporter, NULL);
+    pthread_attr_destroy(&attr);
+    atexit(rate_exit);
+}
+
+/**
+ * @brief   GCRA: rate_tat 为理论上下一行的到达时间
+*/
+static int rate_allow(dbg_site_t *site, uint64_t now)
+{
+    const rate_limit_t *limit = &rate_limits[site->level <= DBG_LOG_DEBUG ? site->level : DBG_LOG_DEBUG];
+    uint64_t interval = __atomic_load_n(&limit->interval, __ATOMIC_RELAXED);
+    if (interval == 0)
+    {
+        return 1;
+    }
+    uint64_t tolerance = __atomic_load_n(&limit->tolerance, __ATOMIC_RELAXED);
+    uint64_t tat = __atomic_load_n(&site->rate_tat, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        uint64_t start = (int64_t)(tat - now) > 0 ? tat : now;
+        if (start - now > tolerance)
+        {
+            return 0;
+        }
+        if (__atomic_compare_exchange_n(&site->rate_tat, &tat, start + interval, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            return 1;
+        }
+    }
+}
+
+int dbg_rate_check(dbg_site_t *site, uint64_t hash, uint64_t now, uint32_t *repeated, uint32_t *dropped)
+{
+    *repeated = 0;
+    *dropped = 0;
+    pthread_once(&rate_init_once, rate_init);
+    if (DBG_RATE_REPEAT && hash != 0)
+    {
+        uint64_t last = __atomic_exchange_n(&site->rate_hash, hash, __ATOMIC_RELAXED);
+        // 只在上一次输出之后的 DBG_RATE_REPEAT_MS 内合并，超过之后重新输出一次
+        if (last == hash && now - __atomic_load_n(&site->rate_last, __ATOMIC_RELAXED) <= rate_repeat_ticks)
+        {
+            __atomic_fetch_add(&site->rate_repeats, 1, __ATOMIC_RELAXED);
+            pthread_once(&rate_once, rate_once_init);
+            return DBG_RATE_DROP;
+        }
+        // 与上一条不同，先报告上一条重复的次数
+        *repeated = __atomic_exchange_n(&site->rate_repeats, 0, __ATOMIC_RELAXED);
+    }
+    if (!rate_allow(site, now))
+    {
+        __atomic_fetch_add(&site->rate_dropped, 1, __ATOMIC_RELAXED);
+        pthread_once(&rate_once, rate_once_init);
+        return DBG_RATE_DROP;
+    }
+    *dropped = __atomic_exchange_n(&site->rate_dropped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&site->rate_last, now, __ATOMIC_RELAXED);
+    return DBG_RATE_PASS;
+}
+
+/**
+ * @brief   报告所有调用点的计数，调用时持有 rate_lock
+*/
+static void rate_flush_all(void)
+{
+    size_t count = dbg_site_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        dbg_site_t *site = dbg_site_get((uint32_t)i);
+        uint32_t repeated = __atomic_exchange_n(&site->rate_repeats, 0, __ATOMIC_RELAXED);
+        uint32_t dropped = __atomic_exchange_n(&site->rate_dropped, 0, __ATOMIC_RELAXED);
+        if (repeated > 0 || dropped > 0)
+        {
+            dbg_site_report(site, COLOR_ENABLE ? ANSI_COLOR_YELLOW : NULL, repeated, dropped);
+        }
+    }
+}
+
+void dbg_rate_flush(void)
+{
+    pthread_mutex_lock(&rate_lock);
+    rate_flush_all();
+    pthread_mutex_unlock(&rate_lock);
+}
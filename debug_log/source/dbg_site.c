@@ -0,0 +1,192 @@
+#include <string.h>
+#include "debug_log.h"
+#include "dbg_async.h"
+#include "dbg_binary.h"
+#include "dbg_clock.h"
+#include "dbg_flight.h"
+#include "dbg_rate.h"
+#include "dbg_site.h"
+#include "dbg_stats.h"
+
+// 链接器自动生成的段起止符号，没有任何调用点时为NULL
+extern dbg_site_t *const __start_dbg_sites[] __attribute__((weak));
+extern dbg_site_t *const __stop_dbg_sites[] __attribute__((weak));
+
+size_t dbg_site_count(void)
+{
+    if (__start_dbg_sites == NULL)
+    {
+        return 0;
+    }
+    return (size_t)(__stop_dbg_sites - __start_dbg_sites);
+}
+
+dbg_site_t *dbg_site_get(uint32_t id)
+{
+    return id < dbg_site_count() ? __start_dbg_sites[id] : NULL;
+}
+
+/**
+ * @brief   进程启动时为所有调用点分配ID
+*/
+__attribute__((constructor)) static void dbg_site_init(void)
+{
+    size_t count = dbg_site_count();
+    for (size_t i = 0; i < count; i++)
+    {
+        __start_dbg_sites[i]->id = (uint32_t)i;
+    }
+}
+
+/**
+ * @brief   按参数类型计算参数的哈希值(FNV-1a)，字符串按内容计算
+*/
+static uint64_t args_hash(const dbg_site_t *site, va_list ap)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+#define HASH_BYTES(p, n)                                        \
+    for (size_t i_ = 0; i_ < (n); i_++)                         \
+    {                                                           \
+        h = (h ^ ((const uint8_t *)(p))[i_]) * 0x100000001b3ull; \
+    }
+    for (const uint8_t *t = site->types; *t != DBG_ARG_END; t++)
+    {
+        switch (*t)
+        {
+        case DBG_ARG_INT:
+        {
+            int v = va_arg(ap, int);
+            HASH_BYTES(&v, sizeof(v));
+            break;
+        }
+        case DBG_ARG_LONG:
+        {
+            long v = va_arg(ap, long);
+            HASH_BYTES(&v, sizeof(v));
+            break;
+        }
+        case DBG_ARG_LLONG:
+        {
+            long long v = va_arg(ap, long long);
+            HASH_BYTES(&v, sizeof(v));
+            break;
+        }
+        case DBG_ARG_DOUBLE:
+        {
+            double v = va_arg(ap, double);
+            HASH_BYTES(&v, sizeof(v));
+            break;
+        }
+        case DBG_ARG_LDOUBLE:
+        {
+            // 只取有效的10字节，忽略填充
+            long double v = va_arg(ap, long double);
+            HASH_BYTES(&v, sizeof(v) < 10 ? sizeof(v) : 10);
+            break;
+        }
+        case DBG_ARG_STR:
+        {
+            const char *s = va_arg(ap, const char *);
+            if (s != NULL)
+            {
+                HASH_BYTES(s, strlen(s) + 1);
+            }
+            break;
+        }
+        default:
+        {
+            void *v = va_arg(ap, void *);
+            HASH_BYTES(&v, sizeof(v));
+            break;
+        }
+        }
+    }
+#undef HASH_BYTES
+    return h != 0 ? h : 1;
+}
+
+static size_t site_emit(const dbg_site_t *site, const char *color, const char *fmt, va_list ap)
+{
+    switch (site->backend)
+    {
+    case DBG_BACKEND_ASYNC:
+        return dbg_async_vlog(color, site->func, fmt, ap);
+    case DBG_BACKEND_BINARY:
+        // 格式字符串不是字面量时解码工具无法还原，输出文本记录
+        if (site->fmt != NULL)
+        {
+            return dbg_bin_vlog(site, fmt, ap);
+        }
+        return dbg_async_vlog(color, site->func, fmt, ap);
+    default:
+        return dbg_sync_vlog(color, site->func, fmt, ap);
+    }
+}
+
+static size_t site_report(const dbg_site_t *site, const char *color, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    // 二进制后端的报告作为文本记录输出
+    size_t n = site->backend == DBG_BACKEND_SYNC ? dbg_sync_vlog(color, site->func, fmt, ap)
+                                                 : dbg_async_vlog(color, site->func, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+size_t dbg_site_report(const dbg_site_t *site, const char *color, uint32_t repeated, uint32_t dropped)
+{
+    size_t n = 0;
+    if (repeated > 0)
+    {
+        n += site_report(site, color, "last message repeated %u times", repeated);
+    }
+    if (dropped > 0)
+    {
+        n += site_report(site, color, "%u messages suppressed by rate limit", dropped);
+    }
+    return n;
+}
+
+void dbg_site_log(dbg_site_t *site, const char *color, int flags, const char *fmt, ...)
+{
+    uint64_t now = dbg_clock_now();
+    va_list ap;
+    va_start(ap, fmt);
+    va_list copy;
+    if (flags & DBG_SITE_LOG_FLIGHT)
+    {
+        // 飞行记录器不限流
+        va_copy(copy, ap);
+        dbg_flight_vlog(site, now, fmt, copy);
+        va_end(copy);
+    }
+    if (DBG_SITE_ENABLED(*site))
+    {
+        uint64_t hash = 0;
+        // ERROR 等级的每一条都输出；二进制后端只拷贝参数，计算哈希比写入记录还要慢，不合并重复行
+        if (DBG_RATE_REPEAT && site->level != DBG_LOG_ERROR && site->backend != DBG_BACKEND_BINARY)
+        {
+            va_copy(copy, ap);
+            hash = args_hash(site, copy);
+            va_end(copy);
+        }
+        uint32_t repeated;
+        uint32_t dropped;
+        int ret = dbg_rate_check(site, hash, now, &repeated, &dropped);
+        size_t bytes = 0;
+        if (repeated > 0 || dropped > 0)
+        {
+            bytes += dbg_site_report(site, color, repeated, dropped);
+        }
+        if (ret == DBG_RATE_PASS)
+        {
+            bytes += site_emit(site, color, fmt, ap);
+        }
+        if (DBG_STATS)
+        {
+            dbg_stats_add(site->id, ret != DBG_RATE_PASS, bytes);
+        }
+    }
+    va_end(ap);
+}
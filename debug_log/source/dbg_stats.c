@@ -0,0 +1,393 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "debug_log.h"
+#include "dbg_format.h"
+#include "dbg_io.h"
+#include "dbg_site.h"
+#include "dbg_stats.h"
+
+// 线程分片，counts 按调用点ID索引
+typedef struct stats_shard
+{
+    struct stats_shard *next;
+    struct stats_shard **prev;
+    dbg_stats_t counts[];
+}stats_shard_t;
+
+__thread dbg_stats_t *dbg_stats_shard;
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+// 存活线程的分片
+static stats_shard_t *shard_list;
+// 已退出线程的计数
+static dbg_stats_t *stats_retired;
+
+// 信号导出
+static int stats_pipe[2] = {-1, -1};
+static const char *stats_path;
+static int stats_format;
+
+static const char *const level_names[] =
+{
+    [DBG_LOG_ERROR]     = "error",
+    [DBG_LOG_WARNING]   = "warning",
+    [DBG_LOG_INFO]      = "info",
+    [DBG_LOG_DEBUG]     = "debug",
+};
+
+/**
+ * @brief   线程退出时把分片合并到全局计数
+*/
+static void shard_release(void *arg)
+{
+    stats_shard_t *shard = arg;
+    size_t count = dbg_site_count();
+    pthread_mutex_lock(&stats_lock);
+    for (size_t i = 0; i < count && stats_retired != NULL; i++)
+    {
+        stats_retired[i].hits += shard->counts[i].hits;
+        stats_retired[i].suppressed += shard->counts[i].suppressed;
+        stats_retired[i].bytes += shard->counts[i].bytes;
+    }
+    *shard->prev = shard->next;
+    if (shard->next != NULL)
+    {
+        shard->next->prev = shard->prev;
+    }
+    pthread_mutex_unlock(&stats_lock);
+    dbg_stats_shard = NULL;
+    free(shard);
+}
+
+static void stats_init(void)
+{
+    pthread_key_create(&stats_key, shard_release);
+    stats_retired = calloc(dbg_site_count() + 1, sizeof(dbg_stats_t));
+}
+
+dbg_stats_t *dbg_stats_shard_new(void)
+{
+    pthread_once(&stats_once, stats_init);
+    // 按缓存行对齐并补齐，不同线程的分片不会共享缓存行
+    size_t size = sizeof(stats_shard_t) + dbg_site_count() * sizeof(dbg_stats_t);
+    size = (size + 63) & ~(size_t)63;
+    stats_shard_t *shard = aligned_alloc(64, size);
+    if (shard == NULL)
+    {
+        return NULL;
+    }
+    memset(shard, 0, size);
+    pthread_mutex_lock(&stats_lock);
+    shard->next = shard_list;
+    shard->prev = &shard_list;
+    if (shard_list != NULL)
+    {
+        shard_list->prev = &shard->next;
+    }
+    shard_list = shard;
+    pthread_mutex_unlock(&stats_lock);
+    pthread_setspecific(stats_key, shard);
+    dbg_stats_shard = shard->counts;
+    return shard->counts;
+}
+
+/**
+ * @brief   合并所有线程的计数，调用者持有 stats_lock
+*/
+static void stats_merge(uint32_t id, dbg_stats_t *out)
+{
+    *out = stats_retired != NULL ? stats_retired[id] : (dbg_stats_t){ 0 };
+    for (stats_shard_t *shard = shard_list; shard != NULL; shard = shard->next)
+    {
+        out->hits += __atomic_load_n(&shard->counts[id].hits, __ATOMIC_RELAXED);
+        out->suppressed += __atomic_load_n(&shard->counts[id].suppressed, __ATOMIC_RELAXED);
+        out->bytes += __atomic_load_n(&shard->counts[id].bytes, __ATOMIC_RELAXED);
+    }
+}
+
+int dbg_stats_get(uint32_t id, dbg_stats_t *out)
+{
+    if (id >= dbg_site_count())
+    {
+        return -1;
+    }
+    pthread_mutex_lock(&stats_lock);
+    stats_merge(id, out);
+    pthread_mutex_unlock(&stats_lock);
+    return 0;
+}
+
+/************************** 导出 *********************************/
+// 带缓冲的输出，满时write
+typedef struct
+{
+    int fd;
+    int error;
+    size_t pos;
+    char buf[4096];
+}stats_out_t;
+
+static void out_flush(stats_out_t *out)
+{
+    if (out->pos > 0 && !out->error && dbg_write_all(out->fd, out->buf, out->pos) != 0)
+    {
+        out->error = 1;
+    }
+    out->pos = 0;
+}
+
+static void out_write(stats_out_t *out, const char *s, size_t len)
+{
+    while (len > 0)
+    {
+        if (out->pos == sizeof(out->buf))
+        {
+            out_flush(out);
+        }
+        size_t n = sizeof(out->buf) - out->pos < len ? sizeof(out->buf) - out->pos : len;
+        memcpy(out->buf + out->pos, s, n);
+        out->pos += n;
+        s += n;
+        len -= n;
+    }
+}
+
+__attribute__((format(printf, 2, 3)))
+static void out_printf(stats_out_t *out, const char *fmt, ...)
+{
+    char tmp[512];
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = dbg_vformat(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    out_write(out, tmp, n);
+}
+
+// 输出JSON字符串，包括两端的引号
+static void out_json_str(stats_out_t *out, const char *s)
+{
+    out_write(out, "\"", 1);
+    for (; s != NULL && *s != '\0'; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            char esc[2] = { '\\', (char)c };
+            out_write(out, esc, 2);
+        }
+        else if (c < 0x20)
+        {
+            out_printf(out, "\\u%04x", c);
+        }
+        else
+        {
+            out_write(out, (const char *)&c, 1);
+        }
+    }
+    out_write(out, "\"", 1);
+}
+
+static const char *level_name(uint8_t level)
+{
+    return level >= DBG_LOG_ERROR && level <= DBG_LOG_DEBUG ? level_names[level] : "?";
+}
+
+// 调用点的模块名，未指定时为源文件名去掉目录以及扩展名
+static size_t module_name(const dbg_site_t *site, const char **name)
+{
+    if (site->module != NULL)
+    {
+        *name = site->module;
+        return strlen(site->module);
+    }
+    const char *base = strrchr(site->file, '/');
+    *name = base != NULL ? base + 1 : site->file;
+    const char *dot = strrchr(*name, '.');
+    return dot != NULL ? (size_t)(dot - *name) : strlen(*name);
+}
+
+// 按触发次数降序排序的索引
+static const dbg_stats_t *sort_counts;
+
+static int hits_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    if (sort_counts[x].hits != sort_counts[y].hits)
+    {
+        return sort_counts[x].hits > sort_counts[y].hits ? -1 : 1;
+    }
+    return x < y ? -1 : x > y;
+}
+
+static void dump_table(stats_out_t *out, const dbg_stats_t *counts, uint32_t *order, size_t count)
+{
+    sort_counts = counts;
+    qsort(order, count, sizeof(*order), hits_cmp);
+    out_printf(out, "%12s %12s %14s %-8s %-12s %s\n", "hits", "suppressed", "bytes", "level", "module", "site");
+    for (size_t i = 0; i < count && counts[order[i]].hits > 0; i++)
+    {
+        const dbg_site_t *site = dbg_site_get(order[i]);
+        const dbg_stats_t *s = &counts[order[i]];
+        const char *module;
+        size_t len = module_name(site, &module);
+        const char *file = strrchr(site->file, '/');
+        out_printf(out, "%12llu %12llu %14llu %-8s %-12.*s %s:%u %s() \"",
+                   (unsigned long long)s->hits, (unsigned long long)s->suppressed,
+                   (unsigned long long)s->bytes, level_name(site->level), (int)len, module,
+                   file != NULL ? file + 1 : site->file, site->line, site->func);
+        // 格式字符串只输出第一行
+        const char *fmt = site->fmt != NULL ? site->fmt : "";
+        out_write(out, fmt, strcspn(fmt, "\r\n"));
+        out_write(out, "\"\n", 2);
+    }
+}
+
+static void dump_json(stats_out_t *out, const dbg_stats_t *counts, size_t count)
+{
+    out_write(out, "{\"sites\":[", 10);
+    for (size_t i = 0; i < count; i++)
+    {
+        const dbg_site_t *site = dbg_site_get((uint32_t)i);
+        const dbg_stats_t *s = &counts[i];
+        const char *module;
+        size_t len = module_name(site, &module);
+        out_printf(out, "%s\n{\"id\":%u,\"level\":\"%s\",\"module\":\"%.*s\",\"file\":",
+                   i > 0 ? "," : "", site->id, level_name(site->level), (int)len, module);
+        out_json_str(out, site->file);
+        out_printf(out, ",\"line\":%u,\"func\":", site->line);
+        out_json_str(out, site->func);
+        out_write(out, ",\"fmt\":", 7);
+        out_json_str(out, site->fmt);
+        out_printf(out, ",\"hits\":%llu,\"suppressed\":%llu,\"bytes\":%llu}",
+                   (unsigned long long)s->hits, (unsigned long long)s->suppressed,
+                   (unsigned long long)s->bytes);
+    }
+    out_write(out, "\n]}\n", 4);
+}
+
+int dbg_stats_dump(int fd, int format)
+{
+    size_t count = dbg_site_count();
+    dbg_stats_t *counts = malloc((count + 1) * sizeof(*counts));
+    uint32_t *order = malloc((count + 1) * sizeof(*order));
+    stats_out_t *out = malloc(sizeof(*out));
+    if (counts == NULL || order == NULL || out == NULL)
+    {
+        free(counts);
+        free(order);
+        free(out);
+        return -1;
+    }
+    // 先在锁内取出快照，输出时不持有锁
+    pthread_mutex_lock(&stats_lock);
+    for (size_t i = 0; i < count; i++)
+    {
+        stats_merge((uint32_t)i, &counts[i]);
+        order[i] = (uint32_t)i;
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    out->fd = fd;
+    out->error = 0;
+    out->pos = 0;
+    if (format == DBG_STATS_JSON)
+    {
+        dump_json(out, counts, count);
+    }
+    else
+    {
+        dump_table(out, counts, order, count);
+    }
+    out_flush(out);
+    int ret = out->error ? -1 : 0;
+    free(counts);
+    free(order);
+    free(out);
+    return ret;
+}
+
+/************************** 信号导出 *********************************/
+static void stats_signal(int signo)
+{
+    (void)signo;
+    int saved = errno;
+    char c = 0;
+    ssize_t ret = write(stats_pipe[1], &c, 1);
+    (void)ret;
+    errno = saved;
+}
+
+/**
+ * @brief   导出线程: 每收到一次信号导出一次
+*/
+static void *stats_watch_main(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        struct pollfd pfd = { stats_pipe[0], POLLIN, 0 };
+        if (poll(&pfd, 1, -1) <= 0)
+        {
+            continue;
+        }
+        char buf[64];
+        while (read(stats_pipe[0], buf, sizeof(buf)) > 0)
+        {
+        }
+        if (stats_path == NULL)
+        {
+            dbg_stats_dump(STDERR_FILENO, stats_format);
+            continue;
+        }
+        int fd = open(stats_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0)
+        {
+            dbg_stats_dump(fd, stats_format);
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+int dbg_stats_signal(int signo, const char *path, int format)
+{
+    pthread_mutex_lock(&stats_lock);
+    if (stats_pipe[0] >= 0 || pipe2(stats_pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        pthread_mutex_unlock(&stats_lock);
+        return -1;
+    }
+    stats_path = path != NULL ? strdup(path) : NULL;
+    stats_format = format;
+    pthread_mutex_unlock(&stats_lock);
+
+    // 导出线程屏蔽所有信号，信号由应用线程处理
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_t thread;
+    int ret = pthread_create(&thread, NULL, stats_watch_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (ret != 0)
+    {
+        return -1;
+    }
+    pthread_detach(thread);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stats_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    return sigaction(signo, &sa, NULL);
+}
@@ -0,0 +1,163 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "dbg_format.h"
+#include "dbg_trace.h"
+
+_Static_assert((DBG_TRACE_EVENTS & (DBG_TRACE_EVENTS - 1)) == 0, "DBG_TRACE_EVENTS must be a power of 2");
+
+__thread dbg_trace_buf_t *dbg_trace_tls;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t trace_once = PTHREAD_ONCE_INIT;
+// 所有线程的缓冲区，线程退出后保留，导出时仍然可以读取，直到被新线程复用
+static dbg_trace_buf_t *trace_list;
+// 线程退出时标记缓冲区可以复用
+static pthread_key_t trace_key;
+
+static void trace_exit(void)
+{
+    const char *path = getenv("DBG_TRACE_FILE");
+    if (path == NULL || *path == '\0')
+    {
+        path = DBG_TRACE_PATH;
+    }
+    if (path != NULL)
+    {
+        dbg_trace_write(path);
+    }
+}
+
+static void trace_release(void *arg)
+{
+    dbg_trace_buf_t *buf = arg;
+    pthread_mutex_lock(&trace_lock);
+    buf->exited = 1;
+    pthread_mutex_unlock(&trace_lock);
+    dbg_trace_tls = NULL;
+}
+
+// 第一个事件时注册退出处理
+static void trace_init(void)
+{
+    pthread_key_create(&trace_key, trace_release);
+    atexit(trace_exit);
+}
+
+dbg_trace_buf_t *dbg_trace_buf_new(void)
+{
+    pthread_once(&trace_once, trace_init);
+    // 优先复用已经退出的线程的缓冲区，线程反复创建时内存不会增长
+    pthread_mutex_lock(&trace_lock);
+    dbg_trace_buf_t *buf = trace_list;
+    while (buf != NULL && !buf->exited)
+    {
+        buf = buf->next;
+    }
+    if (buf == NULL)
+    {
+        buf = malloc(sizeof(*buf));
+        if (buf == NULL)
+        {
+            pthread_mutex_unlock(&trace_lock);
+            return NULL;
+        }
+        buf->next = trace_list;
+        trace_list = buf;
+    }
+    buf->exited = 0;
+    buf->tid = (uint32_t)syscall(SYS_gettid);
+    buf->pos = 0;
+    if (pthread_getname_np(pthread_self(), buf->thread_name, sizeof(buf->thread_name)) != 0)
+    {
+        buf->thread_name[0] = '\0';
+    }
+    pthread_mutex_unlock(&trace_lock);
+    pthread_setspecific(trace_key, buf);
+    dbg_trace_tls = buf;
+    return buf;
+}
+
+// 输出JSON字符串，包括两端的引号
+static void json_str(FILE *fp, const char *s)
+{
+    fputc('"', fp);
+    for (; *s != '\0'; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', fp);
+            fputc(c, fp);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(fp, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+long dbg_trace_write(const char *path)
+{
+    char file[256];
+    dbg_format_path(file, sizeof(file), path);
+    FILE *fp = fopen(file, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    unsigned pid = (unsigned)getpid();
+    long count = 0;
+    dbg_clock_calibrate();
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", fp);
+    pthread_mutex_lock(&trace_lock);
+    for (dbg_trace_buf_t *buf = trace_list; buf != NULL; buf = buf->next)
+    {
+        if (buf->thread_name[0] != '\0')
+        {
+            fprintf(fp, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                    count > 0 ? "," : "", pid, buf->tid);
+            json_str(fp, buf->thread_name);
+            fputs("}}", fp);
+            count++;
+        }
+        // 只导出缓冲区中仍然保留的事件，时间单位为微秒
+        uint64_t pos = __atomic_load_n(&buf->pos, __ATOMIC_ACQUIRE);
+        uint64_t start = pos > DBG_TRACE_EVENTS ? pos - DBG_TRACE_EVENTS : 0;
+        for (uint64_t i = start; i < pos; i++)
+        {
+            // 线程仍在写入，先拷贝事件，再确认拷贝期间这个槽位没有被新事件覆盖
+            const dbg_trace_event_t *slot = &buf->events[i & (DBG_TRACE_EVENTS - 1)];
+            dbg_trace_event_t e;
+            e.ts = __atomic_load_n(&slot->ts, __ATOMIC_RELAXED);
+            e.name = __atomic_load_n(&slot->name, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&buf->pos, __ATOMIC_RELAXED) >= i + DBG_TRACE_EVENTS)
+            {
+                continue;
+            }
+            uint64_t ns = dbg_clock_to_ns(&dbg_clock_calib, e.ts & ~DBG_TRACE_END_FLAG);
+            fprintf(fp, "%s\n{\"ph\":\"%c\",\"pid\":%u,\"tid\":%u,\"ts\":%llu.%03u,\"name\":",
+                    count > 0 ? "," : "", (e.ts & DBG_TRACE_END_FLAG) ? 'E' : 'B', pid, buf->tid,
+                    (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+            json_str(fp, e.name);
+            fputc('}', fp);
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&trace_lock);
+    fputs("\n]}\n", fp);
+    if (fclose(fp) != 0)
+    {
+        return -1;
+    }
+    return count;
+}
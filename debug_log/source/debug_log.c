@@ -1,5 +1,12 @@
-﻿#include <stdio.h>
+﻿#include <stdarg.h>
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <unistd.h>
 #include "debug_log.h"
+#include "dbg_clock.h"
+#include "dbg_format.h"
+#include "dbg_io.h"
+#include "hexdump.h"
 
 const char *log_level_string[] = 
 {
@@ -9,40 +16,42 @@ const char *log_level_string[] =
     [DBG_LOG_DEBUG]     = "Debug",
 };
 
-void print_hex_table(uint8_t *data, uint16_t len)
+void dbg_sync_log(const char *color, const char *func, const char *fmt, ...)
 {
-#if DBG_ENABLE
-    // 打印标题行
-    PRINT_ANSI_COLOR(ANSI_COLOR_CYAN);
-    printf("     ");
-    for (size_t i = 0; i < 0x10; i++)
+    va_list ap;
+    va_start(ap, fmt);
+    dbg_sync_vlog(color, func, fmt, ap);
+    va_end(ap);
+}
+
+size_t dbg_sync_vlog(const char *color, const char *func, const char *fmt, va_list ap)
+{
+    static __thread char line[DBG_LOG_LINE_MAX];
+    size_t pos = 0;
+    if (DBG_TIMESTAMP && func != NULL)
+    {
+        pos = dbg_clock_format(dbg_clock_now(), line, sizeof(line));
+    }
+    pos += dbg_vformat_line(line + pos, sizeof(line) - pos, color, func, fmt, ap);
+
+    // 保证与之前printf输出的内容顺序一致，stdio缓冲区为空时不加锁
+    if (__fpending(stdout) > 0)
     {
-        printf("%02X ", (unsigned int)i);
+        fflush(stdout);
     }
-    PRINT_ANSI_COLOR(ANSI_COLOR_RESET);
-    printf("\n");
-	// 计算行数
-	size_t rows = (len + 15) / 16; 
-	for (size_t i = 0; i < rows; i++)
-	{
-		// 输出标题列
-        PRINT_ANSI_COLOR(ANSI_COLOR_CYAN);
-        printf("%04X ", (unsigned int)i * 16);
-        // 输出数据列
-        PRINT_ANSI_COLOR(ANSI_COLOR_MAGENTA);
-		size_t j;
-		for (j = 0; j < 16 && i * 16 + j < len; j++)
-		{
-			printf("%02X ", data[i * 16 + j]);
-		}
-		// 补齐空白列
-		for (; j < 16; j++)
-		{
-			printf("   ");
-		}
-		printf("\n");
-        PRINT_ANSI_COLOR(ANSI_COLOR_RESET);
-	}
+    return dbg_write_all(STDOUT_FILENO, line, pos) == 0 ? pos : 0;
+}
+
+void print_hex_table(const uint8_t *data, size_t len)
+{
+#if DBG_ENABLE
+    // 先输出printf缓冲区以及异步后端中的内容，保证输出顺序
+    fflush(stdout);
+#if DBG_BACKEND >= DBG_BACKEND_ASYNC
+    dbg_async_flush();
+#endif
+    hexdump_buffer(STDOUT_FILENO, data, len, HEXDUMP_UPPER | HEXDUMP_ASCII | HEXDUMP_HEADER
+                                             | (COLOR_ENABLE ? HEXDUMP_COLOR : 0));
 #endif
 }
 
@@ -0,0 +1,213 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hexdump.h"
+#include "debug_log.h"
+#include "dbg_io.h"
+
+// 单行最大长度: 偏移量 + 16 x "XX " + ASCII列 + 颜色转义序列
+#define HEXDUMP_LINE_MAX    160
+
+// 半字节查表
+static const char hex_lower[16] = "0123456789abcdef";
+static const char hex_upper[16] = "0123456789ABCDEF";
+
+static int hexdump_flush(hexdump_t *hd)
+{
+    int ret = dbg_write_all(hd->fd, hd->out, hd->used);
+    hd->used = 0;
+    return ret;
+}
+
+static char *put_str(char *p, const char *s)
+{
+    size_t n = strlen(s);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+/**
+ * @brief   格式化一行数据到输出缓冲区
+ * @param   [in] data   本行数据
+ * @param   [in] len    本行数据长度(1~16)
+*/
+static void hexdump_row(hexdump_t *hd, const uint8_t *data, size_t len)
+{
+    const char *digits = (hd->flags & HEXDUMP_UPPER) ? hex_upper : hex_lower;
+    char *p = hd->out + hd->used;
+    int color = hd->flags & HEXDUMP_COLOR;
+
+    // 偏移量: 至少8位，超过4GB时自动加宽; 与xxd一致总是小写
+    if (color) p = put_str(p, ANSI_COLOR_CYAN);
+    int width = hd->offset > 0xFFFFFFFFu ? 16 : 8;
+    for (int shift = (width - 1) * 4; shift >= 0; shift -= 4)
+    {
+        *p++ = hex_lower[(hd->offset >> shift) & 0x0F];
+    }
+    *p++ = ':';
+    *p++ = ' ';
+
+    // 数据列
+    if (color) p = put_str(p, ANSI_COLOR_MAGENTA);
+    size_t i = 0;
+    for (; i < len; i++)
+    {
+        p[0] = digits[data[i] >> 4];
+        p[1] = digits[data[i] & 0x0F];
+        p[2] = ' ';
+        p += 3;
+    }
+    if (hd->flags & HEXDUMP_ASCII)
+    {
+        // 补齐空白列，保证ASCII列对齐
+        memset(p, ' ', (HEXDUMP_ROW_BYTES - i) * 3);
+        p += (HEXDUMP_ROW_BYTES - i) * 3;
+        if (color) p = put_str(p, ANSI_COLOR_RESET);
+        *p++ = ' ';
+        for (i = 0; i < len; i++)
+        {
+            uint8_t c = data[i];
+            *p++ = (uint8_t)(c - 0x20) < 0x5F ? (char)c : '.';
+        }
+    }
+    else
+    {
+        // 去掉行尾空格
+        p--;
+        if (color) p = put_str(p, ANSI_COLOR_RESET);
+    }
+    *p++ = '\n';
+
+    hd->used = (size_t)(p - hd->out);
+    hd->offset += len;
+}
+
+/**
+ * @brief   保证缓冲区至少还能容纳一行
+*/
+static int hexdump_reserve(hexdump_t *hd)
+{
+    if (hd->used + HEXDUMP_LINE_MAX > sizeof(hd->out))
+    {
+        return hexdump_flush(hd);
+    }
+    return 0;
+}
+
+void hexdump_init(hexdump_t *hd, int fd, unsigned int flags)
+{
+    hd->fd = fd;
+    hd->flags = flags;
+    hd->offset = 0;
+    hd->row_len = 0;
+    hd->used = 0;
+
+    if (flags & HEXDUMP_HEADER)
+    {
+        // 表头与数据列对齐
+        const char *digits = (flags & HEXDUMP_UPPER) ? hex_upper : hex_lower;
+        char *p = hd->out;
+        if (flags & HEXDUMP_COLOR) p = put_str(p, ANSI_COLOR_CYAN);
+        memset(p, ' ', 10);
+        p += 10;
+        for (int i = 0; i < HEXDUMP_ROW_BYTES; i++)
+        {
+            *p++ = '0';
+            *p++ = digits[i];
+            *p++ = ' ';
+        }
+        p--;
+        if (flags & HEXDUMP_COLOR) p = put_str(p, ANSI_COLOR_RESET);
+        *p++ = '\n';
+        hd->used = (size_t)(p - hd->out);
+    }
+}
+
+int hexdump_update(hexdump_t *hd, const void *data, size_t len)
+{
+    const uint8_t *s = data;
+    // 先补齐上次剩余的不完整行
+    if (hd->row_len > 0)
+    {
+        size_t n = HEXDUMP_ROW_BYTES - hd->row_len;
+        if (n > len) n = len;
+        memcpy(hd->row + hd->row_len, s, n);
+        hd->row_len += n;
+        s += n;
+        len -= n;
+        if (hd->row_len < HEXDUMP_ROW_BYTES)
+        {
+            return 0;
+        }
+        if (hexdump_reserve(hd) != 0) return -1;
+        hexdump_row(hd, hd->row, HEXDUMP_ROW_BYTES);
+        hd->row_len = 0;
+    }
+    // 完整的行直接从输入格式化，不需要拷贝
+    for (; len >= HEXDUMP_ROW_BYTES; s += HEXDUMP_ROW_BYTES, len -= HEXDUMP_ROW_BYTES)
+    {
+        if (hexdump_reserve(hd) != 0) return -1;
+        hexdump_row(hd, s, HEXDUMP_ROW_BYTES);
+    }
+    memcpy(hd->row, s, len);
+    hd->row_len = len;
+    return 0;
+}
+
+int hexdump_finish(hexdump_t *hd)
+{
+    if (hd->row_len > 0)
+    {
+        if (hexdump_reserve(hd) != 0) return -1;
+        hexdump_row(hd, hd->row, hd->row_len);
+        hd->row_len = 0;
+    }
+    return hexdump_flush(hd);
+}
+
+int hexdump_buffer(int fd, const void *data, size_t len, unsigned int flags)
+{
+    // 上下文带有64KB的输出缓冲区，放在堆上，日志可能运行在栈很小的线程中
+    hexdump_t *hd = malloc(sizeof(hexdump_t));
+    if (hd == NULL) return -1;
+    hexdump_init(hd, fd, flags);
+    int ret = hexdump_update(hd, data, len) == 0 ? hexdump_finish(hd) : -1;
+    int saved = errno;
+    free(hd);
+    errno = saved;
+    return ret;
+}
+
+int hexdump_stream(int in_fd, int out_fd, unsigned int flags)
+{
+    // 上下文以及读缓冲区一起放在堆上
+    struct
+    {
+        hexdump_t hd;
+        uint8_t buf[HEXDUMP_BUF_SIZE];
+    }*ctx = malloc(sizeof(*ctx));
+    if (ctx == NULL) return -1;
+    hexdump_init(&ctx->hd, out_fd, flags);
+    int ret = 0;
+    while (ret == 0)
+    {
+        ssize_t n = read(in_fd, ctx->buf, sizeof(ctx->buf));
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            ret = -1;
+            break;
+        }
+        if (n == 0)
+        {
+            ret = hexdump_finish(&ctx->hd);
+            break;
+        }
+        ret = hexdump_update(&ctx->hd, ctx->buf, (size_t)n);
+    }
+    int saved = errno;
+    free(ctx);
+    errno = saved;
+    return ret;
+}
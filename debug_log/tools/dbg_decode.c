@@ -0,0 +1,400 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "debug_log.h"
+#include "dbg_async.h"
+#include "dbg_binary.h"
+
+/**
+ * @brief   二进制日志解码工具
+ * @note    用法: dbg_decode [-n] [-t] <file>
+ *          -n  不输出颜色
+ *          -t  在每条日志前输出时间
+*/
+
+// 解码后的调用点
+typedef struct
+{
+    int valid;
+    uint8_t level;
+    uint8_t nargs;
+    uint32_t line;
+    char *fmt;
+    char *func;
+    char *file;
+    uint8_t types[DBG_MAX_ARGS];
+}site_t;
+
+static site_t *sites;
+static size_t site_cap;
+
+static const char *level_color(uint8_t level)
+{
+    switch (level)
+    {
+    case DBG_LOG_ERROR:     return ANSI_COLOR_RED;
+    case DBG_LOG_WARNING:   return ANSI_COLOR_YELLOW;
+    case DBG_LOG_INFO:      return ANSI_COLOR_GREEN;
+    default:                return ANSI_COLOR_BLUE;
+    }
+}
+
+static char *dup_str(const void *p, size_t len)
+{
+    char *s = malloc(len + 1);
+    if (s != NULL)
+    {
+        memcpy(s, p, len);
+        s[len] = '\0';
+    }
+    return s;
+}
+
+static char *read_str(FILE *fp, size_t len)
+{
+    char *s = malloc(len + 1);
+    if (s == NULL || fread(s, 1, len, fp) != len)
+    {
+        free(s);
+        return NULL;
+    }
+    s[len] = '\0';
+    return s;
+}
+
+static int read_site(FILE *fp)
+{
+    dbg_bin_site_t s;
+    if (fread((uint8_t *)&s + 1, sizeof(s) - 1, 1, fp) != 1 || s.nargs > DBG_MAX_ARGS)
+    {
+        return -1;
+    }
+    if (s.id >= site_cap)
+    {
+        size_t cap = site_cap ? site_cap : 64;
+        while (cap <= s.id) cap *= 2;
+        site_t *p = realloc(sites, cap * sizeof(*p));
+        if (p == NULL) return -1;
+        memset(p + site_cap, 0, (cap - site_cap) * sizeof(*p));
+        sites = p;
+        site_cap = cap;
+    }
+    site_t *site = &sites[s.id];
+    site->level = s.level;
+    site->nargs = s.nargs;
+    site->line = s.line;
+    site->fmt = read_str(fp, s.fmt_len);
+    site->func = read_str(fp, s.func_len);
+    site->file = read_str(fp, s.file_len);
+    if (site->fmt == NULL || site->func == NULL || site->file == NULL
+        || fread(site->types, 1, s.nargs, fp) != s.nargs)
+    {
+        return -1;
+    }
+    site->valid = 1;
+    return 0;
+}
+
+// 依次读取参数
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    const uint8_t *type;
+    const uint8_t *type_end;
+}args_t;
+
+static int next_arg(args_t *a, uint8_t *type, const uint8_t **val, size_t *len)
+{
+    if (a->type >= a->type_end)
+    {
+        return -1;
+    }
+    *type = *a->type++;
+    switch (*type)
+    {
+    case DBG_ARG_INT:       *len = 4; break;
+    case DBG_ARG_LDOUBLE:   *len = 16; break;
+    case DBG_ARG_STR:
+    {
+        uint16_t n;
+        if (a->end - a->p < (ptrdiff_t)sizeof(n)) return -1;
+        memcpy(&n, a->p, sizeof(n));
+        a->p += sizeof(n);
+        *len = n;
+        break;
+    }
+    default:                *len = 8; break;
+    }
+    if ((size_t)(a->end - a->p) < *len)
+    {
+        return -1;
+    }
+    *val = a->p;
+    a->p += *len;
+    return 0;
+}
+
+/**
+ * @brief   检查转换说明与保存的参数类型是否一致
+ * @note    格式字符串与参数类型不一致时(例如 %s 对应整数)直接调用 snprintf 是未定义行为，
+ *          可能读取任意地址，这种情况输出 <type mismatch>
+ * @param   [in] spec   转换说明(包括长度修饰符以及转换字符)
+ * @param   [in] type   参数类型 DBG_ARG_xxx
+ * @return  一致返回1，否则返回0
+*/
+static int spec_match(const char *spec, uint8_t type)
+{
+    size_t n = strlen(spec);
+    char conv = spec[n - 1];
+    int l = 0;          // 'l' 的个数
+    int L = 0;          // 'L' 或者 'q'
+    int word = 0;       // z/j/t: 64位系统上与 long 相同
+    for (size_t i = 1; i + 1 < n; i++)
+    {
+        switch (spec[i])
+        {
+        case 'l': l++; break;
+        case 'L': case 'q': L = 1; break;
+        case 'z': case 'j': case 't': word = 1; break;
+        default: break;
+        }
+    }
+
+    switch (conv)
+    {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        if (L) return type == DBG_ARG_LLONG;
+        if (l >= 2) return type == DBG_ARG_LLONG || (type == DBG_ARG_LONG && sizeof(long) == sizeof(long long));
+        if (l == 1 || word) return type == DBG_ARG_LONG || (type == DBG_ARG_LLONG && sizeof(long) == sizeof(long long));
+        return type == DBG_ARG_INT;
+    case 'c':
+        return type == DBG_ARG_INT && l == 0;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        return L ? type == DBG_ARG_LDOUBLE : type == DBG_ARG_DOUBLE;
+    case 's':
+        return type == DBG_ARG_STR && l == 0;
+    case 'p':
+        return type == DBG_ARG_PTR;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief   按照格式字符串以及保存的参数还原日志内容
+*/
+static void render(FILE *out, const site_t *site, const uint8_t *payload, size_t len)
+{
+    args_t a = { payload, payload + len, site->types, site->types + site->nargs };
+    char buf[DBG_ASYNC_MAX_RECORD + 64];
+    char spec[64];
+
+    for (const char *f = site->fmt; *f != '\0'; f++)
+    {
+        if (*f != '%')
+        {
+            fputc(*f, out);
+            continue;
+        }
+        if (f[1] == '%')
+        {
+            fputc('%', out);
+            f++;
+            continue;
+        }
+        // 复制转换说明，'*' 替换为对应的int参数
+        size_t n = 0;
+        int mismatch = 0;
+        spec[n++] = *f++;
+        while (*f != '\0' && strchr("diouxXeEfFgGaAcspn", *f) == NULL && n < sizeof(spec) - 16)
+        {
+            if (*f == '*')
+            {
+                uint8_t type;
+                const uint8_t *val;
+                size_t vlen;
+                int v = 0;
+                if (next_arg(&a, &type, &val, &vlen) == 0 && type == DBG_ARG_INT)
+                {
+                    memcpy(&v, val, sizeof(v));
+                }
+                else
+                {
+                    mismatch = 1;
+                }
+                n += (size_t)snprintf(spec + n, sizeof(spec) - n, "%d", v);
+            }
+            else
+            {
+                spec[n++] = *f;
+            }
+            f++;
+        }
+        if (*f == '\0')
+        {
+            break;
+        }
+        spec[n++] = *f;
+        spec[n] = '\0';
+        if (*f == 'n')
+        {
+            continue;
+        }
+
+        uint8_t type;
+        const uint8_t *val;
+        size_t vlen;
+        if (next_arg(&a, &type, &val, &vlen) != 0)
+        {
+            fputs("<?>", out);
+            continue;
+        }
+        if (mismatch || !spec_match(spec, type))
+        {
+            fputs("<type mismatch>", out);
+            continue;
+        }
+        switch (type)
+        {
+        case DBG_ARG_INT:
+        {
+            int v;
+            memcpy(&v, val, sizeof(v));
+            snprintf(buf, sizeof(buf), spec, v);
+            break;
+        }
+        case DBG_ARG_LONG:
+        {
+            long long v;
+            memcpy(&v, val, sizeof(v));
+            snprintf(buf, sizeof(buf), spec, (long)v);
+            break;
+        }
+        case DBG_ARG_LLONG:
+        {
+            long long v;
+            memcpy(&v, val, sizeof(v));
+            snprintf(buf, sizeof(buf), spec, v);
+            break;
+        }
+        case DBG_ARG_DOUBLE:
+        {
+            double v;
+            memcpy(&v, val, sizeof(v));
+            snprintf(buf, sizeof(buf), spec, v);
+            break;
+        }
+        case DBG_ARG_LDOUBLE:
+        {
+            long double v = 0;
+            memcpy(&v, val, sizeof(v) < 16 ? sizeof(v) : 16);
+            snprintf(buf, sizeof(buf), spec, v);
+            break;
+        }
+        case DBG_ARG_STR:
+        {
+            char *s = dup_str(val, vlen);
+            snprintf(buf, sizeof(buf), spec, s != NULL ? s : "");
+            free(s);
+            break;
+        }
+        default:
+        {
+            uint64_t v;
+            memcpy(&v, val, sizeof(v));
+            snprintf(buf, sizeof(buf), spec, (void *)(uintptr_t)v);
+            break;
+        }
+        }
+        fputs(buf, out);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int color = 1;
+    int show_time = 0;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            color = 0;
+        }
+        else if (strcmp(argv[i], "-t") == 0)
+        {
+            show_time = 1;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-n] [-t] <file>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    dbg_bin_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+        || memcmp(hdr.magic, DBG_BIN_MAGIC, sizeof(hdr.magic)) != 0
+        || hdr.version != DBG_BIN_VERSION)
+    {
+        fprintf(stderr, "%s: not a binary log file\n", path);
+        fclose(fp);
+        return 1;
+    }
+
+    static uint8_t payload[DBG_ASYNC_MAX_RECORD];
+    int type;
+    while ((type = fgetc(fp)) != EOF)
+    {
+        if (type == DBG_BIN_SITE)
+        {
+            if (read_site(fp) != 0) break;
+            continue;
+        }
+        dbg_bin_log_t rec;
+        if (type != DBG_BIN_LOG
+            || fread((uint8_t *)&rec + 1, sizeof(rec) - 1, 1, fp) != 1
+            || rec.len > sizeof(payload)
+            || fread(payload, 1, rec.len, fp) != rec.len)
+        {
+            // 文件被截断(例如进程异常退出)
+            break;
+        }
+        if (rec.id >= site_cap || !sites[rec.id].valid)
+        {
+            fprintf(stderr, "unknown site id %u\n", rec.id);
+            continue;
+        }
+        const site_t *site = &sites[rec.id];
+        if (show_time)
+        {
+            int64_t ns = (int64_t)dbg_clock_to_ns(&hdr.clock, rec.ts) + hdr.clock.realtime_offset;
+            time_t sec = (time_t)(ns / 1000000000);
+            struct tm tm;
+            char tbuf[32];
+            localtime_r(&sec, &tm);
+            strftime(tbuf, sizeof(tbuf), "%H:%M:%S", &tm);
+            printf("%s.%06ld ", tbuf, (long)(ns % 1000000000) / 1000);
+        }
+        if (color) fputs(level_color(site->level), stdout);
+        printf("[%s]: ", site->func);
+        render(stdout, site, payload, rec.len);
+        if (color) fputs(ANSI_COLOR_RESET, stdout);
+        fputc('\n', stdout);
+    }
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,182 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "debug_log.h"
+#include "dbg_flight.h"
+
+/**
+ * @brief   飞行记录器导出工具
+ * @note    用法: dbg_flight [-n] <file>
+ *          -n  不输出颜色
+ * @note    从每个分段的 head 向前遍历，收集完整的记录后按时间戳排序输出，
+ *          可以在进程崩溃后或者运行中导出
+*/
+
+// 记录的最大总长度
+#define RECORD_MAX  (sizeof(dbg_flight_record_t) + DBG_FLIGHT_MAX_RECORD + sizeof(uint32_t))
+
+// 导出的记录
+typedef struct
+{
+    dbg_flight_record_t hdr;
+    uint32_t seg;
+    char *text;
+}entry_t;
+
+static entry_t *entries;
+static size_t entry_count;
+static size_t entry_cap;
+
+static const char *level_color(uint32_t level)
+{
+    switch (level)
+    {
+    case DBG_LOG_ERROR:     return ANSI_COLOR_RED;
+    case DBG_LOG_WARNING:   return ANSI_COLOR_YELLOW;
+    case DBG_LOG_INFO:      return ANSI_COLOR_GREEN;
+    default:                return ANSI_COLOR_BLUE;
+    }
+}
+
+// 从环形数据区读取，处理回绕
+static void ring_read(const uint8_t *data, uint32_t size, uint64_t pos, void *out, size_t len)
+{
+    size_t off = pos & (size - 1);
+    size_t first = size - off < len ? size - off : len;
+    memcpy(out, data + off, first);
+    memcpy((uint8_t *)out + first, data, len - first);
+}
+
+/**
+ * @brief   从 head 向前遍历一个分段
+ * @note    写入中的记录可能覆盖了最早的 RECORD_MAX 字节，这部分不导出
+*/
+static int scan_segment(const uint8_t *data, uint32_t size, uint64_t head, uint32_t seg)
+{
+    uint64_t window = size > RECORD_MAX ? size - RECORD_MAX : 0;
+    uint64_t start = head > window ? head - window : 0;
+    uint64_t pos = head;
+    while (pos - start >= sizeof(dbg_flight_record_t) + sizeof(uint32_t))
+    {
+        uint32_t len;
+        ring_read(data, size, pos - sizeof(len), &len, sizeof(len));
+        if (len < sizeof(dbg_flight_record_t) + sizeof(uint32_t) || len > RECORD_MAX || len > pos - start)
+        {
+            break;
+        }
+        dbg_flight_record_t hdr;
+        ring_read(data, size, pos - len, &hdr, sizeof(hdr));
+        if (hdr.len != len)
+        {
+            break;
+        }
+        if (entry_count == entry_cap)
+        {
+            entry_cap = entry_cap ? entry_cap * 2 : 1024;
+            entry_t *p = realloc(entries, entry_cap * sizeof(*p));
+            if (p == NULL) return -1;
+            entries = p;
+        }
+        size_t text_len = len - sizeof(hdr) - sizeof(uint32_t);
+        char *text = malloc(text_len + 1);
+        if (text == NULL) return -1;
+        ring_read(data, size, pos - len + sizeof(hdr), text, text_len);
+        text[text_len] = '\0';
+        entries[entry_count].hdr = hdr;
+        entries[entry_count].seg = seg;
+        entries[entry_count].text = text;
+        entry_count++;
+        pos -= len;
+    }
+    return 0;
+}
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const entry_t *x = a;
+    const entry_t *y = b;
+    if (x->hdr.ts != y->hdr.ts) return x->hdr.ts < y->hdr.ts ? -1 : 1;
+    return x->seg < y->seg ? -1 : x->seg > y->seg;
+}
+
+int main(int argc, char *argv[])
+{
+    int color = 1;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            color = 0;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-n] <file>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    dbg_flight_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+        || memcmp(hdr.magic, DBG_FLIGHT_MAGIC, sizeof(hdr.magic)) != 0
+        || hdr.version != DBG_FLIGHT_VERSION
+        || hdr.seg_size == 0 || (hdr.seg_size & (hdr.seg_size - 1)) != 0)
+    {
+        fprintf(stderr, "%s: not a flight recorder file\n", path);
+        fclose(fp);
+        return 1;
+    }
+
+    uint8_t *data = malloc(hdr.seg_size);
+    if (data == NULL)
+    {
+        fclose(fp);
+        return 1;
+    }
+    for (uint32_t i = 0; i < hdr.segments; i++)
+    {
+        dbg_flight_seg_t seg;
+        if (fread(&seg, sizeof(seg), 1, fp) != 1 || fread(data, hdr.seg_size, 1, fp) != 1)
+        {
+            fprintf(stderr, "%s: truncated at segment %u\n", path, i);
+            break;
+        }
+        if (seg.head > 0 && scan_segment(data, hdr.seg_size, seg.head, i) != 0)
+        {
+            break;
+        }
+    }
+    free(data);
+    fclose(fp);
+
+    qsort(entries, entry_count, sizeof(entry_t), entry_cmp);
+    fprintf(stderr, "pid %u, %zu records, %llu dropped\n", hdr.pid, entry_count,
+            (unsigned long long)hdr.dropped);
+    for (size_t i = 0; i < entry_count; i++)
+    {
+        const entry_t *e = &entries[i];
+        int64_t ns = (int64_t)dbg_clock_to_ns(&hdr.clock, e->hdr.ts) + hdr.clock.realtime_offset;
+        time_t sec = (time_t)(ns / 1000000000);
+        struct tm tm;
+        char tbuf[32];
+        localtime_r(&sec, &tm);
+        strftime(tbuf, sizeof(tbuf), "%H:%M:%S", &tm);
+        printf("%s.%06ld %5u %s%s%s\n", tbuf, (long)(ns % 1000000000) / 1000, e->hdr.tid,
+               color ? level_color(e->hdr.level) : "", e->text, color ? ANSI_COLOR_RESET : "");
+        free(e->text);
+    }
+    free(entries);
+    return 0;
+}
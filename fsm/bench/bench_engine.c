@@ -0,0 +1,154 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fsm_engine.h"
+#include "fsm_stats.h"
+
+/**
+ * @brief   多实例状态机引擎性能测试
+ * @note    大量独立的实例共享同一张状态表，多个投递线程随机向实例投递事件，
+ *          一个调度线程批量分派，统计每秒分派的事件数以及每个实例占用的内存
+ * @note    队列满时投递线程让出CPU后重试，结束时检查每个实例执行动作的次数等于投递的次数
+ * @note    开启统计时输出转移次数以及延迟，用于比较统计的开销
+ * @note    ./bench_engine [实例数, 默认100000] [投递线程数, 默认4] [每个线程投递的事件数, 默认2000000] [统计 0/1, 默认0]
+*/
+
+// 测试用的状态机: 两个状态互相切换，每次转移计数加1
+enum { ST_A, ST_B, ST_COUNT };
+enum { EV_TOGGLE, EV_COUNT };
+
+typedef struct
+{
+    stc_fsm_instance_t fsm;
+    uint32_t actions;       // 执行动作的次数(调度线程)
+    uint32_t posted;        // 投递成功的次数(投递线程，原子加)
+}stc_bench_ctx_t;
+
+static void toggle_action(void *ctx)
+{
+    ((stc_bench_ctx_t *)ctx)->actions++;
+}
+
+#define BENCH_MAP(X)                                    \
+    X(ST_A,  EV_TOGGLE,  toggle_action,  ST_B)          \
+    X(ST_B,  EV_TOGGLE,  toggle_action,  ST_A)
+
+FSM_DENSE_TABLE(bench_map, BENCH_MAP, ST_COUNT, EV_COUNT);
+static const stc_fsm_def_t bench_def = FSM_DEF_DENSE(bench_map);
+
+static stc_bench_ctx_t *bench_ctx;
+static size_t bench_instances;
+static long bench_events;
+static int bench_running;
+static uint64_t bench_full;
+static stc_fsm_sched_t bench_sched;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *producer(void *arg)
+{
+    uint64_t rng = 0x9e3779b97f4a7c15ull * ((uintptr_t)arg + 1);
+    uint64_t full = 0;
+    for (long i = 0; i < bench_events; i++)
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        stc_bench_ctx_t *ctx = &bench_ctx[(rng >> 16) % bench_instances];
+        // 队列满时让出CPU给调度线程后重试
+        while (fsm_post(&ctx->fsm, EV_TOGGLE) != 0)
+        {
+            full++;
+            sched_yield();
+        }
+        __atomic_fetch_add(&ctx->posted, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&bench_full, full, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&bench_running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_instances = argc > 1 ? (size_t)atol(argv[1]) : 100000;
+    int threads = argc > 2 ? atoi(argv[2]) : 4;
+    bench_events = argc > 3 ? atol(argv[3]) : 2000000;
+    int with_stats = argc > 4 ? atoi(argv[4]) : 0;
+
+    bench_ctx = calloc(bench_instances, sizeof(*bench_ctx));
+    if (bench_ctx == NULL)
+    {
+        return 1;
+    }
+    fsm_sched_init(&bench_sched);
+    stc_fsm_stats_t stats;
+    if (with_stats)
+    {
+        static const char *const state_names[ST_COUNT] = { "A", "B" };
+        static const char *const event_names[EV_COUNT] = { "TOGGLE" };
+        if (fsm_stats_init(&stats, &bench_def, state_names, event_names) != 0)
+        {
+            return 1;
+        }
+        bench_sched.stats = &stats;
+    }
+    for (size_t i = 0; i < bench_instances; i++)
+    {
+        fsm_instance_init(&bench_ctx[i].fsm, &bench_def, &bench_sched, ST_A, &bench_ctx[i]);
+    }
+
+    pthread_t *tids = malloc(sizeof(pthread_t) * threads);
+    bench_running = threads;
+    double start = now_sec();
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&tids[i], NULL, producer, (void *)(uintptr_t)i);
+    }
+    // 调度线程: 读到所有投递线程结束之后，再处理一轮剩余的事件
+    size_t events = 0;
+    for (;;)
+    {
+        int running = __atomic_load_n(&bench_running, __ATOMIC_ACQUIRE);
+        size_t n = fsm_sched_run(&bench_sched);
+        events += n;
+        if (running == 0 && n == 0)
+        {
+            break;
+        }
+    }
+    double sec = now_sec() - start;
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+
+    size_t bad = 0;
+    for (size_t i = 0; i < bench_instances; i++)
+    {
+        bad += bench_ctx[i].actions != bench_ctx[i].posted;
+    }
+    printf("instances %zu, producers %d, %zu events in %.3f s: %.2f M events/s\n",
+           bench_instances, threads, events, sec, events / sec / 1e6);
+    printf("queue full retries %llu, dispatched %llu, ignored %llu, mismatched instances %zu\n",
+           (unsigned long long)bench_full, (unsigned long long)bench_sched.dispatched,
+           (unsigned long long)bench_sched.ignored, bad);
+    printf("memory per instance %zu bytes (engine %zu), total %.1f MB\n",
+           sizeof(stc_bench_ctx_t), sizeof(stc_fsm_instance_t),
+           bench_instances * sizeof(stc_bench_ctx_t) / 1048576.0);
+    if (with_stats)
+    {
+        fsm_stats_prometheus(&stats, stdout, "bench");
+        fsm_stats_free(&stats);
+    }
+    free(tids);
+    free(bench_ctx);
+    return bad != 0;
+}
@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fsm_table.h"
+
+/**
+ * @brief   状态转移表查找性能测试
+ * @note    随机生成不同大小以及密度的转移表，按同一个随机事件序列驱动状态机，
+ *          对比 线性遍历 / 稠密表 / 稀疏表(行位移压缩) 每次分派的耗时以及表的内存
+ * @note    三种方式的最终状态必须一致，否则输出 MISMATCH
+ * @note    ./bench_fsm [事件数量, 默认2000000]
+*/
+
+// 测试的表: 状态数 x 条件数 x 有转移的比例(%)
+static const struct
+{
+    uint32_t states;
+    uint32_t events;
+    uint32_t density;
+}bench_tables[] =
+{
+    {3,     3,      45},
+    {16,    8,      30},
+    {64,    32,     20},
+    {256,   64,     10},
+    {1024,  256,    2},
+};
+
+// 防止编译器把结果优化掉
+static volatile uint32_t bench_sink;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static void nop_action(void *ctx)
+{
+    (void)ctx;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t nevents_seq = argc > 1 ? (size_t)atol(argv[1]) : 2000000;
+    uint32_t *seq = malloc(nevents_seq * sizeof(*seq));
+    if (seq == NULL)
+    {
+        return 1;
+    }
+    printf("%10s %8s %6s %12s %12s %12s %10s %10s\n", "table", "rows", "fill",
+           "linear ns", "dense ns", "sparse ns", "dense KB", "sparse KB");
+    for (size_t t = 0; t < sizeof(bench_tables) / sizeof(bench_tables[0]); t++)
+    {
+        uint32_t ns = bench_tables[t].states;
+        uint32_t ne = bench_tables[t].events;
+        size_t cells = (size_t)ns * ne;
+
+        // 随机生成规则，每个状态至少有一个转移，保证状态机不会卡住
+        stc_fsm_row_t *rows = malloc(cells * sizeof(*rows));
+        stc_fsm_entry_t *dense = malloc(cells * sizeof(*dense));
+        size_t nrows = 0;
+        for (size_t i = 0; i < cells; i++)
+        {
+            dense[i].action = NULL;
+            dense[i].next_state = FSM_NONE;
+        }
+        for (uint32_t s = 0; s < ns; s++)
+        {
+            for (uint32_t e = 0; e < ne; e++)
+            {
+                if (e == s % ne || rng_next() % 100 < bench_tables[t].density)
+                {
+                    stc_fsm_row_t *r = &rows[nrows++];
+                    r->state = s;
+                    r->event = e;
+                    r->action = nop_action;
+                    r->next_state = rng_next() % ns;
+                    dense[(size_t)s * ne + e].action = r->action;
+                    dense[(size_t)s * ne + e].next_state = r->next_state;
+                }
+            }
+        }
+        // 原来的状态表没有顺序，打乱规则
+        for (size_t i = nrows; i > 1; i--)
+        {
+            size_t j = rng_next() % i;
+            stc_fsm_row_t tmp = rows[i - 1];
+            rows[i - 1] = rows[j];
+            rows[j] = tmp;
+        }
+        stc_fsm_sparse_t sparse;
+        if (fsm_sparse_build(&sparse, rows, nrows, ns, ne) != 0)
+        {
+            printf("sparse build failed\n");
+            return 1;
+        }
+        for (size_t i = 0; i < nevents_seq; i++)
+        {
+            seq[i] = rng_next() % ne;
+        }
+
+        uint32_t final[3];
+        double sec[3];
+        for (int m = 0; m < 3; m++)
+        {
+            uint32_t state = 0;
+            double start = now_sec();
+            for (size_t i = 0; i < nevents_seq; i++)
+            {
+                fsm_action_t action = NULL;
+                uint32_t next = FSM_NONE;
+                if (m == 0)
+                {
+                    const stc_fsm_row_t *r = fsm_linear_lookup(rows, nrows, state, seq[i]);
+                    if (r != NULL)
+                    {
+                        action = r->action;
+                        next = r->next_state;
+                    }
+                }
+                else
+                {
+                    const stc_fsm_entry_t *entry = m == 1
+                        ? (dense[(size_t)state * ne + seq[i]].next_state != FSM_NONE
+                           ? &dense[(size_t)state * ne + seq[i]] : NULL)
+                        : fsm_sparse_lookup(&sparse, state, seq[i]);
+                    if (entry != NULL)
+                    {
+                        action = entry->action;
+                        next = entry->next_state;
+                    }
+                }
+                if (next != FSM_NONE)
+                {
+                    action(&state);
+                    state = next;
+                }
+            }
+            sec[m] = now_sec() - start;
+            final[m] = state;
+        }
+        bench_sink = final[0];
+
+        char name[32];
+        snprintf(name, sizeof(name), "%ux%u", ns, ne);
+        printf("%10s %8zu %5.1f%% %12.2f %12.2f %12.2f %10.1f %10.1f%s\n", name, nrows,
+               100.0 * nrows / cells, sec[0] * 1e9 / nevents_seq, sec[1] * 1e9 / nevents_seq,
+               sec[2] * 1e9 / nevents_seq, cells * sizeof(stc_fsm_entry_t) / 1024.0,
+               (ns * sizeof(uint32_t) + sparse.size * (sizeof(uint32_t) + sizeof(stc_fsm_entry_t))) / 1024.0,
+               final[0] == final[1] && final[1] == final[2] ? "" : "  MISMATCH");
+        fsm_sparse_free(&sparse);
+        free(rows);
+        free(dense);
+    }
+    free(seq);
+    return 0;
+}
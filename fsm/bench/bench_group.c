@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 199309L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "elevator_group.h"
+#include "fsm_sim.h"
+
+/**
+ * @brief   电梯群控分配策略对比
+ * @note    离散事件仿真，虚拟时间单位为毫秒，运行一层楼 RUN_TIME 秒，开门停靠 3 秒
+ * @note    呼梯按泊松过程到达: 40% 从0层上行，40% 回到0层，20% 楼层之间，
+ *          每种策略使用相同的呼梯序列，统计候梯时间、行程时间(秒)、每小时完成的行程以及分配耗时，
+ *          以及每秒实际仿真的行程数
+ * @note    ./bench_group [电梯数量, 默认8] [每分钟呼梯数, 默认60] [模拟分钟数, 默认120]
+*/
+
+// 每秒的虚拟时间
+#define TICKS_PER_SEC   1000
+// 开门停靠时间(秒)
+#define DOOR_TIME       3
+
+static const struct
+{
+    const char *name;
+    group_policy_t policy;
+}bench_policies[] =
+{
+    {"nearest",     group_policy_nearest},
+    {"look",        group_policy_look},
+    {"destination", group_policy_destination},
+};
+
+static uint64_t rng_state;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static double rng_uniform(void)
+{
+    return (rng_next() + 0.5) / 4294967296.0;
+}
+
+static int rng_floor(void)
+{
+    return MIN_FLOOR + (int)(rng_next() % FLOOR_COUNT);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t ncars = argc > 1 ? (uint32_t)atoi(argv[1]) : 8;
+    double per_minute = argc > 2 ? atof(argv[2]) : 60;
+    uint64_t minutes = argc > 3 ? (uint64_t)atoll(argv[3]) : 120;
+    uint64_t end = minutes * 60 * TICKS_PER_SEC;
+    double mean_gap = 60.0 * TICKS_PER_SEC / per_minute;
+
+    printf("%u cars, floors [%d, %d], %.0f calls/min, %llu min\n", ncars, MIN_FLOOR, MAX_FLOOR, per_minute,
+           (unsigned long long)minutes);
+    printf("%12s %8s %9s %9s %9s %9s %9s %9s %9s\n", "policy", "trips", "trips/h", "wait avg", "wait p99",
+           "ride avg", "ride p99", "dec ns", "dec p99");
+    for (size_t p = 0; p < sizeof(bench_policies) / sizeof(bench_policies[0]); p++)
+    {
+        stc_fsm_sched_t sched;
+        stc_fsm_sim_t sim;
+        stc_fsm_clock_t clock;
+        stc_elevator_group_t group;
+        fsm_sched_init(&sched);
+        if (fsm_sim_init(&sim, 2 * ncars, &sched, elevator_group_expire) != 0)
+        {
+            return 1;
+        }
+        fsm_sim_clock(&sim, &clock);
+        if (elevator_group_init(&group, ncars, 1u << 16, &sched, &clock, RUN_TIME * TICKS_PER_SEC,
+                                   DOOR_TIME * TICKS_PER_SEC, bench_policies[p].policy) != 0)
+        {
+            return 1;
+        }
+        rng_state = 0x9e3779b97f4a7c15ull;
+        double next_call = -log(rng_uniform()) * mean_gap;
+        uint64_t accepted = 0;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        // 虚拟时间跳到下一个呼梯，期间到期的定时器依次处理
+        while (next_call < (double)end)
+        {
+            fsm_sim_run(&sim, (uint64_t)next_call);
+            int origin;
+            int dest;
+            uint32_t kind = rng_next() % 10;
+            if (kind < 4)
+            {
+                origin = 0;
+                do dest = rng_floor(); while (dest == 0);
+            }
+            else if (kind < 8)
+            {
+                do origin = rng_floor(); while (origin == 0);
+                dest = 0;
+            }
+            else
+            {
+                origin = rng_floor();
+                do dest = rng_floor(); while (dest == origin);
+            }
+            accepted += elevator_group_call(&group, origin, dest) >= 0;
+            while (fsm_sched_run(&sched) > 0);
+            next_call += -log(rng_uniform()) * mean_gap;
+        }
+        // 停止呼梯后继续运行，直到所有乘客到达
+        while (group.journey.count < accepted && fsm_sim_step(&sim));
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        uint64_t last_trip = sim.now;
+        double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        double hours = (double)(last_trip > end ? last_trip : end) / TICKS_PER_SEC / 3600.0;
+        printf("%12s %8llu %9.0f %9.1f %9.1f %9.1f %9.1f %9.0f %9.0f%s\n", bench_policies[p].name,
+               (unsigned long long)group.journey.count, group.journey.count / hours,
+               fsm_hist_mean(&group.wait) / TICKS_PER_SEC,
+               (double)fsm_hist_percentile(&group.wait, 99) / TICKS_PER_SEC,
+               fsm_hist_mean(&group.journey) / TICKS_PER_SEC,
+               (double)fsm_hist_percentile(&group.journey, 99) / TICKS_PER_SEC,
+               fsm_hist_mean(&group.decide), (double)fsm_hist_percentile(&group.decide, 99),
+               group.rejected || group.journey.count < accepted ? "  (lost calls)" : "");
+        printf("%12s %llu timer events, %.3f s wall, %.0f trips/s simulated\n", "",
+               (unsigned long long)sim.events, wall, group.journey.count / wall);
+        elevator_group_free(&group);
+        fsm_sim_free(&sim);
+    }
+    return 0;
+}
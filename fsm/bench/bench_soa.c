@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "elevator_soa.h"
+#include "fsm_sim.h"
+
+/**
+ * @brief   结构数组批量仿真性能测试以及一致性检查
+ * @note    每个tick随机选择电梯登记请求，然后所有电梯前进一个tick，统计每秒更新的电梯数(car-ticks/s)
+ * @note    前 VERIFY_CARS 部电梯同时作为 elevator.c 的状态机实例由离散事件仿真驱动(定时器在下一个tick到期)，
+ *          收到相同的请求，每个tick之后比较状态、楼层、方向以及请求位图，不一致时打印 MISMATCH 并返回1
+ * @note    ./bench_soa [电梯数量, 默认1048576] [tick数, 默认1000] [每千部电梯每tick的请求数, 默认20]
+*/
+
+// 同时运行状态机实例进行比较的电梯数量
+#define VERIFY_CARS     1024
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static double time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static stc_fsm_sim_t sim;
+// 当前的tick，状态机启动的定时器在下一个tick到期
+static uint64_t sim_tick;
+
+static void verify_start_timer(stc_elevator_t *elevator, en_timer_t timer)
+{
+    fsm_sim_start(&sim, sim_tick + 1 - sim.now, elevator, timer);
+}
+
+static void verify_expire(void *arg, uint32_t data)
+{
+    (void)data;
+    elevator_tick(arg);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t count = argc > 1 ? (size_t)atoll(argv[1]) : (1u << 20);
+    uint64_t ticks = argc > 2 ? (uint64_t)atoll(argv[2]) : 1000;
+    uint64_t per_mille = argc > 3 ? (uint64_t)atoll(argv[3]) : 20;
+    size_t verify = count < VERIFY_CARS ? count : VERIFY_CARS;
+    uint64_t requests = count * per_mille / 1000;
+
+    stc_elevator_soa_t soa;
+    stc_fsm_sched_t sched;
+    stc_elevator_t *cars = malloc(verify * sizeof(stc_elevator_t));
+    if (cars == NULL || elevator_soa_init(&soa, count) != 0)
+    {
+        printf("out of memory\n");
+        return 1;
+    }
+    fsm_sched_init(&sched);
+    if (fsm_sim_init(&sim, (uint32_t)verify, &sched, verify_expire) != 0)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < verify; i++)
+    {
+        elevator_init(&cars[i], &sched, verify_start_timer);
+    }
+
+    printf("%zu cars, floors [%d, %d], %llu ticks, %llu requests/tick, %d verified\n", count, MIN_FLOOR,
+           MAX_FLOOR, (unsigned long long)ticks, (unsigned long long)requests, (int)verify);
+    double kernel = 0;
+    double scalar = 0;
+    uint64_t mismatches = 0;
+    for (sim_tick = 1; sim_tick <= ticks; sim_tick++)
+    {
+        for (uint64_t r = 0; r < requests; r++)
+        {
+            size_t car = rng_next() % count;
+            int floor = MIN_FLOOR + (int)(rng_next() % FLOOR_COUNT);
+            elevator_soa_request(&soa, car, floor);
+            if (car < verify)
+            {
+                elevator_request(&cars[car], floor);
+            }
+        }
+
+        double t0 = time_now();
+        while (fsm_sched_run(&sched) > 0);
+        fsm_sim_run(&sim, sim_tick);
+        double t1 = time_now();
+        elevator_soa_tick(&soa);
+        double t2 = time_now();
+        scalar += t1 - t0;
+        kernel += t2 - t1;
+
+        for (size_t i = 0; i < verify; i++)
+        {
+            const stc_elevator_t *e = &cars[i];
+            if (soa.state[i] != e->fsm.state || (int)soa.floor[i] + MIN_FLOOR != e->current_floor
+                || soa.dir[i] != e->dir || soa.pending[i] != e->pending)
+            {
+                if (mismatches++ < 10)
+                {
+                    printf("MISMATCH tick %llu car %zu: soa state %u floor %d dir %d pending %#x, "
+                           "fsm state %u floor %d dir %d pending %#x\n", (unsigned long long)sim_tick, i,
+                           soa.state[i], (int)soa.floor[i] + MIN_FLOOR, soa.dir[i], soa.pending[i],
+                           e->fsm.state, e->current_floor, e->dir, e->pending);
+                }
+            }
+        }
+    }
+
+    printf("soa: %llu stops, %.3f s, %.1f M car-ticks/s, %.2f ns/car-tick\n", (unsigned long long)soa.stops,
+           kernel, count * ticks / kernel * 1e-6, kernel * 1e9 / ((double)count * ticks));
+    printf("fsm: %llu timer events, %.3f s, %.1f M car-ticks/s, %.2f ns/car-tick\n",
+           (unsigned long long)sim.events, scalar, verify * ticks / scalar * 1e-6,
+           scalar * 1e9 / ((double)verify * ticks));
+    printf("%llu mismatches\n", (unsigned long long)mismatches);
+
+    fsm_sim_free(&sim);
+    elevator_soa_free(&soa);
+    free(cars);
+    return mismatches != 0;
+}
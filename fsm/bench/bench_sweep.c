@@ -0,0 +1,266 @@
+#define _POSIX_C_SOURCE 199309L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "elevator_group.h"
+#include "fsm_pool.h"
+#include "fsm_sim.h"
+
+/**
+ * @brief   群控参数扫描: 多栋楼并行仿真
+ * @note    每个场景是 分配策略 x 电梯数量 的一个组合，每个场景仿真 [楼数] 栋楼，
+ *          每栋楼是一个作业，由工作窃取线程池并行运行；同一栋楼的各个场景使用相同的呼梯序列
+ * @note    每个作业在工作线程上创建自己的调度器、离散事件仿真以及群控，结果累加到该线程的累加器，
+ *          全部完成后按线程合并(整数累加以及直方图合并)，结果以及校验和与线程数量无关
+ * @note    呼梯模型与 bench_group 相同: 泊松到达，40% 从0层上行，40% 回到0层，20% 楼层之间
+ * @note    ./bench_sweep [楼数, 默认64] [线程数, 默认CPU数] [模拟分钟数, 默认60] [每分钟呼梯数, 默认60] [seed, 默认1]
+*/
+
+// 每秒的虚拟时间
+#define TICKS_PER_SEC   1000
+// 开门停靠时间(秒)
+#define DOOR_TIME       3
+// 每栋楼同时存在的呼梯数量
+#define SWEEP_CALLS     4096
+
+static const struct
+{
+    const char *name;
+    group_policy_t policy;
+}sweep_policies[] =
+{
+    {"nearest",     group_policy_nearest},
+    {"look",        group_policy_look},
+    {"destination", group_policy_destination},
+};
+
+static const uint32_t sweep_cars[] = { 4, 6, 8 };
+
+#define POLICY_COUNT    (sizeof(sweep_policies) / sizeof(sweep_policies[0]))
+#define CARS_COUNT      (sizeof(sweep_cars) / sizeof(sweep_cars[0]))
+#define SCENARIO_COUNT  (POLICY_COUNT * CARS_COUNT)
+
+// 一个场景的结果
+typedef struct
+{
+    uint64_t buildings;     // 完成的楼数
+    uint64_t calls;         // 接受的呼梯
+    uint64_t lost;          // 被拒绝或者没有完成的呼梯
+    uint64_t events;        // 定时器事件
+    uint64_t checksum;      // 每栋楼结果的散列之和
+    stc_fsm_hist_t wait;    // 候梯时间(虚拟时间)
+    stc_fsm_hist_t journey; // 行程时间(虚拟时间)
+}stc_sweep_result_t;
+
+// 扫描参数以及每个线程的累加器
+typedef struct
+{
+    uint64_t seed;
+    uint64_t end;                       // 停止呼梯的虚拟时间
+    double mean_gap;                    // 平均呼梯间隔
+    stc_sweep_result_t **acc;           // [线程][场景]，由线程在第一次使用时分配
+}stc_sweep_t;
+
+/**
+ * @brief   分配并清空 SCENARIO_COUNT 个场景的结果
+*/
+static stc_sweep_result_t *sweep_results(void)
+{
+    stc_sweep_result_t *results = calloc(SCENARIO_COUNT, sizeof(stc_sweep_result_t));
+    for (size_t s = 0; s < SCENARIO_COUNT && results != NULL; s++)
+    {
+        fsm_hist_init(&results[s].wait);
+        fsm_hist_init(&results[s].journey);
+    }
+    return results;
+}
+
+static uint32_t rng_next(uint64_t *rng)
+{
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 7;
+    *rng ^= *rng << 17;
+    return (uint32_t)(*rng >> 32);
+}
+
+static double rng_uniform(uint64_t *rng)
+{
+    return (rng_next(rng) + 0.5) / 4294967296.0;
+}
+
+static int rng_floor(uint64_t *rng)
+{
+    return MIN_FLOOR + (int)(rng_next(rng) % FLOOR_COUNT);
+}
+
+static void sweep_call(uint64_t *rng, int *origin, int *dest)
+{
+    uint32_t kind = rng_next(rng) % 10;
+    if (kind < 4)
+    {
+        *origin = 0;
+        do *dest = rng_floor(rng); while (*dest == 0);
+    }
+    else if (kind < 8)
+    {
+        do *origin = rng_floor(rng); while (*origin == 0);
+        *dest = 0;
+    }
+    else
+    {
+        *origin = rng_floor(rng);
+        do *dest = rng_floor(rng); while (*dest == *origin);
+    }
+}
+
+/**
+ * @brief   作业: 仿真一栋楼的一个场景
+ * @note    作业编号 = 楼 * 场景数 + 场景，相邻的作业属于不同的场景，连续均分时每个线程的负载接近
+*/
+static void sweep_job(void *arg, uint32_t worker, uint64_t job)
+{
+    stc_sweep_t *sweep = arg;
+    uint32_t scenario = (uint32_t)(job % SCENARIO_COUNT);
+    uint64_t building = job / SCENARIO_COUNT;
+    uint32_t ncars = sweep_cars[scenario % CARS_COUNT];
+    if (sweep->acc[worker] == NULL)
+    {
+        // 在工作线程上首次访问，位于该线程的NUMA节点
+        sweep->acc[worker] = sweep_results();
+        if (sweep->acc[worker] == NULL)
+        {
+            abort();
+        }
+    }
+    stc_sweep_result_t *acc = &sweep->acc[worker][scenario];
+
+    stc_fsm_sched_t sched;
+    stc_fsm_sim_t sim;
+    stc_fsm_clock_t clock;
+    stc_elevator_group_t group;
+    fsm_sched_init(&sched);
+    if (fsm_sim_init(&sim, 2 * ncars, &sched, elevator_group_expire) != 0)
+    {
+        abort();
+    }
+    fsm_sim_clock(&sim, &clock);
+    if (elevator_group_init(&group, ncars, SWEEP_CALLS, &sched, &clock, RUN_TIME * TICKS_PER_SEC,
+                            DOOR_TIME * TICKS_PER_SEC, sweep_policies[scenario / CARS_COUNT].policy) != 0)
+    {
+        abort();
+    }
+
+    // 种子只取决于楼，同一栋楼的各个场景呼梯序列相同
+    uint64_t rng = fsm_pool_seed(sweep->seed, building) | 1;
+    double next_call = -log(rng_uniform(&rng)) * sweep->mean_gap;
+    uint64_t accepted = 0;
+    while (next_call < (double)sweep->end)
+    {
+        fsm_sim_run(&sim, (uint64_t)next_call);
+        int origin;
+        int dest;
+        sweep_call(&rng, &origin, &dest);
+        accepted += elevator_group_call(&group, origin, dest) >= 0;
+        while (fsm_sched_run(&sched) > 0);
+        next_call += -log(rng_uniform(&rng)) * sweep->mean_gap;
+    }
+    while (group.journey.count < accepted && fsm_sim_step(&sim));
+
+    acc->buildings++;
+    acc->calls += accepted;
+    acc->lost += group.rejected + (accepted - group.journey.count);
+    acc->events += sim.events;
+    acc->checksum += fsm_pool_seed(group.journey.sum ^ (group.wait.sum << 20), sim.events);
+    fsm_hist_merge(&acc->wait, &group.wait);
+    fsm_hist_merge(&acc->journey, &group.journey);
+    elevator_group_free(&group);
+    fsm_sim_free(&sim);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t buildings = argc > 1 ? (uint64_t)atoll(argv[1]) : 64;
+    uint32_t nthreads = argc > 2 ? (uint32_t)atoi(argv[2]) : 0;
+    uint64_t minutes = argc > 3 ? (uint64_t)atoll(argv[3]) : 60;
+    double per_minute = argc > 4 ? atof(argv[4]) : 60;
+    stc_sweep_t sweep = {
+        .seed = argc > 5 ? (uint64_t)atoll(argv[5]) : 1,
+        .end = minutes * 60 * TICKS_PER_SEC,
+        .mean_gap = 60.0 * TICKS_PER_SEC / per_minute,
+    };
+
+    stc_fsm_pool_t pool;
+    if (fsm_pool_init(&pool, nthreads) != 0)
+    {
+        return 1;
+    }
+    sweep.acc = calloc(pool.nworkers, sizeof(stc_sweep_result_t *));
+    if (sweep.acc == NULL)
+    {
+        return 1;
+    }
+    printf("%llu buildings x %zu scenarios, %u threads, %llu min, %.0f calls/min, seed %llu\n",
+           (unsigned long long)buildings, SCENARIO_COUNT, pool.nworkers, (unsigned long long)minutes, per_minute,
+           (unsigned long long)sweep.seed);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (fsm_pool_run(&pool, buildings * SCENARIO_COUNT, sweep_job, &sweep) != 0)
+    {
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+    // 按线程合并，与作业在哪个线程上执行无关
+    stc_sweep_result_t *total = sweep_results();
+    if (total == NULL)
+    {
+        return 1;
+    }
+    uint64_t events = 0;
+    uint64_t checksum = 0;
+    for (uint32_t w = 0; w < pool.nworkers; w++)
+    {
+        for (size_t s = 0; s < SCENARIO_COUNT && sweep.acc[w] != NULL; s++)
+        {
+            stc_sweep_result_t *src = &sweep.acc[w][s];
+            total[s].buildings += src->buildings;
+            total[s].calls += src->calls;
+            total[s].lost += src->lost;
+            total[s].events += src->events;
+            total[s].checksum += src->checksum;
+            fsm_hist_merge(&total[s].wait, &src->wait);
+            fsm_hist_merge(&total[s].journey, &src->journey);
+        }
+    }
+
+    printf("%12s %5s %9s %9s %9s %9s %9s %7s\n", "policy", "cars", "trips", "wait avg", "wait p99", "ride avg",
+           "ride p99", "lost");
+    for (size_t s = 0; s < SCENARIO_COUNT; s++)
+    {
+        stc_sweep_result_t *r = &total[s];
+        printf("%12s %5u %9llu %9.1f %9.1f %9.1f %9.1f %7llu\n", sweep_policies[s / CARS_COUNT].name,
+               sweep_cars[s % CARS_COUNT], (unsigned long long)r->journey.count,
+               fsm_hist_mean(&r->wait) / TICKS_PER_SEC,
+               (double)fsm_hist_percentile(&r->wait, 99) / TICKS_PER_SEC,
+               fsm_hist_mean(&r->journey) / TICKS_PER_SEC,
+               (double)fsm_hist_percentile(&r->journey, 99) / TICKS_PER_SEC, (unsigned long long)r->lost);
+        events += r->events;
+        checksum = checksum * 0x100000001b3ull + r->checksum;
+    }
+    printf("checksum %016llx\n", (unsigned long long)checksum);
+    printf("%.3f s wall, %.1f buildings/s, %.0f timer events/s\n", wall, buildings * SCENARIO_COUNT / wall,
+           events / wall);
+    for (uint32_t w = 0; w < pool.nworkers; w++)
+    {
+        printf("  worker %u (cpu %d): %llu jobs, %llu stolen\n", w, pool.workers[w].cpu,
+               (unsigned long long)pool.workers[w].executed, (unsigned long long)pool.workers[w].stolen);
+        free(sweep.acc[w]);
+    }
+    free(total);
+    free(sweep.acc);
+    fsm_pool_free(&pool);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fsm_wheel.h"
+
+/**
+ * @brief   时间轮性能测试
+ * @note    启动大量随机延迟的定时器，取消其中一半(模拟电梯提前到达后取消超时)，
+ *          再推进时间轮直到全部到期，统计 启动 / 取消 / 到期 每个定时器的耗时
+ * @note    每个定时器必须在启动时计算的tick到期，被取消的定时器不能到期，否则输出 MISMATCH
+ * @note    ./bench_wheel [定时器数量, 默认2000000] [最大延迟tick数, 默认1048576]
+*/
+
+// 推进时间轮时使用的虚拟时间
+static uint64_t bench_now;
+// 每个定时器期望的到期tick，0表示已经取消
+static uint64_t *bench_expect;
+static size_t bench_errors;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static void bench_expire(void *arg, uint32_t data)
+{
+    (void)arg;
+    if (bench_expect[data] != bench_now)
+    {
+        bench_errors++;
+    }
+    bench_expect[data] = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t count = argc > 1 ? (uint32_t)atol(argv[1]) : 2000000;
+    uint64_t range = argc > 2 ? (uint64_t)atoll(argv[2]) : 1u << 20;
+    stc_fsm_wheel_t wheel;
+    fsm_timer_t *timers = malloc((size_t)count * sizeof(*timers));
+    bench_expect = malloc((size_t)count * sizeof(*bench_expect));
+    if (timers == NULL || bench_expect == NULL || fsm_wheel_init(&wheel, count, 1000000, bench_expire) != 0)
+    {
+        return 1;
+    }
+
+    double start = now_sec();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t ticks = 1 + rng_next() % range;
+        timers[i] = fsm_wheel_start(&wheel, ticks, NULL, i);
+        bench_expect[i] = ticks;
+    }
+    double start_sec = now_sec() - start;
+
+    start = now_sec();
+    uint32_t cancelled = 0;
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        if (fsm_wheel_cancel(&wheel, timers[i]) == 0)
+        {
+            bench_expect[i] = 0;
+            cancelled++;
+        }
+    }
+    double cancel_sec = now_sec() - start;
+    // 已经取消的句柄再次取消必须失败
+    if (count > 0 && fsm_wheel_cancel(&wheel, timers[0]) == 0)
+    {
+        bench_errors++;
+    }
+
+    start = now_sec();
+    size_t expired = 0;
+    for (bench_now = 1; bench_now <= range; bench_now++)
+    {
+        expired += fsm_wheel_advance(&wheel, bench_now);
+    }
+    double advance_sec = now_sec() - start;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (bench_expect[i] != 0)
+        {
+            bench_errors++;
+        }
+    }
+
+    printf("timers %u, range %llu ticks, %zu bytes/timer, wheel %zu KB\n", count,
+           (unsigned long long)range, sizeof(stc_fsm_timer_node_t), sizeof(wheel) / 1024);
+    printf("start   %8.1f ns/timer\n", start_sec * 1e9 / (count ? count : 1));
+    printf("cancel  %8.1f ns/timer (%u)\n", cancel_sec * 1e9 / (cancelled ? cancelled : 1), cancelled);
+    printf("expire  %8.1f ns/timer (%zu), %.1f ns/tick%s\n", advance_sec * 1e9 / (expired ? expired : 1),
+           expired, advance_sec * 1e9 / range, bench_errors == 0 && wheel.count == 0 ? "" : "  MISMATCH");
+    fsm_wheel_free(&wheel);
+    free(bench_expect);
+    free(timers);
+    return 0;
+}
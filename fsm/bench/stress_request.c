@@ -0,0 +1,156 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "elevator.h"
+#include "fsm_wheel.h"
+
+/**
+ * @brief   多线程请求压力测试(配合 ThreadSanitizer 运行)
+ * @note    多个请求线程同时调用 elevator_request 登记随机楼层，一个调度线程分派事件并推进时间轮，
+ *          每轮分派之后调用 elevator_wake 重新投递失败的唤醒事件
+ * @note    请求线程结束后电梯必须在有限的tick内服务完所有请求并回到空闲，否则输出 STUCK 并返回1
+ * @note    另一个线程在请求期间不断向电梯投递多余的 EVENT_REQUEST 占满事件队列，
+ *          唤醒事件投递失败的路径会被反复执行，输出失败次数
+ * @note    ./stress_request [请求线程数, 默认4] [每个线程的请求数, 默认200000]
+*/
+
+// 请求线程数的上限
+#define STRESS_MAX_THREADS  64
+// 请求线程结束后允许的最大tick数: 每层一个tick，足够往返所有楼层多次
+#define STRESS_DRAIN_TICKS  (FLOOR_COUNT * 64)
+
+static stc_fsm_sched_t stress_sched;
+static stc_fsm_wheel_t stress_wheel;
+static stc_elevator_t stress_car;
+static long stress_requests;
+static int stress_done;
+static unsigned long stress_failed;
+static unsigned long stress_stops;
+
+static void stress_timer(stc_elevator_t *elevator, en_timer_t timer)
+{
+    (void)timer;
+    fsm_wheel_start(&stress_wheel, 1, elevator, 0);
+}
+
+static void stress_expire(void *arg, uint32_t data)
+{
+    (void)data;
+    elevator_tick(arg);
+}
+
+static void stress_stop(stc_elevator_t *elevator)
+{
+    (void)elevator;
+    stress_stops++;
+}
+
+static void *stress_thread(void *arg)
+{
+    uint32_t seed = (uint32_t)(uintptr_t)arg * 2654435761u + 1;
+    unsigned long failed = 0;
+    for (long i = 0; i < stress_requests; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if (elevator_request(&stress_car, MIN_FLOOR + (int)((seed >> 16) % FLOOR_COUNT)) != 0)
+        {
+            failed++;
+        }
+        if ((i & 63) == 0)
+        {
+            sched_yield();
+        }
+    }
+    __atomic_fetch_add(&stress_failed, failed, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stress_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// 占满事件队列，多余的 EVENT_REQUEST 在空闲时选择不到方向，在其他状态被忽略
+static void *stress_flood(void *arg)
+{
+    int nthreads = *(const int *)arg;
+    while (__atomic_load_n(&stress_done, __ATOMIC_ACQUIRE) < nthreads)
+    {
+        if (fsm_post(&stress_car.fsm, EVENT_REQUEST) != 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int nthreads = argc > 1 ? atoi(argv[1]) : 4;
+    stress_requests = argc > 2 ? atol(argv[2]) : 200000;
+    if (nthreads <= 0 || nthreads > STRESS_MAX_THREADS || stress_requests <= 0)
+    {
+        fprintf(stderr, "usage: %s [threads 1~%d] [requests per thread]\n", argv[0], STRESS_MAX_THREADS);
+        return 2;
+    }
+    fsm_sched_init(&stress_sched);
+    if (fsm_wheel_init(&stress_wheel, 4, 1, stress_expire) != 0)
+    {
+        return 1;
+    }
+    elevator_init(&stress_car, &stress_sched, stress_timer);
+    stress_car.stop = stress_stop;
+
+    pthread_t threads[STRESS_MAX_THREADS];
+    pthread_t flood;
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_create(&threads[i], NULL, stress_thread, (void *)(uintptr_t)i);
+    }
+    pthread_create(&flood, NULL, stress_flood, &nthreads);
+
+    // 调度线程: 分派、重新唤醒、推进一个tick
+    uint64_t tick = 0;
+    uint64_t drain_start = 0;
+    int stuck = 0;
+    for (;;)
+    {
+        while (fsm_sched_run(&stress_sched) > 0);
+        elevator_wake(&stress_car);
+        fsm_wheel_advance(&stress_wheel, ++tick);
+        if (__atomic_load_n(&stress_done, __ATOMIC_ACQUIRE) < nthreads)
+        {
+            continue;
+        }
+        if (drain_start == 0)
+        {
+            drain_start = tick;
+        }
+        if (stress_car.fsm.state == STATE_IDLE && stress_wheel.count == 0
+            && __atomic_load_n(&stress_car.pending, __ATOMIC_ACQUIRE) == 0
+            && fsm_sched_run(&stress_sched) == 0)
+        {
+            break;
+        }
+        if (tick - drain_start > STRESS_DRAIN_TICKS)
+        {
+            stuck = 1;
+            break;
+        }
+    }
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_join(flood, NULL);
+
+    printf("%d threads x %ld requests: %llu ticks, %lu stops, %lu failed wakeups\n", nthreads, stress_requests,
+           (unsigned long long)tick, stress_stops, stress_failed);
+    if (stuck)
+    {
+        printf("STUCK: state %u, pending 0x%08x, wake_pending %u\n", stress_car.fsm.state,
+               stress_car.pending, stress_car.wake_pending);
+        return 1;
+    }
+    fsm_wheel_free(&stress_wheel);
+    return 0;
+}
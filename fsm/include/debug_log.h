@@ -15,7 +15,9 @@
  * @brief   调试输出总开关
  * @note    处于禁用状态时关闭所有输出
 */
+#ifndef DBG_ENABLE
 #define DBG_ENABLE          1
+#endif
 
 /**
  * @brief   是否启用颜色输出
@@ -29,7 +31,9 @@
  * @note    2. 假设 指定的打印等级 = DBG_LOG_WARNING,
  *          则只会打印 DBG_LOG_WARNING 和 DBG_LOG_ERROR两个等级的信息
 */
+#ifndef DBG_LOG_LEVEL
 #define DBG_LOG_LEVEL       DBG_LOG_DEBUG
+#endif
 
 
 /*************************** 调试输出保留宏 ********************************/
@@ -59,6 +63,12 @@
 #define PRINT_ANSI_COLOR(...)
 #endif
 
+/**
+ * @brief   运行时的输出等级，初始值为 DBG_LOG_LEVEL
+ * @note    只能在编译时的等级范围内调低，设置为0时关闭所有等级的输出，例如仿真时关闭动作中的打印
+*/
+extern int dbg_log_threshold;
+
 // 只获取文件名
 #define filename(x) strrchr(x,'/')?strrchr(x,'/')+1:x
 
@@ -66,48 +76,48 @@
 #if DBG_ENABLE
 // [调试]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_DEBUG
-#define DBG_LOGD(...) \
+#define DBG_LOGD(...) do { if (dbg_log_threshold >= DBG_LOG_DEBUG) { \
     PRINT_ANSI_COLOR(ANSI_COLOR_BLUE); \
     printf("[%s]: ", __func__); \
     printf(__VA_ARGS__); \
     PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-    printf("\n");
+    printf("\n"); } } while (0)
 #else
 #define DBG_LOGD(...)
 #endif
 
 // [普通]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_INFO
-#define DBG_LOGI(...) \
+#define DBG_LOGI(...) do { if (dbg_log_threshold >= DBG_LOG_INFO) { \
     PRINT_ANSI_COLOR(ANSI_COLOR_GREEN); \
     printf("[%s]: ", __func__); \
     printf(__VA_ARGS__); \
     PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-    printf("\n");
+    printf("\n"); } } while (0)
 #else
 #define DBG_LOGI(...)
 #endif
 
 // [警告]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_WARNING
-#define DBG_LOGW(...) \
+#define DBG_LOGW(...) do { if (dbg_log_threshold >= DBG_LOG_WARNING) { \
     PRINT_ANSI_COLOR(ANSI_COLOR_YELLOW); \
     printf("[%s:%d %s]: ", filename(__FILE__), __LINE__, __func__); \
     printf(__VA_ARGS__); \
     PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-    printf("\n");
+    printf("\n"); } } while (0)
 #else
 #define DBG_LOGW(...)
 #endif
 
 // [错误]等级控制
 #if DBG_LOG_LEVEL >= DBG_LOG_ERROR
-#define DBG_LOGE(...) \
+#define DBG_LOGE(...) do { if (dbg_log_threshold >= DBG_LOG_ERROR) { \
     PRINT_ANSI_COLOR(ANSI_COLOR_RED); \
     printf("[%s:%d %s]: ", filename(__FILE__), __LINE__, __func__); \
     printf(__VA_ARGS__); \
     PRINT_ANSI_COLOR(ANSI_COLOR_RESET); \
-    printf("\n");
+    printf("\n"); } } while (0)
 #else
 #define DBG_LOGE(...)
 #endif
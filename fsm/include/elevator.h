@@ -0,0 +1,127 @@
+#ifndef ELEVATOR_H_
+#define ELEVATOR_H_
+
+#include "fsm_engine.h"
+
+/**
+ * @brief   电梯控制器
+ * @note    状态表只读并由所有电梯共享，每部电梯是一个独立的状态机实例，
+ *          楼层等数据保存在实例自己的上下文中
+ * @note    电梯每运行一层启动一次定时器，定时器到期时调用 elevator_tick，
+ *          由 elevator_tick 投递 [继续运行]、[停靠] 或者 [到达] 事件
+ * @note    请求的楼层保存在每部电梯的位图 pending 中(4字节)，重复的请求自动合并，
+ *          任意线程都可以无锁地登记请求；电梯按运行方向依次停靠沿途请求的楼层，
+ *          前方没有请求时掉头(LOOK)，所有请求服务完成后空闲
+*/
+
+// 电梯底层
+#define MIN_FLOOR   -3
+// 电梯顶层
+#define MAX_FLOOR   20
+// 电梯运行一层楼梯所需要的时间(单位秒)
+#define RUN_TIME    1
+// 楼层数量，请求位图的第 (楼层 - MIN_FLOOR) 位表示该楼层有请求
+#define FLOOR_COUNT (MAX_FLOOR - MIN_FLOOR + 1)
+// 楼层对应的位
+#define FLOOR_BIT(floor)    (1u << ((floor) - MIN_FLOOR))
+
+// 电梯状态
+typedef enum
+{
+    STATE_IDLE,
+    STATE_GOING_UP,
+    STATE_GOING_DOWN,
+    STATE_STOPPED,      // 中途停靠(开门)
+    STATE_COUNT         // 状态数量(哨兵)
+}en_state_t;
+
+// 电梯事件
+typedef enum
+{
+    EVENT_UP,
+    EVENT_DOWN,
+    EVENT_ARRIVE,
+    EVENT_STOP,         // 到达请求的楼层，还有其他请求
+    EVENT_REQUEST,      // 空闲时有新的请求
+    EVENT_COUNT         // 事件数量(哨兵)
+}en_event_t;
+
+// 定时器类型
+typedef enum
+{
+    TIMER_RUN,          // 运行一层楼
+    TIMER_STOP,         // 停靠
+}en_timer_t;
+
+// 动作对电梯数据的影响，用于由状态表生成批量仿真(elevator_soa)的转移
+typedef enum
+{
+    EFFECT_MOVE_UP      = 1u << 0,      // 楼层加1，方向为上行
+    EFFECT_MOVE_DOWN    = 1u << 1,      // 楼层减1，方向为下行
+    EFFECT_CLEAR        = 1u << 2,      // 清除当前楼层的请求
+    EFFECT_DISPATCH     = 1u << 3,      // 按 LOOK 顺序选择方向并投递上升或者下降事件
+}en_effect_t;
+
+typedef struct stc_elevator stc_elevator_t;
+
+// 电梯
+struct stc_elevator
+{
+    stc_fsm_instance_t fsm;                     // 状态机实例，ctx 指向电梯本身
+    int current_floor;                          // 当前楼层，运行中为正在驶向的楼层
+    int dir;                                    // 最近一次的运行方向: 1 上行，-1 下行
+    uint32_t pending;                           // 请求的楼层位图(原子操作)
+    int departing;                              // 空闲时已经投递了出发事件，忽略重复的 EVENT_REQUEST
+    uint32_t wake_pending;                      // EVENT_REQUEST 投递失败，等待重新投递(原子操作)
+    void (*start_timer)(stc_elevator_t *, en_timer_t);  // 启动定时器，到期时调用 elevator_tick
+    void (*stop)(stc_elevator_t *);             // 在请求的楼层停靠(包括到达)时调用，可以为NULL
+};
+
+// 电梯状态机定义
+extern const stc_fsm_def_t elevator_def;
+// 状态以及事件的名称(用于统计输出)
+extern const char *const elevator_state_names[STATE_COUNT];
+extern const char *const elevator_event_names[EVENT_COUNT];
+
+/**
+ * @brief   初始化电梯，停在0层
+ * @note    stop 初始化为NULL，需要时在初始化之后设置
+ * @param   [in] sched          调度器
+ * @param   [in] start_timer    启动定时器的函数
+*/
+void elevator_init(stc_elevator_t *elevator, stc_fsm_sched_t *sched,
+                   void (*start_timer)(stc_elevator_t *, en_timer_t));
+
+/**
+ * @brief   登记请求的楼层
+ * @note    可以在任意线程中调用，不加锁；位图从空变为非空时投递 EVENT_REQUEST 唤醒空闲的电梯，
+ *          运行中的电梯在经过或者掉头后停靠
+ * @note    调用者负责检查楼层范围
+ * @note    唤醒事件因为队列已满投递失败时记录 wake_pending，由下一次请求或者 elevator_wake 重新投递
+ * @return  成功返回0，事件队列已满返回-1(请求已经登记，唤醒事件等待重新投递)
+*/
+int elevator_request(stc_elevator_t *elevator, int floor);
+
+/**
+ * @brief   重新投递之前投递失败的唤醒事件
+ * @note    由调度线程在每轮分派之后调用(例如事件循环的 round_cb)，保证没有新的请求时电梯也能被唤醒
+ * @return  没有等待的唤醒事件或者投递成功返回0，仍然失败返回-1
+*/
+int elevator_wake(stc_elevator_t *elevator);
+
+/**
+ * @brief   动作的影响
+ * @param   [in] action 状态表中的动作
+ * @return  en_effect_t 的组合，NULL 返回0
+*/
+uint32_t elevator_action_effect(fsm_action_t action);
+
+/**
+ * @brief   定时器到期
+ * @note    运行中: 到达请求的楼层时投递 EVENT_STOP(还有其他请求) 或者 EVENT_ARRIVE，否则继续运行
+ * @note    停靠结束: 按 LOOK 顺序投递上升或者下降事件，没有请求时投递 EVENT_ARRIVE
+ * @note    事件队列已满时启动 TIMER_STOP 定时器，到期后重新判断
+*/
+void elevator_tick(stc_elevator_t *elevator);
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef ELEVATOR_GROUP_H_
+#define ELEVATOR_GROUP_H_
+
+#include <stdint.h>
+#include "elevator.h"
+#include "fsm_hist.h"
+#include "fsm_clock.h"
+
+/**
+ * @brief   电梯群控
+ * @note    N 部电梯共享同一个调度器以及定时器(时间轮或者离散事件仿真)，每部电梯仍然是 elevator.c 中的状态机实例，
+ *          群控只负责把呼梯分配给电梯以及让乘客进出轿厢
+ * @note    呼梯带有出发楼层以及目标楼层(目的层派梯)，分配策略可以替换:
+ *          最近电梯 / LOOK 扫描 / 目的层派梯(代价函数)
+ * @note    分配后把出发楼层、乘客进入轿厢后把目标楼层登记到电梯的请求位图，
+ *          电梯按 LOOK 顺序停靠，每次停靠时乘客进出轿厢
+ * @note    时间以定时器接口的时间为单位，统计候梯时间(呼梯 - 进入轿厢)以及行程时间(呼梯 - 到达目标楼层)，
+ *          分配耗时以纳秒为单位
+ * @note    不考虑轿厢容量，乘客进入到达的电梯时不区分运行方向
+*/
+
+// 空链接
+#define GROUP_NIL           UINT32_MAX
+
+// 一次呼梯(一位乘客)
+typedef struct
+{
+    int16_t origin;         // 出发楼层
+    int16_t dest;           // 目标楼层
+    uint32_t next;          // 所在链表的下一个呼梯
+    uint64_t call_time;     // 呼梯时间(tick)
+}stc_group_call_t;
+
+typedef struct stc_elevator_group stc_elevator_group_t;
+
+// 群控中的一部电梯
+typedef struct
+{
+    stc_elevator_t elevator;        // 电梯状态机，必须是第一个成员
+    stc_elevator_group_t *group;    // 所属的群控
+    uint32_t waiting;               // 已分配、尚未进入轿厢的呼梯
+    uint32_t riding;                // 轿厢内的呼梯
+    uint32_t load;                  // 已分配的呼梯数量(等待 + 轿厢内)
+}stc_group_car_t;
+
+/**
+ * @brief   分配策略
+ * @param   [in] origin 出发楼层
+ * @param   [in] dest   目标楼层
+ * @return  电梯编号
+*/
+typedef uint32_t (*group_policy_t)(const stc_elevator_group_t *group, int origin, int dest);
+
+// 群控
+struct stc_elevator_group
+{
+    stc_group_car_t *cars;          // 电梯
+    uint32_t ncars;                 // 电梯数量
+    stc_group_call_t *calls;        // 呼梯池
+    uint32_t capacity;              // 呼梯池容量
+    uint32_t free;                  // 空闲的呼梯
+    stc_fsm_clock_t clock;          // 定时器，到期回调必须是 elevator_group_expire
+    uint32_t floor_ticks;           // 运行一层楼的时间
+    uint32_t stop_ticks;            // 停靠的时间
+    group_policy_t policy;          // 分配策略
+    uint64_t rejected;              // 呼梯池已满被拒绝的呼梯数
+    stc_fsm_hist_t wait;            // 候梯时间
+    stc_fsm_hist_t journey;         // 行程时间
+    stc_fsm_hist_t decide;          // 分配耗时(纳秒)
+};
+
+/**
+ * @brief   最近电梯: 选择距离出发楼层最近的电梯，不考虑方向
+*/
+uint32_t group_policy_nearest(const stc_elevator_group_t *group, int origin, int dest);
+
+/**
+ * @brief   LOOK 扫描: 按 LOOK 顺序估算到达出发楼层的时间(运行以及沿途停靠)，选择最早到达的电梯
+*/
+uint32_t group_policy_look(const stc_elevator_group_t *group, int origin, int dest);
+
+/**
+ * @brief   目的层派梯: 代价 = 到达出发楼层的时间 + 乘坐时间 + 新增停靠对已分配乘客的延误，
+ *          选择代价最小的电梯，目标楼层相同的乘客倾向于分配到同一部电梯
+*/
+uint32_t group_policy_destination(const stc_elevator_group_t *group, int origin, int dest);
+
+/**
+ * @brief   初始化群控，所有电梯停在0层
+ * @param   [in] ncars          电梯数量
+ * @param   [in] capacity       同时存在的呼梯数量
+ * @param   [in] sched          调度器
+ * @param   [in] clock          定时器，到期回调必须是 elevator_group_expire
+ * @param   [in] floor_ticks    运行一层楼的时间
+ * @param   [in] stop_ticks     停靠的时间
+ * @param   [in] policy         分配策略
+ * @return  成功返回0，内存不足返回-1
+*/
+int elevator_group_init(stc_elevator_group_t *group, uint32_t ncars, uint32_t capacity, stc_fsm_sched_t *sched,
+                        const stc_fsm_clock_t *clock, uint32_t floor_ticks, uint32_t stop_ticks, group_policy_t policy);
+
+/**
+ * @brief   释放群控的内存
+*/
+void elevator_group_free(stc_elevator_group_t *group);
+
+/**
+ * @brief   呼梯
+ * @param   [in] origin 出发楼层
+ * @param   [in] dest   目标楼层
+ * @return  分配的电梯编号，楼层无效或者呼梯池已满返回-1
+*/
+int elevator_group_call(stc_elevator_group_t *group, int origin, int dest);
+
+/**
+ * @brief   定时器到期回调
+ * @param   [in] arg    电梯 stc_group_car_t
+ * @param   [in] data   定时器类型 en_timer_t
+*/
+void elevator_group_expire(void *arg, uint32_t data);
+
+#endif
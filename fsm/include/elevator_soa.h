@@ -0,0 +1,59 @@
+#ifndef ELEVATOR_SOA_H_
+#define ELEVATOR_SOA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "elevator.h"
+
+/**
+ * @brief   大规模电梯的批量仿真(结构数组)
+ * @note    所有电梯的状态、楼层、方向以及请求位图分别保存在连续的数组中(每部电梯16字节)，
+ *          每个tick用一个没有分支、没有间接调用的循环更新所有电梯，编译器可以向量化
+ * @note    转移以及动作的影响在初始化时由 elevator_def 的状态表以及 elevator_action_effect 生成，
+ *          条件的判断与 elevator_tick 以及 request_action 相同，状态表修改后不需要修改本模块
+ * @note    一个tick等于运行一层楼的时间(停靠时间相同)，tick 开始时登记的请求先处理，
+ *          再处理到期的定时器；与 elevator.c 的状态机由离散事件仿真按同样的顺序驱动时，
+ *          每个tick之后的状态、楼层、方向以及请求位图完全一致
+ * @note    不调用停靠回调；到达以及停靠结束时重新唤醒的 EVENT_REQUEST 在tick模型中不会发生
+*/
+
+// 批量仿真
+typedef struct
+{
+    size_t count;               // 电梯数量
+    uint32_t *state;            // 现态 en_state_t
+    uint32_t *floor;            // 楼层 - MIN_FLOOR
+    int32_t *dir;               // 最近一次的运行方向
+    uint32_t *pending;          // 请求的楼层位图
+    uint64_t stops;             // 已经服务的请求数(停靠以及到达)
+    // 由状态表生成的 [现态][条件] 次态以及动作的影响，最后一列是没有事件
+    uint8_t next[STATE_COUNT][EVENT_COUNT + 1];
+    uint8_t effect[STATE_COUNT][EVENT_COUNT + 1];
+}stc_elevator_soa_t;
+
+/**
+ * @brief   初始化，所有电梯空闲并停在0层
+ * @return  成功返回0，内存不足返回-1
+*/
+int elevator_soa_init(stc_elevator_soa_t *soa, size_t count);
+
+/**
+ * @brief   释放数组
+*/
+void elevator_soa_free(stc_elevator_soa_t *soa);
+
+/**
+ * @brief   登记请求的楼层，在下一次 elevator_soa_tick 时处理
+ * @note    调用者负责检查楼层范围
+*/
+static inline void elevator_soa_request(stc_elevator_soa_t *soa, size_t car, int floor)
+{
+    soa->pending[car] |= FLOOR_BIT(floor);
+}
+
+/**
+ * @brief   所有电梯前进一个tick
+*/
+void elevator_soa_tick(stc_elevator_soa_t *soa);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef FSM_CLOCK_H_
+#define FSM_CLOCK_H_
+
+#include <stdint.h>
+
+/**
+ * @brief   定时器接口
+ * @note    状态机的动作通过该接口启动定时器，不关心由时间轮(实时)还是离散事件仿真(虚拟时间)驱动，
+ *          同一份状态表以及动作可以在两种模式下运行
+ * @note    时间单位由实现决定: 时间轮为tick，仿真为虚拟纳秒
+*/
+typedef struct
+{
+    void *impl;                 // 时间轮或者仿真器
+    const uint64_t *now;        // 当前时间
+    /**
+     * @brief   启动定时器，到期时以 arg、data 调用实现的到期回调
+     * @return  成功返回0，失败返回-1
+    */
+    int (*start)(void *impl, uint64_t ticks, void *arg, uint32_t data);
+}stc_fsm_clock_t;
+
+#endif
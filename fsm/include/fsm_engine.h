@@ -0,0 +1,132 @@
+#ifndef FSM_ENGINE_H_
+#define FSM_ENGINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fsm_table.h"
+
+/**
+ * @brief   多实例状态机引擎
+ * @note    状态机定义(转移表)只读，由所有实例共享；每个实例只保存现态、上下文以及事件队列
+ * @note    每个实例有一个固定容量的无锁多生产者单消费者(MPSC)事件队列，
+ *          任何线程以及信号处理函数都可以投递事件
+ * @note    投递事件时实例被加入调度器的就绪链表，调度器线程批量取出就绪的实例并分派事件，
+ *          空闲的实例没有任何开销
+ * @note    实例不需要动态分配内存，可以直接定义为数组，每个实例的内存大小固定
+*/
+
+/**
+ * @brief   每个实例事件队列的容量(必须是2的幂)，队列满时投递失败
+*/
+#ifndef FSM_QUEUE_SIZE
+#define FSM_QUEUE_SIZE      8
+#endif
+
+/**
+ * @brief   调度器每次最多为同一个实例分派的事件数，剩余的事件留到下一轮
+*/
+#ifndef FSM_BATCH_SIZE
+#define FSM_BATCH_SIZE      16
+#endif
+
+// 状态机定义，dense 与 sparse 二选一
+typedef struct
+{
+    const stc_fsm_entry_t *dense;       // 稠密表 [nstates][nevents]
+    const stc_fsm_sparse_t *sparse;     // 稀疏表
+    uint32_t nstates;                   // 状态数量
+    uint32_t nevents;                   // 条件数量
+}stc_fsm_def_t;
+
+/**
+ * @brief   由 FSM_DENSE_TABLE 定义的稠密表生成状态机定义
+*/
+#define FSM_DEF_DENSE(table)                                                        \
+    { &(table)[0][0], NULL, sizeof(table) / sizeof((table)[0]),                     \
+      sizeof((table)[0]) / sizeof((table)[0][0]) }
+
+// 事件队列的槽位
+typedef struct
+{
+    uint32_t seq;           // 序号，判断槽位是否可写/可读
+    uint32_t event;         // 事件
+    uint64_t posted;        // 投递时间(纳秒)，调度器开启统计时按 sample_mask 抽样记录，
+                            // 始终保留，实例的内存布局与是否统计无关
+}stc_fsm_slot_t;
+
+typedef struct stc_fsm_sched stc_fsm_sched_t;
+typedef struct stc_fsm_stats stc_fsm_stats_t;
+typedef struct stc_fsm_log stc_fsm_log_t;
+
+// 状态机实例
+typedef struct stc_fsm_instance
+{
+    uint32_t state;                     // 现态
+    uint32_t scheduled;                 // 是否已经在就绪链表中
+    uint32_t head;                      // 队列读位置(调度器线程)
+    uint32_t tail;                      // 队列写位置(投递线程)
+    void *ctx;                          // 上下文，作为动作的参数
+    const stc_fsm_def_t *def;           // 状态机定义
+    stc_fsm_sched_t *sched;             // 所属的调度器
+    struct stc_fsm_instance *next;      // 就绪链表
+    uint64_t entered;                   // 进入现态的时间(统计停留时间)，0 表示未知
+    uint32_t id;                        // 实例编号(事件日志)，初始化为0，由应用设置
+    stc_fsm_slot_t slots[FSM_QUEUE_SIZE];
+}stc_fsm_instance_t;
+
+// 调度器
+struct stc_fsm_sched
+{
+    stc_fsm_instance_t *ready;          // 就绪链表(投递线程压入，调度器线程一次取出)
+    uint64_t dispatched;                // 产生转移的事件数
+    uint64_t ignored;                   // 没有转移的事件数
+    stc_fsm_stats_t *stats;             // 运行统计(fsm_stats.h)，NULL 表示不统计，分派之前设置
+    stc_fsm_log_t *log;                 // 事件日志(fsm_log.h)，NULL 表示不记录，分派之前设置
+};
+
+/**
+ * @brief   根据定义查找转移
+ * @return  表项，没有转移时返回NULL
+*/
+static inline const stc_fsm_entry_t *fsm_def_lookup(const stc_fsm_def_t *def, uint32_t state, uint32_t event)
+{
+    if (def->sparse != NULL)
+    {
+        return fsm_sparse_lookup(def->sparse, state, event);
+    }
+    const stc_fsm_entry_t *entry = &def->dense[(size_t)state * def->nevents + event];
+    return entry->next_state != FSM_NONE ? entry : NULL;
+}
+
+/**
+ * @brief   初始化调度器
+*/
+void fsm_sched_init(stc_fsm_sched_t *sched);
+
+/**
+ * @brief   初始化状态机实例
+ * @param   [out] fsm   状态机实例
+ * @param   [in]  def   状态机定义，在实例的整个生命周期内有效
+ * @param   [in]  sched 调度器
+ * @param   [in]  state 初始状态
+ * @param   [in]  ctx   上下文，作为动作的参数
+*/
+void fsm_instance_init(stc_fsm_instance_t *fsm, const stc_fsm_def_t *def, stc_fsm_sched_t *sched,
+                       uint32_t state, void *ctx);
+
+/**
+ * @brief   投递事件
+ * @note    可以在任意线程或者信号处理函数中调用，不加锁
+ * @return  成功返回0，队列已满返回-1
+*/
+int fsm_post(stc_fsm_instance_t *fsm, uint32_t event);
+
+/**
+ * @brief   分派所有就绪实例的事件
+ * @note    只能由一个线程调用；一次取出整个就绪链表，按投递顺序处理，
+ *          每个实例最多分派 FSM_BATCH_SIZE 个事件
+ * @return  本轮处理的事件数
+*/
+size_t fsm_sched_run(stc_fsm_sched_t *sched);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FSM_HIST_H_
+#define FSM_HIST_H_
+
+#include <stdint.h>
+
+/**
+ * @brief   延迟直方图(HDR风格)
+ * @note    按2的幂分组，每组再线性分为 2^FSM_HIST_SUB_BITS 个桶，
+ *          任意数值的相对误差不超过 1/2^FSM_HIST_SUB_BITS，覆盖整个 uint64_t 范围
+ * @note    记录只有几次整数运算以及一次数组加法，没有分支预测失败以及内存分配
+*/
+
+// 每组的桶数 = 2^FSM_HIST_SUB_BITS
+#define FSM_HIST_SUB_BITS   4
+#define FSM_HIST_SUB        (1u << FSM_HIST_SUB_BITS)
+// 总桶数
+#define FSM_HIST_BUCKETS    ((64 - FSM_HIST_SUB_BITS + 1) * FSM_HIST_SUB)
+
+typedef struct
+{
+    uint64_t count;         // 样本数
+    uint64_t sum;           // 样本总和
+    uint64_t min;           // 最小值
+    uint64_t max;           // 最大值
+    uint64_t buckets[FSM_HIST_BUCKETS];
+}stc_fsm_hist_t;
+
+/**
+ * @brief   数值对应的桶
+*/
+static inline uint32_t fsm_hist_index(uint64_t v)
+{
+    if (v < FSM_HIST_SUB)
+    {
+        return (uint32_t)v;
+    }
+    uint32_t exp = 63 - (uint32_t)__builtin_clzll(v);
+    uint32_t sub = (uint32_t)(v >> (exp - FSM_HIST_SUB_BITS)) & (FSM_HIST_SUB - 1);
+    return (exp - FSM_HIST_SUB_BITS + 1) * FSM_HIST_SUB + sub;
+}
+
+/**
+ * @brief   记录一个样本
+*/
+static inline void fsm_hist_add(stc_fsm_hist_t *hist, uint64_t v)
+{
+    hist->count++;
+    hist->sum += v;
+    hist->min = v < hist->min ? v : hist->min;
+    hist->max = v > hist->max ? v : hist->max;
+    hist->buckets[fsm_hist_index(v)]++;
+}
+
+/**
+ * @brief   清空直方图
+*/
+void fsm_hist_init(stc_fsm_hist_t *hist);
+
+/**
+ * @brief   把 src 累加到 dst
+*/
+void fsm_hist_merge(stc_fsm_hist_t *dst, const stc_fsm_hist_t *src);
+
+/**
+ * @brief   桶的下界
+*/
+uint64_t fsm_hist_bucket_low(uint32_t index);
+
+/**
+ * @brief   计算百分位数
+ * @param   [in] p  百分位(0~100)
+ * @return  对应桶的中间值，没有样本时返回0
+*/
+uint64_t fsm_hist_percentile(const stc_fsm_hist_t *hist, double p);
+
+/**
+ * @brief   平均值，没有样本时返回0
+*/
+double fsm_hist_mean(const stc_fsm_hist_t *hist);
+
+#endif
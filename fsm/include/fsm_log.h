@@ -0,0 +1,124 @@
+#ifndef FSM_LOG_H_
+#define FSM_LOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fsm_engine.h"
+
+/**
+ * @brief   事件日志的记录以及回放
+ * @note    日志是只追加的二进制文件: 文件头 + 固定长度(16字节)的记录，记录分为两类:
+ *          1. 输入: 应用从外部收到的输入(例如请求的楼层、定时器到期)，来源以及数据由应用定义
+ *          2. 分派: 调度器分派的每个事件，包括实例编号、事件、现态以及次态(没有转移时为 FSM_LOG_NONE)
+ * @note    记录时调度器的 sched->log 指向打开的日志，分派时自动追加；输入由应用调用 fsm_log_input 追加。
+ *          记录先写入缓冲区，满了以后一次 write 追加到文件
+ * @note    回放时按顺序把输入交给应用的回调(回调重新投递事件)，遇到分派记录时运行调度器，
+ *          分派的每个事件与日志中的分派记录逐条比较；虚拟时间为记录的时间，不等待
+ * @note    应用在回放时不能再启动真实的定时器，定时器到期作为输入记录，按记录的顺序回放
+*/
+
+// 分派记录的来源
+#define FSM_LOG_DISPATCH    0
+// 没有转移时的次态
+#define FSM_LOG_NONE        UINT8_MAX
+// 文件头的标识以及版本
+#define FSM_LOG_MAGIC       0x474f4c4d5346ull   // "FSMLOG"
+#define FSM_LOG_VERSION     1
+// 写缓冲区的记录数
+#define FSM_LOG_BUFFER      4096
+
+// 一条记录
+typedef struct
+{
+    uint64_t time;          // 时间(纳秒)，从开始记录算起
+    uint32_t data;          // 分派: 实例编号；输入: 应用定义的数据
+    uint8_t source;         // FSM_LOG_DISPATCH 或者应用定义的输入来源(1~255)
+    uint8_t event;          // 分派: 事件
+    uint8_t before;         // 分派: 现态
+    uint8_t after;          // 分派: 次态，没有转移时为 FSM_LOG_NONE
+}stc_fsm_log_record_t;
+
+// 文件头
+typedef struct
+{
+    uint64_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint16_t nstates;       // 状态机定义的状态数量，回放时检查
+    uint16_t nevents;       // 状态机定义的事件数量
+}stc_fsm_log_header_t;
+
+// 日志
+struct stc_fsm_log
+{
+    int fd;                             // 记录的文件，回放时为-1
+    const uint64_t *now;                // 虚拟时间，NULL 时使用单调时钟
+    uint64_t base;                      // 单调时钟的起点
+    uint32_t count;                     // 缓冲区中的记录数
+    uint64_t written;                   // 已经追加的记录数(包括缓冲区)
+    int error;                          // 写入失败
+    // 回放
+    void *map;                          // 映射的日志文件
+    size_t map_size;
+    const stc_fsm_log_record_t *records;    // 日志中的记录
+    size_t nrecords;                    // 记录数
+    size_t next;                        // 下一条待比较的记录
+    uint64_t checked;                   // 比较过的分派
+    uint64_t mismatches;                // 不一致的分派
+    size_t first_mismatch;              // 第一条不一致的记录，没有时为 nrecords
+    stc_fsm_log_record_t buffer[FSM_LOG_BUFFER];
+};
+
+/**
+ * @brief   创建日志文件并写入文件头(已经存在时清空)
+ * @param   [in] def    状态机定义，状态以及事件必须小于 255
+ * @return  成功返回0，失败返回-1(errno)
+*/
+int fsm_log_open(stc_fsm_log_t *log, const char *path, const stc_fsm_def_t *def);
+
+/**
+ * @brief   把缓冲区追加到文件
+ * @return  成功返回0，写入失败返回-1
+*/
+int fsm_log_flush(stc_fsm_log_t *log);
+
+/**
+ * @brief   追加缓冲区并关闭文件，回放之后解除日志文件的映射
+ * @return  成功返回0，期间有写入失败返回-1
+*/
+int fsm_log_close(stc_fsm_log_t *log);
+
+/**
+ * @brief   记录一个输入
+ * @param   [in] source 来源(1~255)
+ * @param   [in] data   数据
+*/
+void fsm_log_input(stc_fsm_log_t *log, uint8_t source, uint32_t data);
+
+/**
+ * @brief   记录或者比较一次分派(由调度器调用)
+ * @param   [in] next_state 次态，没有转移时为 FSM_NONE
+*/
+void fsm_log_dispatch(stc_fsm_log_t *log, const stc_fsm_instance_t *fsm, uint32_t event, uint32_t next_state);
+
+/**
+ * @brief   回放的输入回调
+ * @param   [in] ctx    fsm_log_replay 的参数
+ * @param   [in] record 输入记录，record->time 为当前的虚拟时间
+*/
+typedef void (*fsm_log_input_t)(void *ctx, const stc_fsm_log_record_t *record);
+
+/**
+ * @brief   回放日志
+ * @note    回放期间 sched->log 指向 log，结束后恢复；结果保存在 log 的 checked / mismatches / first_mismatch，
+ *          日志中多出(回放时没有分派)的分派记录计为不一致
+ * @note    结束后 log->records 仍然有效(可以查看不一致的记录)，由 fsm_log_close 解除映射
+ * @param   [out] log   回放状态
+ * @param   [in]  sched 调度器，实例的编号以及初始状态必须与记录时相同
+ * @param   [in]  input 输入回调
+ * @return  成功返回0，文件无法读取或者与状态机定义不匹配返回-1
+*/
+int fsm_log_replay(stc_fsm_log_t *log, const char *path, const stc_fsm_def_t *def, stc_fsm_sched_t *sched,
+                   fsm_log_input_t input, void *ctx);
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef FSM_LOOP_H_
+#define FSM_LOOP_H_
+
+#include <signal.h>
+#include <stdint.h>
+#include "fsm_engine.h"
+#include "fsm_hist.h"
+
+/**
+ * @brief   单线程事件循环
+ * @note    基于 epoll，输入(非阻塞的fd)、定时器(timerfd)以及信号(signalfd)都在同一个线程中处理，
+ *          不使用信号处理函数
+ * @note    每轮 epoll_wait 返回后先执行所有回调(回调中投递事件)，再由调度器分派事件，
+ *          状态转移以及动作都在循环线程中执行
+ * @note    统计定时器的延迟(实际处理时间 - 到期时间)以及事件延迟(fd就绪 - 状态转移完成)
+*/
+
+// 每轮 epoll_wait 最多返回的fd数
+#define FSM_LOOP_EVENTS     64
+
+typedef struct stc_fsm_loop stc_fsm_loop_t;
+typedef struct stc_fsm_io stc_fsm_io_t;
+
+/**
+ * @brief   fd 就绪回调
+ * @param   [in] io     注册的fd
+ * @param   [in] events epoll 事件 EPOLLxxx
+*/
+typedef void (*fsm_io_cb_t)(stc_fsm_io_t *io, uint32_t events);
+
+// 注册到事件循环的fd
+struct stc_fsm_io
+{
+    int fd;
+    fsm_io_cb_t cb;             // 就绪回调
+    void *arg;                  // 回调参数
+    stc_fsm_loop_t *loop;       // 所属的事件循环
+    int timer;                  // 是否是定时器
+    uint64_t deadline;          // 定时器的到期时间(CLOCK_MONOTONIC 纳秒)，0表示未启动
+    uint64_t interval;          // 周期定时器的周期(纳秒)，0表示单次定时器
+};
+
+// 事件循环
+struct stc_fsm_loop
+{
+    int epfd;
+    int running;
+    stc_fsm_sched_t *sched;     // 每轮分派事件的调度器
+    void (*round_cb)(stc_fsm_loop_t *loop); // 每轮分派结束后调用，可以为NULL
+    stc_fsm_hist_t timer_latency;   // 定时器延迟(纳秒)
+    stc_fsm_hist_t event_latency;   // 事件延迟(纳秒)
+};
+
+/**
+ * @brief   当前时间(CLOCK_MONOTONIC 纳秒)
+*/
+uint64_t fsm_loop_now(void);
+
+/**
+ * @brief   初始化事件循环
+ * @param   [in] sched  调度器
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_loop_init(stc_fsm_loop_t *loop, stc_fsm_sched_t *sched);
+
+/**
+ * @brief   关闭事件循环，不关闭注册的fd
+*/
+void fsm_loop_close(stc_fsm_loop_t *loop);
+
+/**
+ * @brief   注册fd
+ * @param   [in] events epoll 事件，例如 EPOLLIN
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_loop_add(stc_fsm_loop_t *loop, stc_fsm_io_t *io, int fd, uint32_t events, fsm_io_cb_t cb, void *arg);
+
+/**
+ * @brief   注销fd并关闭
+*/
+void fsm_loop_del(stc_fsm_io_t *io);
+
+/**
+ * @brief   创建一个定时器(timerfd)，到期时调用 cb
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_loop_timer_init(stc_fsm_loop_t *loop, stc_fsm_io_t *timer, fsm_io_cb_t cb, void *arg);
+
+/**
+ * @brief   启动单次定时器，已经启动时重新计时
+ * @param   [in] delay_ns   延迟(纳秒)，支持亚毫秒精度
+*/
+int fsm_loop_timer_start(stc_fsm_io_t *timer, uint64_t delay_ns);
+
+/**
+ * @brief   启动周期定时器，第一次在一个周期后到期
+ * @note    错过的周期合并为一次回调，按最后一次错过的到期时间计算延迟
+ * @param   [in] interval_ns    周期(纳秒)
+*/
+int fsm_loop_timer_periodic(stc_fsm_io_t *timer, uint64_t interval_ns);
+
+/**
+ * @brief   停止定时器
+*/
+int fsm_loop_timer_stop(stc_fsm_io_t *timer);
+
+/**
+ * @brief   通过 signalfd 接收信号
+ * @note    mask 中的信号在调用线程中被屏蔽，需要在创建其他线程之前调用
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_loop_signal_init(stc_fsm_loop_t *loop, stc_fsm_io_t *io, const sigset_t *mask, fsm_io_cb_t cb, void *arg);
+
+/**
+ * @brief   运行事件循环，直到调用 fsm_loop_stop
+ * @return  正常退出返回0，epoll 出错返回-1
+*/
+int fsm_loop_run(stc_fsm_loop_t *loop);
+
+/**
+ * @brief   在回调中调用，处理完本轮后退出事件循环
+*/
+void fsm_loop_stop(stc_fsm_loop_t *loop);
+
+#endif
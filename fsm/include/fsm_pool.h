@@ -0,0 +1,79 @@
+#ifndef FSM_POOL_H_
+#define FSM_POOL_H_
+
+#include <stdint.h>
+
+/**
+ * @brief   工作窃取线程池
+ * @note    用于运行大量互相独立的作业(例如每个作业仿真一栋楼)，作业以编号 [0, njobs) 表示
+ * @note    每个工作线程有一个 Chase-Lev 双端队列，作业开始前按编号连续均分到各个队列；
+ *          线程从自己队列的底部取作业，自己的队列空了之后从随机的其他线程的队列顶部窃取
+ * @note    工作线程绑定到进程可用的CPU上(线程多于CPU时循环绑定)，作业在执行的线程上分配并首次访问内存，
+ *          仿真的状态位于该线程所在的NUMA节点；作业开始之前被窃取，不会跨节点访问
+ * @note    作业回调带有工作线程编号，调用者按线程编号保存累加器，全部作业结束后合并，运行期间线程之间不共享写入的数据
+ * @note    作业分配到哪个线程不确定，需要确定性结果时，每个作业的随机数种子以及结果只能取决于作业编号，
+ *          按线程合并的累加器只能使用与顺序无关的运算(整数加法、直方图合并等)
+*/
+
+/**
+ * @brief   作业回调
+ * @param   [in] arg    fsm_pool_run 的参数
+ * @param   [in] worker 工作线程编号 [0, nworkers)
+ * @param   [in] job    作业编号
+*/
+typedef void (*fsm_pool_fn_t)(void *arg, uint32_t worker, uint64_t job);
+
+// 工作线程的双端队列以及统计，按缓存行对齐避免伪共享
+typedef struct
+{
+    int64_t top;                        // 窃取端(其他线程 CAS)
+    int64_t bottom;                     // 本线程端
+    uint64_t *jobs;                     // 环形缓冲区
+    uint64_t mask;                      // 容量 - 1
+    uint64_t rng;                       // 选择窃取对象的随机数
+    uint64_t executed;                  // 执行的作业数
+    uint64_t stolen;                    // 窃取的作业数
+    int cpu;                            // 绑定的CPU，-1 表示不绑定
+}__attribute__((aligned(64))) stc_fsm_pool_worker_t;
+
+// 线程池
+typedef struct
+{
+    uint32_t nworkers;                  // 工作线程数量(包括调用 fsm_pool_run 的线程)
+    stc_fsm_pool_worker_t *workers;
+    fsm_pool_fn_t fn;                   // 当前运行的作业
+    void *arg;
+    uint64_t remaining;                 // 尚未完成的作业数(原子)
+}stc_fsm_pool_t;
+
+/**
+ * @brief   初始化线程池
+ * @param   [in] nworkers   工作线程数量，0 表示进程可用的CPU数量
+ * @return  成功返回0，内存不足返回-1
+*/
+int fsm_pool_init(stc_fsm_pool_t *pool, uint32_t nworkers);
+
+/**
+ * @brief   释放线程池
+*/
+void fsm_pool_free(stc_fsm_pool_t *pool);
+
+/**
+ * @brief   并行运行 njobs 个作业，全部完成后返回
+ * @note    调用线程作为0号工作线程，其余线程在本次运行期间创建，创建失败的线程的作业由其他线程窃取
+ * @return  成功返回0，分配内存失败返回-1(没有运行任何作业)
+*/
+int fsm_pool_run(stc_fsm_pool_t *pool, uint64_t njobs, fsm_pool_fn_t fn, void *arg);
+
+/**
+ * @brief   由种子以及作业编号生成作业的随机数种子(splitmix64)，与线程数量无关
+*/
+static inline uint64_t fsm_pool_seed(uint64_t seed, uint64_t job)
+{
+    uint64_t z = seed + (job + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+#endif
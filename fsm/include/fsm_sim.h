@@ -0,0 +1,84 @@
+#ifndef FSM_SIM_H_
+#define FSM_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fsm_clock.h"
+#include "fsm_engine.h"
+
+/**
+ * @brief   离散事件仿真(虚拟时间)
+ * @note    定时器保存在按到期时间排序的二叉堆中，每次取出最早的定时器，虚拟时间直接跳到到期时间，
+ *          调用到期回调后由调度器分派本次投递的事件，动作中启动的定时器在分派时加入堆
+ * @note    到期时间相同的定时器按启动顺序处理，相同的输入得到相同的结果
+ * @note    不使用任何系统时钟以及 fd，可以在一个线程中运行大量独立的仿真
+*/
+
+/**
+ * @brief   到期回调
+ * @param   [in] arg    启动定时器时的参数
+ * @param   [in] data   启动定时器时的数据
+*/
+typedef void (*fsm_sim_cb_t)(void *arg, uint32_t data);
+
+// 堆中的定时器
+typedef struct
+{
+    uint64_t time;          // 到期时间
+    uint32_t seq;           // 启动顺序
+    uint32_t data;          // 回调数据
+    void *arg;              // 回调参数
+}stc_fsm_sim_event_t;
+
+// 仿真器
+typedef struct
+{
+    uint64_t now;                   // 虚拟时间
+    uint32_t seq;                   // 下一个定时器的启动顺序
+    uint32_t size;                  // 堆中的定时器数量
+    uint32_t capacity;              // 堆的容量，不够时加倍
+    stc_fsm_sim_event_t *heap;      // 二叉堆
+    fsm_sim_cb_t expire;            // 到期回调
+    stc_fsm_sched_t *sched;         // 每个定时器到期后分派事件的调度器，可以为NULL
+    uint64_t events;                // 已经处理的定时器数量
+}stc_fsm_sim_t;
+
+/**
+ * @brief   初始化仿真器，虚拟时间从0开始
+ * @param   [in] capacity   堆的初始容量
+ * @param   [in] sched      调度器
+ * @param   [in] expire     到期回调
+ * @return  成功返回0，内存不足返回-1
+*/
+int fsm_sim_init(stc_fsm_sim_t *sim, uint32_t capacity, stc_fsm_sched_t *sched, fsm_sim_cb_t expire);
+
+/**
+ * @brief   释放堆
+*/
+void fsm_sim_free(stc_fsm_sim_t *sim);
+
+/**
+ * @brief   启动定时器
+ * @param   [in] delay  延迟(虚拟时间)
+ * @return  成功返回0，内存不足返回-1
+*/
+int fsm_sim_start(stc_fsm_sim_t *sim, uint64_t delay, void *arg, uint32_t data);
+
+/**
+ * @brief   处理最早到期的一个定时器，并分派事件
+ * @return  处理了定时器返回1，没有定时器返回0
+*/
+int fsm_sim_step(stc_fsm_sim_t *sim);
+
+/**
+ * @brief   处理到期时间不超过 until 的所有定时器，之后虚拟时间等于 until
+ * @return  处理的定时器数量
+*/
+size_t fsm_sim_run(stc_fsm_sim_t *sim, uint64_t until);
+
+/**
+ * @brief   生成定时器接口
+*/
+void fsm_sim_clock(stc_fsm_sim_t *sim, stc_fsm_clock_t *clock);
+
+#endif
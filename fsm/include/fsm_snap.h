@@ -0,0 +1,220 @@
+#ifndef FSM_SNAP_H_
+#define FSM_SNAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "fsm_clock.h"
+#include "fsm_engine.h"
+#include "fsm_sim.h"
+#include "fsm_wheel.h"
+
+/**
+ * @brief   状态快照(检查点以及恢复)
+ * @note    快照文件: 文件头 + 若干段数据 + 段表，每段是同一类型、固定长度的记录，按8字节对齐；
+ *          状态机实例以及定时器使用本文件定义的记录，应用的状态(例如电梯的楼层、请求位图)使用 FSM_SNAP_USER 之后的类型
+ * @note    写入时先写临时文件，fsync 后重命名为快照文件，任何时候快照文件都是完整的旧快照或者新快照
+ * @note    检查点在 fork 出的子进程中写入: 子进程看到的是 fork 时刻的内存(写时复制)，
+ *          父进程只暂停 fork 的时间(复制页表)，之后继续运行，只有父进程之后修改的页才会被复制
+ * @note    恢复时 mmap 快照文件，直接读取映射中的记录，不需要解析或者重建
+*/
+
+// 文件头的标识以及版本
+#define FSM_SNAP_MAGIC      0x50414e534d5346ull     // "FSMSNAP"
+#define FSM_SNAP_VERSION    1
+// 一个快照最多的段数
+#define FSM_SNAP_SECTIONS   16
+// 写缓冲区的大小(字节)
+#define FSM_SNAP_BUFFER     65536
+
+// 段的类型
+enum
+{
+    FSM_SNAP_INSTANCES = 1,     // stc_fsm_snap_instance_t
+    FSM_SNAP_TIMERS,            // stc_fsm_snap_timer_t，按到期顺序
+    FSM_SNAP_USER = 256,        // 应用定义的类型从这里开始
+};
+
+// 文件头
+typedef struct
+{
+    uint64_t magic;
+    uint16_t version;
+    uint16_t nsections;         // 段数
+    uint32_t reserved;
+    uint64_t generation;        // 检查点的序号
+    uint64_t table;             // 段表的位置
+}stc_fsm_snap_header_t;
+
+// 段表的一项
+typedef struct
+{
+    uint32_t type;
+    uint32_t size;              // 每条记录的大小
+    uint64_t count;             // 记录数
+    uint64_t offset;            // 数据的位置
+}stc_fsm_snap_section_t;
+
+// 状态机实例的记录
+typedef struct
+{
+    uint32_t id;                        // 实例编号(fsm->id)
+    uint32_t state;                     // 现态
+    uint32_t npending;                  // 队列中尚未分派的事件数
+    uint32_t pending[FSM_QUEUE_SIZE];   // 按投递顺序
+}stc_fsm_snap_instance_t;
+
+// 定时器的记录
+typedef struct
+{
+    uint64_t remaining;         // 剩余时间(时间轮为tick，仿真为虚拟纳秒)
+    uint32_t id;                // 定时器参数对应的编号，由应用转换
+    uint32_t data;              // 回调数据
+}stc_fsm_snap_timer_t;
+
+// 写入中的快照
+typedef struct
+{
+    int fd;
+    int error;                          // 写入失败
+    uint64_t offset;                    // 文件中的写位置(包括缓冲区)
+    uint32_t nsections;
+    uint32_t used;                      // 缓冲区中的字节数
+    stc_fsm_snap_header_t header;
+    stc_fsm_snap_section_t sections[FSM_SNAP_SECTIONS];
+    char path[256];                     // 临时文件
+    char buffer[FSM_SNAP_BUFFER];
+}stc_fsm_snap_t;
+
+/**
+ * @brief   写入快照内容的回调，调用 fsm_snap_section / fsm_snap_put 等写入各段
+ * @return  成功返回0，失败返回-1
+*/
+typedef int (*fsm_snap_fill_t)(stc_fsm_snap_t *snap, void *ctx);
+
+// 映射的快照
+typedef struct
+{
+    void *map;
+    size_t size;
+    const stc_fsm_snap_header_t *header;
+    const stc_fsm_snap_section_t *sections;
+}stc_fsm_snap_map_t;
+
+// 后台检查点
+typedef struct
+{
+    const char *path;           // 快照文件
+    fsm_snap_fill_t fill;       // 写入快照内容
+    void *ctx;
+    pid_t child;                // 正在写入的子进程，0 表示没有
+    uint64_t generation;        // 已经开始的检查点数
+    uint64_t version;           // 最近一次检查点时应用的版本，版本没有变化时跳过
+    uint64_t written;           // 成功写入的检查点数
+    uint64_t failed;            // 失败的检查点数
+    uint64_t skipped;           // 上一个检查点没有写完或者状态没有变化而跳过的次数
+}stc_fsm_checkpoint_t;
+
+/**
+ * @brief   开始写入快照(写入 <path>.tmp)
+ * @return  成功返回0，失败返回-1(errno)
+*/
+int fsm_snap_begin(stc_fsm_snap_t *snap, const char *path, uint64_t generation);
+
+/**
+ * @brief   开始一段，之后用 fsm_snap_put 写入记录，下一段开始或者提交时结束
+*/
+int fsm_snap_section(stc_fsm_snap_t *snap, uint32_t type, uint32_t size);
+
+/**
+ * @brief   写入当前段的 count 条记录
+*/
+void fsm_snap_put(stc_fsm_snap_t *snap, const void *records, uint64_t count);
+
+/**
+ * @brief   写入状态机实例的记录(现态以及队列中的事件)，只能在分派线程或者子进程中调用
+*/
+void fsm_snap_put_instance(stc_fsm_snap_t *snap, const stc_fsm_instance_t *fsm);
+
+/**
+ * @brief   写入仿真器中所有定时器的一段(按到期顺序，到期时间相同时按启动顺序)
+ * @param   [in] id     把定时器参数转换为编号
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_snap_put_sim(stc_fsm_snap_t *snap, const stc_fsm_sim_t *sim, uint32_t (*id)(void *arg));
+
+/**
+ * @brief   写入时间轮中所有定时器的一段(按到期顺序)
+ * @param   [in] id     把定时器参数转换为编号
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_snap_put_wheel(stc_fsm_snap_t *snap, const stc_fsm_wheel_t *wheel, uint32_t (*id)(void *arg));
+
+/**
+ * @brief   写入段表以及文件头，fsync 后重命名为 path
+ * @return  成功返回0，期间有失败返回-1(删除临时文件，原来的快照不变)
+*/
+int fsm_snap_commit(stc_fsm_snap_t *snap, const char *path);
+
+/**
+ * @brief   同步写入一个快照
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_snap_write(const char *path, uint64_t generation, fsm_snap_fill_t fill, void *ctx);
+
+/**
+ * @brief   映射并检查快照文件
+ * @return  成功返回0，文件无法读取或者格式不正确返回-1
+*/
+int fsm_snap_open(stc_fsm_snap_map_t *map, const char *path);
+
+/**
+ * @brief   解除映射
+*/
+void fsm_snap_close(stc_fsm_snap_map_t *map);
+
+/**
+ * @brief   查找一段
+ * @param   [in]  size  记录的大小，与快照中的不同时视为不存在(格式不兼容)
+ * @param   [out] count 记录数
+ * @return  映射中的记录，不存在时返回NULL
+*/
+const void *fsm_snap_find(const stc_fsm_snap_map_t *map, uint32_t type, uint32_t size, uint64_t *count);
+
+/**
+ * @brief   恢复状态机实例
+ * @note    实例必须刚刚初始化(队列为空)，设置现态并按顺序重新投递队列中的事件
+ * @return  成功返回0，实例编号不同或者状态超出定义返回-1
+*/
+int fsm_snap_restore_instance(stc_fsm_instance_t *fsm, const stc_fsm_snap_instance_t *record);
+
+/**
+ * @brief   按记录的顺序重新启动快照中的定时器
+ * @note    仿真模式需要先恢复虚拟时间；到期时间相同的定时器按原来的顺序到期
+ * @param   [in] arg    把编号转换为定时器参数，返回NULL时跳过该定时器
+ * @return  成功返回0，没有定时器段或者启动失败返回-1
+*/
+int fsm_snap_restore_timers(const stc_fsm_snap_map_t *map, const stc_fsm_clock_t *clock,
+                            void *(*arg)(uint32_t id));
+
+/**
+ * @brief   初始化后台检查点
+*/
+void fsm_checkpoint_init(stc_fsm_checkpoint_t *cp, const char *path, fsm_snap_fill_t fill, void *ctx);
+
+/**
+ * @brief   开始一个后台检查点: fork 子进程写入快照，父进程立即返回
+ * @note    只能在分派线程中、没有分派事件时调用，子进程看到的状态是一致的
+ * @param   [in] version    应用的版本(例如分派的事件数)，与上一个检查点相同时跳过
+ * @return  开始返回0，跳过返回1，fork 失败返回-1
+*/
+int fsm_checkpoint_start(stc_fsm_checkpoint_t *cp, uint64_t version);
+
+/**
+ * @brief   等待正在写入的检查点
+ * @param   [in] block  是否阻塞
+ * @return  没有正在写入的检查点返回0，还在写入返回1
+*/
+int fsm_checkpoint_wait(stc_fsm_checkpoint_t *cp, int block);
+
+#endif
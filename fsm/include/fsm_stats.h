@@ -0,0 +1,98 @@
+#ifndef FSM_STATS_H_
+#define FSM_STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "fsm_engine.h"
+#include "fsm_hist.h"
+
+/**
+ * @brief   状态机运行统计
+ * @note    统计一个状态机定义的所有实例:
+ *          1. 每个 [现态][条件] 组合的次数(包括没有转移、被忽略的组合)
+ *          2. 每个状态的停留时间(进入状态到切换为其他状态，同一状态的自转移不重新计时，
+ *             实例第一次分派事件之前的时间不计入)
+ *          3. 每种事件从投递到执行动作的延迟
+ * @note    统计保存在调度器上(sched->stats)，由分派事件的线程单独写入，没有锁以及原子读改写；
+ *          每个分派线程使用自己的调度器以及统计，其他线程随时可以用 fsm_stats_merge 读取快照
+ *          (每个计数原子读取，快照中的不同计数之间不保证是同一时刻)
+ * @note    读取时钟的开销远大于计数(虚拟机中每次几十纳秒)，因此:
+ *          1. 延迟按实例队列的写位置抽样，每 sample_mask + 1 个事件记录一次投递以及分派的时间
+ *          2. 调度器每轮分派只读取一次时钟，作为本轮所有状态切换的时间，停留时间的精度为一轮分派的耗时
+ * @note    没有开启统计(sched->stats 为NULL)时只有一次判断；与统计定义不同的实例不统计
+*/
+
+/**
+ * @brief   延迟的默认抽样间隔(必须是2的幂)，初始化之后可以修改 sample_mask，0 表示每个事件都记录
+*/
+#ifndef FSM_STATS_SAMPLE
+#define FSM_STATS_SAMPLE    64
+#endif
+
+struct stc_fsm_stats
+{
+    const stc_fsm_def_t *def;           // 统计的状态机定义
+    const char *const *state_names;     // 状态名称，NULL 时输出编号
+    const char *const *event_names;     // 事件名称，NULL 时输出编号
+    uint32_t sample_mask;               // 延迟抽样: 队列写位置 & sample_mask 为0的事件
+    uint64_t *transitions;              // [现态][条件] 的次数
+    stc_fsm_hist_t *dwell;              // [状态] 停留时间(纳秒)
+    stc_fsm_hist_t *latency;            // [事件] 投递到执行动作的延迟(纳秒)
+};
+
+/**
+ * @brief   初始化统计
+ * @param   [in] def            状态机定义
+ * @param   [in] state_names    状态名称(def->nstates 个)，可以为NULL
+ * @param   [in] event_names    事件名称(def->nevents 个)，可以为NULL
+ * @return  成功返回0，内存不足返回-1
+*/
+int fsm_stats_init(stc_fsm_stats_t *stats, const stc_fsm_def_t *def, const char *const *state_names,
+                   const char *const *event_names);
+
+/**
+ * @brief   释放统计
+*/
+void fsm_stats_free(stc_fsm_stats_t *stats);
+
+/**
+ * @brief   当前时间(单调时钟，纳秒)
+*/
+uint64_t fsm_stats_now(void);
+
+/**
+ * @brief   记录分派的一个事件(由调度器调用)
+ * @param   [in] fsm        实例，dwell 起点保存在实例中
+ * @param   [in] event      事件
+ * @param   [in] next_state 次态，没有转移时为 FSM_NONE
+ * @param   [in] posted     投递时间，没有抽样时为0
+ * @param   [in] now        本轮分派的时间
+*/
+void fsm_stats_record(stc_fsm_stats_t *stats, stc_fsm_instance_t *fsm, uint32_t event, uint32_t next_state,
+                      uint64_t posted, uint64_t now);
+
+/**
+ * @brief   把 src 的快照累加到 dst(定义必须相同)
+ * @note    可以在任意线程中调用，src 的分派线程同时写入也不需要加锁；dst 不能同时被其他线程写入
+*/
+void fsm_stats_merge(stc_fsm_stats_t *dst, const stc_fsm_stats_t *src);
+
+/**
+ * @brief   清空统计，只能由分派线程或者在没有分派时调用
+*/
+void fsm_stats_reset(stc_fsm_stats_t *stats);
+
+/**
+ * @brief   以 Prometheus 文本格式输出
+ * @note    转移次数为 counter <prefix>_transitions_total{state,event,next}，
+ *          停留时间以及延迟为 summary <prefix>_dwell_seconds{state} / <prefix>_latency_seconds{event}，
+ *          分位数 0.5 / 0.9 / 0.99 / 0.999
+*/
+void fsm_stats_prometheus(const stc_fsm_stats_t *stats, FILE *out, const char *prefix);
+
+/**
+ * @brief   以 JSON 格式输出，时间单位为纳秒
+*/
+void fsm_stats_json(const stc_fsm_stats_t *stats, FILE *out);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef FSM_TABLE_H_
+#define FSM_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   状态转移表
+ * @note    转移规则用 X-macro 列表描述一次，同时生成:
+ *          1. 稠密表 [现态][条件]，查找只有一次下标访问
+ *          2. 规则数组，用于构建稀疏表或者线性查找
+ * @note    规则列表的格式: X(现态, 条件, 动作, 次态)，
+ *          不产生转移的组合写为 X(现态, 条件, NULL, FSM_NONE)
+ * @note    状态以及条件使用带哨兵的枚举，例如 STATE_COUNT / EVENT_COUNT，用于确定表的大小
+*/
+
+// 次态为 FSM_NONE 表示没有转移
+#define FSM_NONE            UINT32_MAX
+
+/**
+ * @brief   动作(回调函数)
+ * @param   [in/out] ctx    状态机实例的上下文
+*/
+typedef void (*fsm_action_t)(void *ctx);
+
+// 转移表的表项
+typedef struct
+{
+    fsm_action_t action;    // 动作
+    uint32_t next_state;    // 次态，FSM_NONE 表示没有转移
+}stc_fsm_entry_t;
+
+// 转移规则
+typedef struct
+{
+    uint32_t state;         // 现态
+    uint32_t event;         // 条件
+    fsm_action_t action;    // 动作
+    uint32_t next_state;    // 次态
+}stc_fsm_row_t;
+
+/************************** 编译期生成 *********************************/
+#define FSM_ROW_ID_(s, e, a, n)         fsm_row_##s##_##e,
+#define FSM_DENSE_ENTRY_(s, e, a, n)    [s][e] = { (a), (n) },
+#define FSM_ROW_(s, e, a, n)            { (s), (e), (a), (n) },
+
+/**
+ * @brief   定义稠密转移表
+ * @param   name    表名，类型为 const stc_fsm_entry_t name[nstates][nevents]
+ * @param   list    规则列表宏，list(X) 展开为所有规则
+ * @param   nstates 状态数量
+ * @param   nevents 条件数量
+ * @note    编译期检查:
+ *          1. 重复的 [现态][条件] 产生重复的枚举常量，编译失败
+ *          2. 规则数量必须等于 nstates * nevents，不允许遗漏任何组合
+ *          3. 超出范围的状态或者条件导致数组下标越界，编译失败
+*/
+#define FSM_DENSE_TABLE(name, list, nstates, nevents)                                           \
+    enum { list(FSM_ROW_ID_) name##_row_count };                                                \
+    _Static_assert(name##_row_count == (nstates) * (nevents),                                   \
+                   #name ": every [state][event] pair must be listed exactly once");            \
+    static const stc_fsm_entry_t name[nstates][nevents] = { list(FSM_DENSE_ENTRY_) }
+
+/**
+ * @brief   定义规则数组，类型为 const stc_fsm_row_t name[]
+*/
+#define FSM_ROWS(name, list)                                                                    \
+    static const stc_fsm_row_t name[] = { list(FSM_ROW_) }
+
+/**
+ * @brief   稠密表查找
+ * @return  表项，没有转移时返回NULL
+*/
+#define FSM_DENSE_LOOKUP(table, state, event)                                                   \
+    ((table)[state][event].next_state != FSM_NONE ? &(table)[state][event] : NULL)
+
+/************************** 稀疏表 *********************************/
+/**
+ * @brief   压缩的稀疏转移表(行位移压缩)
+ * @note    每个状态的一行按偏移 base[state] 叠放到同一个数组中，
+ *          check[base[state] + event] == state 时表项有效
+ * @note    查找仍然是 O(1)，内存与规则数量成正比，适用于大而稀疏的表
+*/
+typedef struct
+{
+    uint32_t nstates;       // 状态数量
+    uint32_t nevents;       // 条件数量
+    uint32_t size;          // check/entries 的长度
+    uint32_t *base;         // 每个状态的偏移
+    uint32_t *check;        // 表项所属的状态，FSM_NONE 表示空闲
+    stc_fsm_entry_t *entries;
+}stc_fsm_sparse_t;
+
+/**
+ * @brief   根据规则数组构建稀疏表
+ * @param   [out] table     稀疏表
+ * @param   [in]  rows      规则数组，次态为 FSM_NONE 的规则被忽略
+ * @param   [in]  count     规则数量
+ * @param   [in]  nstates   状态数量
+ * @param   [in]  nevents   条件数量
+ * @return  成功返回0，规则重复、超出范围或者内存不足返回-1
+*/
+int fsm_sparse_build(stc_fsm_sparse_t *table, const stc_fsm_row_t *rows, size_t count,
+                     uint32_t nstates, uint32_t nevents);
+
+/**
+ * @brief   释放稀疏表
+*/
+void fsm_sparse_free(stc_fsm_sparse_t *table);
+
+/**
+ * @brief   稀疏表查找
+ * @return  表项，没有转移时返回NULL
+*/
+static inline const stc_fsm_entry_t *fsm_sparse_lookup(const stc_fsm_sparse_t *table,
+                                                       uint32_t state, uint32_t event)
+{
+    uint32_t i = table->base[state] + event;
+    return table->check[i] == state ? &table->entries[i] : NULL;
+}
+
+/**
+ * @brief   线性查找规则数组(原来的遍历方式，用于对比)
+ * @return  规则，没有转移时返回NULL
+*/
+const stc_fsm_row_t *fsm_linear_lookup(const stc_fsm_row_t *rows, size_t count,
+                                       uint32_t state, uint32_t event);
+
+#endif
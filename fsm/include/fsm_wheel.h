@@ -0,0 +1,137 @@
+#ifndef FSM_WHEEL_H_
+#define FSM_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fsm_clock.h"
+#include "fsm_engine.h"
+#include "fsm_loop.h"
+
+/**
+ * @brief   分层时间轮
+ * @note    FSM_WHEEL_LEVELS 层，每层 FSM_WHEEL_SLOTS 个槽，第k层每个槽覆盖 SLOTS^k 个tick，
+ *          低层转完一圈时把高层对应槽中的定时器重新分配到低层
+ * @note    启动以及取消都是 O(1)：定时器在槽内用双向链表连接，链接使用32位下标
+ * @note    定时器节点在初始化时一次性分配，启动定时器不分配内存，每个定时器32字节
+ * @note    到期时调用 expire 回调，默认的 fsm_wheel_post 把事件投递给状态机实例
+ * @note    挂接到事件循环后由一个单次的 timerfd 驱动: 只在最早的到期时间(低层下一个非空的槽)唤醒，
+ *          低层在这一圈内没有定时器时在低层转完一圈时唤醒一次，把高层的定时器分配下来；没有定时器时停止 timerfd
+*/
+
+// 每层的槽数(位数)以及层数，可以表示 2^(BITS*LEVELS) 个tick
+#define FSM_WHEEL_BITS      8
+#define FSM_WHEEL_SLOTS     (1u << FSM_WHEEL_BITS)
+#define FSM_WHEEL_LEVELS    4
+
+// 空链接
+#define FSM_WHEEL_NIL       UINT32_MAX
+
+/**
+ * @brief   定时器句柄，高32位为代数，低32位为节点下标，0表示无效
+ * @note    节点被回收后代数加1，过期的句柄不会取消新的定时器
+*/
+typedef uint64_t fsm_timer_t;
+
+/**
+ * @brief   到期回调
+ * @param   [in] arg    启动定时器时的参数
+ * @param   [in] data   启动定时器时的数据
+*/
+typedef void (*fsm_wheel_cb_t)(void *arg, uint32_t data);
+
+// 定时器节点
+typedef struct
+{
+    uint32_t next;          // 槽内的下一个节点，空闲时为空闲链表的下一个节点
+    uint32_t prev;          // 槽内的上一个节点，FSM_WHEEL_NIL 表示是槽内第一个
+    uint16_t slot;          // 所在的槽(层 * SLOTS + 槽)，空闲时为 UINT16_MAX
+    uint16_t gen;           // 代数
+    uint32_t data;          // 回调数据
+    uint64_t expires;       // 到期的tick
+    void *arg;              // 回调参数
+}stc_fsm_timer_node_t;
+
+// 时间轮
+typedef struct
+{
+    uint64_t tick_ns;               // 每个tick的纳秒数
+    uint64_t base_ns;               // tick 0 对应的时间(CLOCK_MONOTONIC 纳秒)
+    uint64_t now;                   // 已经处理到的tick
+    uint32_t count;                 // 运行中的定时器数量
+    uint32_t capacity;              // 节点数量
+    uint32_t free;                  // 空闲链表
+    stc_fsm_timer_node_t *nodes;    // 节点池
+    fsm_wheel_cb_t expire;          // 到期回调
+    stc_fsm_io_t *io;               // 驱动时间轮的 timerfd，为NULL时由调用者推进
+    uint64_t armed;                 // timerfd 设定的tick，0表示没有设定
+    uint32_t slots[FSM_WHEEL_LEVELS * FSM_WHEEL_SLOTS];
+}stc_fsm_wheel_t;
+
+/**
+ * @brief   初始化时间轮
+ * @param   [in] capacity   最多同时运行的定时器数量
+ * @param   [in] tick_ns    每个tick的纳秒数
+ * @param   [in] expire     到期回调，为NULL时使用 fsm_wheel_post
+ * @return  成功返回0，内存不足返回-1
+*/
+int fsm_wheel_init(stc_fsm_wheel_t *wheel, uint32_t capacity, uint64_t tick_ns, fsm_wheel_cb_t expire);
+
+/**
+ * @brief   释放节点池
+*/
+void fsm_wheel_free(stc_fsm_wheel_t *wheel);
+
+/**
+ * @brief   挂接到事件循环
+ * @note    创建一个 timerfd，在下一个有定时器到期的tick触发，到期的定时器在循环线程中处理
+ * @return  成功返回0，失败返回-1
+*/
+int fsm_wheel_attach(stc_fsm_wheel_t *wheel, stc_fsm_loop_t *loop, stc_fsm_io_t *io);
+
+/**
+ * @brief   启动定时器
+ * @param   [in] ticks  延迟的tick数，至少为1，超出范围时取最大值
+ * @param   [in] arg    回调参数
+ * @param   [in] data   回调数据
+ * @return  定时器句柄，节点用完时返回0
+*/
+fsm_timer_t fsm_wheel_start(stc_fsm_wheel_t *wheel, uint64_t ticks, void *arg, uint32_t data);
+
+/**
+ * @brief   取消定时器
+ * @return  成功返回0，定时器已经到期或者句柄无效返回-1
+*/
+int fsm_wheel_cancel(stc_fsm_wheel_t *wheel, fsm_timer_t timer);
+
+/**
+ * @brief   推进到指定的tick，依次处理到期的定时器
+ * @return  到期的定时器数量
+*/
+size_t fsm_wheel_advance(stc_fsm_wheel_t *wheel, uint64_t tick);
+
+/**
+ * @brief   当前的tick
+ * @note    挂接到事件循环时按当前时间计算，timerfd 只在有定时器到期时唤醒，now 可能落后；
+ *          没有挂接时为 now
+*/
+uint64_t fsm_wheel_current(const stc_fsm_wheel_t *wheel);
+
+/**
+ * @brief   纳秒换算为tick数(向上取整)
+*/
+static inline uint64_t fsm_wheel_ticks(const stc_fsm_wheel_t *wheel, uint64_t ns)
+{
+    return (ns + wheel->tick_ns - 1) / wheel->tick_ns;
+}
+
+/**
+ * @brief   生成定时器接口，时间单位为tick
+*/
+void fsm_wheel_clock(stc_fsm_wheel_t *wheel, stc_fsm_clock_t *clock);
+
+/**
+ * @brief   默认的到期回调: 把 data 作为事件投递给状态机实例 arg
+*/
+void fsm_wheel_post(void *arg, uint32_t data);
+
+#endif
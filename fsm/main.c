@@ -1,7 +1,19 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include "debug_log.h"
+#include "elevator.h"
+#include "fsm_log.h"
+#include "fsm_loop.h"
+#include "fsm_sim.h"
+#include "fsm_snap.h"
+#include "fsm_stats.h"
+#include "fsm_wheel.h"
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <time.h>
 #include <unistd.h>
 
 /**********************************************************************************************
@@ -17,193 +29,689 @@
  * @param   next_state  次态
 ***********************************************************************************************/
 
+// 时间轮的tick(纳秒)，电梯运行时间按tick向上取整
+#define WHEEL_TICK_NS   100000u
+// 时间轮的定时器数量
+#define WHEEL_TIMERS    16
+
 // 项目名称
 #define PROJECT_NAME "\x1b[33m ____ ____ ____ \n||F |||S |||M ||\n||__|||__|||__||\n|/__\\|/__\\|/__\\|\n\x1b[0m"
-// 电梯底层
-#define MIN_FLOOR   -3
-// 电梯顶层
-#define MAX_FLOOR   20
-// 电梯运行一层楼梯所需要的时间(单位秒)
-#define RUN_TIME    1
 
-// 计算数组长度
-#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+// 调度器
+stc_fsm_sched_t sched;
+// 状态机运行统计(交互模式)
+stc_fsm_stats_t stats;
+// 电梯
+stc_elevator_t elevator;
+// 事件循环
+stc_fsm_loop_t loop;
+// 电梯运行定时器: 交互模式使用时间轮，仿真模式使用离散事件仿真
+stc_fsm_wheel_t wheel;
+stc_fsm_sim_t sim;
+stc_fsm_clock_t timer_clock;
+// 运行一层楼的定时器时间(时间轮为tick，仿真为纳秒)
+uint64_t run_ticks;
+// 标准输入、驱动时间轮的 timerfd、退出信号
+stc_fsm_io_t input_io;
+stc_fsm_io_t wheel_io;
+stc_fsm_io_t signal_io;
+// 运行一层楼的时间(纳秒)
+uint64_t run_time_ns = (uint64_t)RUN_TIME * 1000000000u;
+// 标准输入已经关闭，电梯空闲后退出
+bool input_closed = false;
+// 事件日志，recording 为NULL时不记录
+stc_fsm_log_t event_log;
+stc_fsm_log_t *recording = NULL;
 
-// 电梯状态
-typedef enum
-{
-    STATE_IDLE,
-    STATE_GOING_UP,
-    STATE_GOING_DOWN,
-}en_state_t;
+// 检查点: checkpoint_path 为NULL时不写，restore_path 为NULL时不恢复
+const char *checkpoint_path = NULL;
+const char *restore_path = NULL;
+stc_fsm_checkpoint_t checkpoint;
+// 仿真模式每完成 CHECKPOINT_STOPS 次停靠写一个后台检查点
+#ifndef CHECKPOINT_STOPS
+#define CHECKPOINT_STOPS    100000
+#endif
+// 快照中应用状态的段
+#define SNAP_APP            FSM_SNAP_USER
 
-// 电梯事件
-typedef enum
+// 快照中应用的状态
+typedef struct
 {
-    EVENT_UP,
-    EVENT_DOWN,
-    EVENT_ARRIVE
-}en_event_t;
+    uint64_t now;           // 仿真的虚拟时间
+    uint64_t events;        // 仿真处理的定时器数量
+    uint64_t rng;           // 仿真的随机数
+    uint64_t stops;         // 仿真的停靠次数
+    uint64_t checksum;      // 仿真的校验和
+    int32_t current_floor;
+    int32_t dir;
+    uint32_t pending;
+    int32_t departing;
+    uint32_t simulated;     // 1 表示仿真模式的快照
+    uint32_t wake_pending;  // 唤醒事件投递失败，等待重新投递
+}stc_app_snap_t;
 
-// 状态机
-typedef struct
+// 事件日志的输入来源
+enum
 {
-    // FSM成员变量
-    en_state_t state;       // 现态
-    en_event_t event;       // 条件
-    void (*action)(int *);  // 动作
-    en_state_t next_state;  // 次态
-}stc_fsm_t;
+    LOG_SRC_INPUT = 1,      // 输入的楼层(request_floor)
+    LOG_SRC_REQUEST,        // 仿真模式的请求(elevator_request)
+    LOG_SRC_TIMER,          // 定时器到期(elevator_tick)
+};
 
-// 上升动作
-void go_up_action(int *floor)
+/**
+ * @brief   启动运行一层楼或者停靠的定时器，停靠的时间与运行一层楼相同
+*/
+void start_timer(stc_elevator_t *elevator, en_timer_t timer)
 {
-    DBG_LOGI("\t🔼 Going UP, current_floor = %d", *floor);
-    // 启动定时器(启动电梯)
-    alarm(RUN_TIME);
-    (*floor)++;
+    timer_clock.start(timer_clock.impl, run_ticks, elevator, timer);
 }
 
-// 下降动作
-void go_down_action(int *floor)
+/**
+ * @brief   定时器回调函数
+ * @note    用于模拟电梯运行时需要的时间，事件在本轮回调结束后由事件循环分派
+*/
+void timer_callback(void *arg, uint32_t data)
 {
-    DBG_LOGI("\t🔽 Going DOWN, current_floor = %d", *floor);
-    // 启动定时器(启动电梯)
-    alarm(RUN_TIME);
-    (*floor)--;
+    if (recording != NULL)
+    {
+        fsm_log_input(recording, LOG_SRC_TIMER, data);
+    }
+    elevator_tick(arg);
 }
 
-// 到达指定楼层动作
-void arrive_action(int *floor)
+/**
+ * @brief   每轮事件分派之后调用
+ * @note    重新投递失败的唤醒事件；电梯停下时提示输入，输入已经关闭时退出
+*/
+void round_callback(stc_fsm_loop_t *loop)
 {
-    DBG_LOGI("\t⏸  === Arrived target floor: %d", *floor);
+    static en_state_t last_state = STATE_IDLE;
+    elevator_wake(&elevator);
+    en_state_t state = (en_state_t)elevator.fsm.state;
+    if (state == STATE_IDLE && last_state != STATE_IDLE)
+    {
+        DBG_LOGI("Waiting for new target floor: ");
+    }
+    last_state = state;
+    if (state == STATE_IDLE && input_closed && __atomic_load_n(&elevator.pending, __ATOMIC_ACQUIRE) == 0)
+    {
+        fsm_loop_stop(loop);
+    }
 }
 
-// 状态表
-stc_fsm_t fsm_map[] = 
+/**
+ * @brief   处理一个目标楼层
+ * @note    电梯运行中的请求登记到请求位图，按运行方向依次停靠
+*/
+void request_floor(int floor)
 {
-    {STATE_IDLE,        EVENT_UP,           go_up_action,   STATE_GOING_UP},
-    {STATE_GOING_UP,    EVENT_ARRIVE,       arrive_action,  STATE_IDLE},
-    {STATE_IDLE,        EVENT_DOWN,         go_down_action, STATE_GOING_DOWN},
-    {STATE_GOING_DOWN,  EVENT_ARRIVE,       arrive_action,  STATE_IDLE},
-};
+    if (recording != NULL)
+    {
+        fsm_log_input(recording, LOG_SRC_INPUT, (uint32_t)floor);
+    }
+    // 值域判断
+    if (floor < MIN_FLOOR || floor > MAX_FLOOR)
+    {
+        DBG_LOGW(" Target Floor [%d] out of range", floor);
+        return;
+    }
+    // 空闲时的同一楼层
+    if (elevator.fsm.state == STATE_IDLE && floor == elevator.current_floor)
+    {
+        DBG_LOGI("You already in floor %d, elevator will not run", floor);
+        return;
+    }
+    DBG_LOGI("######## Target floor is %d", floor);
+    if (elevator_request(&elevator, floor) != 0)
+    {
+        DBG_LOGW("Not found valid fsm");
+    }
+}
 
 /**
- * @brief   根据状态机 [现态] 以及 [条件] 尝试查询并保存 [次态] 以及 [动作]
- * @param   [in/out] fsm    实时状态机指针
- * @return  是否找到相同的现态以及条件 
+ * @brief   标准输入回调函数
+ * @note    非阻塞读取，按行解析楼层，不完整的行保留到下一次
 */
-bool traverse_fsm_map(stc_fsm_t *fsm)
+void input_callback(stc_fsm_io_t *io, uint32_t events)
 {
-    // 遍历状态表
-    for (size_t i = 0; i < ARRAY_SIZE(fsm_map); i++)
+    static char line[256];
+    static size_t len = 0;
+    (void)events;
+    for (;;)
     {
-        // [现态] 以及 [条件] 均满足
-        if (fsm->state == fsm_map[i].state && fsm->event == fsm_map[i].event)
+        ssize_t n = read(io->fd, line + len, sizeof(line) - 1 - len);
+        if (n < 0)
+        {
+            return;
+        }
+        if (n == 0)
+        {
+            // 输入结束，处理最后一行
+            line[len] = '\n';
+            n = 1;
+            fsm_loop_del(io);
+            input_closed = true;
+        }
+        len += (size_t)n;
+        char *begin = line;
+        char *end;
+        while ((end = memchr(begin, '\n', len - (size_t)(begin - line))) != NULL)
+        {
+            *end = '\0';
+            char *stop;
+            long floor = strtol(begin, &stop, 10);
+            if (stop != begin)
+            {
+                request_floor((int)floor);
+            }
+            begin = end + 1;
+        }
+        len -= (size_t)(begin - line);
+        memmove(line, begin, len);
+        if (len == sizeof(line) - 1)
         {
-            // 保存次态
-            fsm->next_state = fsm_map[i].next_state;
-            // 保存动作(保存回调函数)
-            fsm->action = fsm_map[i].action;
-            // 找到返回true, 结束循环
-            return true;
+            // 超长的行直接丢弃
+            len = 0;
+        }
+        if (input_closed)
+        {
+            return;
         }
     }
-    // 没有找到则返回false
-    return false;
 }
 
+// 仿真模式: 停靠次数以及停靠楼层序列的校验和
+uint64_t sim_stops;
+uint64_t sim_checksum;
+// 仿真模式: 随机数的状态以及是否为仿真模式
+uint64_t sim_rng;
+bool simulated = false;
 
-// 初始化状态机
-stc_fsm_t fsm = {0};
-// 当前楼层
-int current_floor = 0;
-// 目标楼层
-int target_floor = 0;
+/**
+ * @brief   定时器参数与快照中编号的转换，只有一部电梯
+*/
+uint32_t timer_id(void *arg)
+{
+    (void)arg;
+    return 0;
+}
+
+void *timer_arg(uint32_t id)
+{
+    return id == 0 ? &elevator : NULL;
+}
 
 /**
- * @brief   定时器回调函数
- * @note    用于模拟电梯运行时需要的时间
+ * @brief   写入快照: 应用的状态、状态机实例以及定时器
+ * @note    在检查点的子进程中调用，读取的是 fork 时刻的状态
+*/
+int snapshot_fill(stc_fsm_snap_t *snap, void *ctx)
+{
+    (void)ctx;
+    stc_app_snap_t app = {
+        .now = simulated ? sim.now : 0,
+        .events = simulated ? sim.events : 0,
+        .rng = sim_rng,
+        .stops = sim_stops,
+        .checksum = sim_checksum,
+        .current_floor = elevator.current_floor,
+        .dir = elevator.dir,
+        .pending = __atomic_load_n(&elevator.pending, __ATOMIC_ACQUIRE),
+        .departing = elevator.departing,
+        .simulated = simulated,
+        .wake_pending = __atomic_load_n(&elevator.wake_pending, __ATOMIC_ACQUIRE),
+    };
+    if (fsm_snap_section(snap, SNAP_APP, sizeof(app)) != 0)
+    {
+        return -1;
+    }
+    fsm_snap_put(snap, &app, 1);
+    if (fsm_snap_section(snap, FSM_SNAP_INSTANCES, sizeof(stc_fsm_snap_instance_t)) != 0)
+    {
+        return -1;
+    }
+    fsm_snap_put_instance(snap, &elevator.fsm);
+    return simulated ? fsm_snap_put_sim(snap, &sim, timer_id) : fsm_snap_put_wheel(snap, &wheel, timer_id);
+}
+
+/**
+ * @brief   从快照恢复电梯、状态机实例以及定时器
+ * @note    电梯刚刚初始化，定时器已经可以启动(仿真已经初始化或者时间轮已经挂接到事件循环)
+ * @return  成功返回0，失败返回-1
 */
-void timer_callback(int signum)
+int snapshot_restore(const char *path)
 {
-    if (fsm.state != STATE_IDLE) // 运行中
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    stc_fsm_snap_map_t map;
+    if (fsm_snap_open(&map, path) != 0)
+    {
+        perror(path);
+        return -1;
+    }
+    uint64_t napp;
+    uint64_t ninstances;
+    const stc_app_snap_t *app = fsm_snap_find(&map, SNAP_APP, sizeof(stc_app_snap_t), &napp);
+    const stc_fsm_snap_instance_t *instances = fsm_snap_find(&map, FSM_SNAP_INSTANCES,
+                                                             sizeof(stc_fsm_snap_instance_t), &ninstances);
+    int ret = -1;
+    if (app == NULL || napp != 1 || instances == NULL || ninstances != 1 || app->simulated != simulated
+        || app->current_floor < MIN_FLOOR || app->current_floor > MAX_FLOOR)
     {
-        if (current_floor == target_floor) // 到达指定楼层
+        fprintf(stderr, "%s: incompatible snapshot\n", path);
+    }
+    else
+    {
+        elevator.current_floor = app->current_floor;
+        elevator.dir = app->dir;
+        elevator.pending = app->pending;
+        elevator.departing = app->departing;
+        elevator.wake_pending = app->wake_pending;
+        sim_rng = app->rng;
+        sim_stops = app->stops;
+        sim_checksum = app->checksum;
+        if (simulated)
         {
-            fsm.event = EVENT_ARRIVE;
+            sim.now = app->now;
+            sim.events = app->events;
         }
-        // 查询状态表
-        if (traverse_fsm_map(&fsm))
+        if (fsm_snap_restore_instance(&elevator.fsm, &instances[0]) != 0
+            || fsm_snap_restore_timers(&map, &timer_clock, timer_arg) != 0)
         {
-            // 执行动作
-            fsm.action(&current_floor);
-            // 切换状态
-            fsm.state = fsm.next_state;
+            fprintf(stderr, "%s: invalid instance or timers\n", path);
         }
-        else // 如果找不到新的状态则循环执行当前动作
+        else
         {
-            fsm.action(&current_floor);
+            // 快照时唤醒事件投递失败，重新投递，否则有请求的电梯一直空闲
+            elevator_wake(&elevator);
+            ret = 0;
         }
     }
-    if (fsm.state == STATE_IDLE)
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (ret == 0)
     {
-        DBG_LOGI("Waiting for new target floor: ");
+        printf("restored generation %llu from %s in %.3f ms: floor %d, state %s\n",
+               (unsigned long long)map.header->generation, path,
+               ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e6, elevator.current_floor,
+               elevator_state_names[elevator.fsm.state]);
     }
+    fsm_snap_close(&map);
+    return ret;
 }
 
-int main(void)
+/**
+ * @brief   开始一个后台检查点，返回父进程暂停的时间(纳秒)
+*/
+uint64_t checkpoint_start(uint64_t version)
 {
-    printf("%s\n", PROJECT_NAME);
-    DBG_LOGI("The Elevator floor range : [%d] to [%d]", MIN_FLOOR, MAX_FLOOR);
-    DBG_LOGI("Current_floor = %d", current_floor);
-    DBG_LOGI("Waiting for new target floor: ");
-    // 设置定时器回调处理函数
-    signal(SIGALRM, timer_callback);
-    int floor = 0;
-    while (1)
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (fsm_checkpoint_start(&checkpoint, version) < 0)
+    {
+        perror("checkpoint");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (uint64_t)((t1.tv_sec - t0.tv_sec) * 1000000000ll + (t1.tv_nsec - t0.tv_nsec));
+}
+
+/**
+ * @brief   等待后台检查点，再同步写入最终的快照
+*/
+void checkpoint_finish(void)
+{
+    fsm_checkpoint_wait(&checkpoint, 1);
+    if (fsm_snap_write(checkpoint_path, checkpoint.generation, snapshot_fill, NULL) != 0)
+    {
+        perror(checkpoint_path);
+        return;
+    }
+    printf("checkpoint %s: generation %llu, %llu background written, %llu skipped, %llu failed\n",
+           checkpoint_path, (unsigned long long)checkpoint.generation, (unsigned long long)checkpoint.written,
+           (unsigned long long)checkpoint.skipped, (unsigned long long)checkpoint.failed);
+}
+
+/**
+ * @brief   信号回调函数
+ * @note    SIGUSR1 以 Prometheus 文本格式输出统计到标准错误，SIGUSR2 写后台检查点，其他信号退出
+*/
+void signal_callback(stc_fsm_io_t *io, uint32_t events)
+{
+    (void)events;
+    struct signalfd_siginfo info;
+    if (read(io->fd, &info, sizeof(info)) != sizeof(info))
+    {
+        return;
+    }
+    if (info.ssi_signo == SIGUSR1)
     {
-        scanf("%d", &floor);
-        // 电梯判忙
-        if (fsm.state != STATE_IDLE)
+        fsm_stats_prometheus(&stats, stderr, "elevator");
+        return;
+    }
+    if (info.ssi_signo == SIGUSR2)
+    {
+        if (checkpoint_path != NULL)
         {
-            DBG_LOGW("Elevator is running, ignore this command");
-            continue;
+            checkpoint_start(sched.dispatched + sched.ignored);
         }
-        // 值域判断
-        if (floor < MIN_FLOOR || floor > MAX_FLOOR)
+        return;
+    }
+    fsm_loop_stop(io->loop);
+}
+
+/**
+ * @brief   输出延迟统计(微秒)
+*/
+void print_latency(const char *name, const stc_fsm_hist_t *hist)
+{
+    DBG_LOGI("%s latency: count %llu, avg %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us", name,
+             (unsigned long long)hist->count, fsm_hist_mean(hist) / 1000.0,
+             fsm_hist_percentile(hist, 50) / 1000.0, fsm_hist_percentile(hist, 99) / 1000.0,
+             hist->count ? hist->max / 1000.0 : 0.0);
+}
+
+/**
+ * @brief   仿真模式的停靠回调
+*/
+void sim_stop(stc_elevator_t *elevator)
+{
+    sim_stops++;
+    sim_checksum = sim_checksum * 31 + (uint64_t)(elevator->current_floor - MIN_FLOOR);
+}
+
+/**
+ * @brief   仿真模式
+ * @note    与交互模式使用相同的状态表以及动作，定时器由离散事件仿真驱动，虚拟时间直接跳到下一个定时器，
+ *          关闭动作中的打印
+ * @note    电梯空闲时随机请求1~3个楼层(运行中的请求合并、沿途停靠)，直到完成 trips 次停靠；
+ *          相同的 seed 输出相同的校验和，用于回归测试
+ * @note    写检查点时每 CHECKPOINT_STOPS 次停靠 fork 一个后台检查点，结束时同步写入最终快照；
+ *          从快照恢复后继续运行到 trips 次停靠，校验和与不中断的运行相同
+*/
+int sim_main(uint64_t trips, uint64_t seed)
+{
+    if (fsm_sim_init(&sim, 4, &sched, timer_callback) != 0)
+    {
+        perror("sim");
+        return 1;
+    }
+    fsm_sim_clock(&sim, &timer_clock);
+    run_ticks = run_time_ns;
+    // 日志使用虚拟时间
+    event_log.now = &sim.now;
+    elevator.stop = sim_stop;
+    dbg_log_threshold = 0;
+    simulated = true;
+    sim_rng = seed * 0x9e3779b97f4a7c15ull + 1;
+    if (restore_path != NULL && snapshot_restore(restore_path) != 0)
+    {
+        return 1;
+    }
+    // 从快照恢复的停靠次数不计入速度
+    uint64_t stops_at_start = sim_stops;
+    uint64_t next_checkpoint = sim_stops + CHECKPOINT_STOPS;
+    uint64_t pause_max = 0;
+    uint64_t pause_sum = 0;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (sim_stops < trips)
+    {
+        // 每次循环开始时调度器已经空闲，状态是一致的
+        if (checkpoint_path != NULL && sim_stops >= next_checkpoint)
+        {
+            uint64_t pause = checkpoint_start(sim.events);
+            pause_max = pause > pause_max ? pause : pause_max;
+            pause_sum += pause;
+            next_checkpoint += CHECKPOINT_STOPS;
+        }
+        if (elevator.fsm.state == STATE_IDLE && __atomic_load_n(&elevator.pending, __ATOMIC_ACQUIRE) == 0)
+        {
+            uint64_t rng = sim_rng;
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            sim_rng = rng;
+            for (uint64_t n = 1 + (rng >> 62) % 3, r = rng; n > 0; n--, r /= FLOOR_COUNT)
+            {
+                int floor = MIN_FLOOR + (int)(r % FLOOR_COUNT);
+                if (floor != elevator.current_floor)
+                {
+                    if (recording != NULL)
+                    {
+                        fsm_log_input(recording, LOG_SRC_REQUEST, (uint32_t)floor);
+                    }
+                    elevator_request(&elevator, floor);
+                }
+            }
+            while (fsm_sched_run(&sched) > 0);
+        }
+        if (!fsm_sim_step(&sim) && elevator.fsm.state == STATE_IDLE
+            && __atomic_load_n(&elevator.pending, __ATOMIC_ACQUIRE) != 0)
+        {
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    printf("simulated %llu stops, %llu timer events, %.1f virtual hours in %.3f s (%.0f stops/s)\n",
+           (unsigned long long)sim_stops, (unsigned long long)sim.events, sim.now / 3.6e12, wall,
+           (sim_stops - stops_at_start) / wall);
+    printf("final floor %d, checksum %016llx\n", elevator.current_floor, (unsigned long long)sim_checksum);
+    if (checkpoint_path != NULL)
+    {
+        if (checkpoint.generation != 0)
         {
-            DBG_LOGW(" Target Floor [%d] out of range", floor);
-            continue;
+            printf("checkpoint fork pause: avg %.1f us, max %.1f us\n", pause_sum / 1e3 / checkpoint.generation,
+                   pause_max / 1e3);
         }
-        // 同一楼层
-        if (floor == current_floor)
+        checkpoint_finish();
+    }
+    fsm_sim_free(&sim);
+    return 0;
+}
+
+/**
+ * @brief   回放时不启动定时器，定时器到期来自日志
+*/
+void replay_timer(stc_elevator_t *elevator, en_timer_t timer)
+{
+    (void)elevator;
+    (void)timer;
+}
+
+/**
+ * @brief   回放日志中的一个输入
+*/
+void replay_input(void *ctx, const stc_fsm_log_record_t *record)
+{
+    (void)ctx;
+    switch (record->source)
+    {
+    case LOG_SRC_INPUT:
+        request_floor((int)record->data);
+        break;
+    case LOG_SRC_REQUEST:
+        elevator_request(&elevator, (int)record->data);
+        break;
+    case LOG_SRC_TIMER:
+        elevator_tick(&elevator);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief   回放模式
+ * @note    以最快的速度把日志中的输入重新交给电梯(虚拟时间为记录的时间)，逐条检查分派的事件以及转移，
+ *          同时作为性能回归测试: 输出每秒回放的记录数以及相对记录时的加速比
+*/
+int replay_main(const char *path)
+{
+    elevator_init(&elevator, &sched, replay_timer);
+    elevator.stop = sim_stop;
+    dbg_log_threshold = 0;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int ret = fsm_log_replay(&event_log, path, &elevator_def, &sched, replay_input, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (ret != 0)
+    {
+        perror(path);
+        return 1;
+    }
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    uint64_t span = event_log.nrecords ? event_log.records[event_log.nrecords - 1].time : 0;
+    printf("replayed %zu records, %llu dispatches in %.3f s (%.0f records/s, %.0fx recorded time)\n",
+           event_log.nrecords, (unsigned long long)event_log.checked, wall, event_log.nrecords / wall,
+           span * 1e-9 / wall);
+    printf("final floor %d, checksum %016llx\n", elevator.current_floor, (unsigned long long)sim_checksum);
+    if (event_log.mismatches != 0)
+    {
+        size_t i = event_log.first_mismatch;
+        printf("%llu mismatches, first at record %zu", (unsigned long long)event_log.mismatches, i);
+        if (i < event_log.nrecords && event_log.records[i].source == FSM_LOG_DISPATCH)
         {
-            DBG_LOGI("You already in floor %d, elevator will not run", floor);
-            continue;
+            const stc_fsm_log_record_t *r = &event_log.records[i];
+            printf(": expected %s -> %s on %s", elevator_state_names[r->before],
+                   r->after == FSM_LOG_NONE ? "none" : elevator_state_names[r->after],
+                   elevator_event_names[r->event]);
         }
-        target_floor = floor;
-        DBG_LOGI("######## Target floor is %d", target_floor);
-        if (target_floor > current_floor)
+        printf("\n");
+        ret = 1;
+    }
+    fsm_log_close(&event_log);
+    return ret;
+}
+
+/**
+ * @brief   退出时把记录的日志写入文件
+*/
+void close_log(void)
+{
+    if (fsm_log_close(recording) != 0)
+    {
+        perror("event log");
+    }
+}
+
+/**
+ * @brief   ./main [运行一层楼的时间(毫秒)，默认 RUN_TIME 秒]
+ *          ./main -s [停靠次数，默认1000000] [seed，默认1]   仿真模式
+ *          ./main -r <日志文件> [交互模式或者仿真模式的参数]     记录事件日志
+ *          ./main -p <日志文件>                                回放事件日志并检查转移
+ *          ./main -c <快照文件> [交互模式或者仿真模式的参数]     写检查点
+ *          ./main -l <快照文件> [交互模式或者仿真模式的参数]     从快照恢复后继续运行
+ * @note    交互模式开启状态机统计: 收到 SIGUSR1 时输出到标准错误，退出时输出到标准输出(Prometheus 文本格式)
+ * @note    交互模式写检查点时收到 SIGUSR2 写后台检查点，退出时同步写入最终快照
+*/
+int main(int argc, char *argv[])
+{
+    fsm_sched_init(&sched);
+    if (argc > 2 && strcmp(argv[1], "-p") == 0)
+    {
+        return replay_main(argv[2]);
+    }
+    for (;;)
+    {
+        if (argc > 2 && strcmp(argv[1], "-r") == 0)
         {
-            fsm.event = EVENT_UP;
+            if (fsm_log_open(&event_log, argv[2], &elevator_def) != 0)
+            {
+                perror(argv[2]);
+                return 1;
+            }
+            recording = &event_log;
+            sched.log = recording;
+            atexit(close_log);
         }
-        if (target_floor < current_floor)
+        else if (argc > 2 && strcmp(argv[1], "-c") == 0)
         {
-            fsm.event = EVENT_DOWN;
+            checkpoint_path = argv[2];
         }
-        // 查询状态表
-        if (traverse_fsm_map(&fsm))
+        else if (argc > 2 && strcmp(argv[1], "-l") == 0)
         {
-            // 执行动作
-            fsm.action(&current_floor);
-            // 切换状态
-            fsm.state = fsm.next_state;
+            restore_path = argv[2];
         }
         else
         {
-            DBG_LOGW("Not found valid fsm");
+            break;
         }
+        argc -= 2;
+        argv += 2;
     }
+    fsm_checkpoint_init(&checkpoint, checkpoint_path, snapshot_fill, NULL);
+    if (argc > 1 && strcmp(argv[1], "-s") == 0)
+    {
+        elevator_init(&elevator, &sched, start_timer);
+        return sim_main(argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000,
+                        argc > 3 ? strtoull(argv[3], NULL, 10) : 1);
+    }
+    if (argc > 1)
+    {
+        run_time_ns = (uint64_t)(atof(argv[1]) * 1e6);
+    }
+    printf("%s\n", PROJECT_NAME);
+    if (fsm_wheel_init(&wheel, WHEEL_TIMERS, WHEEL_TICK_NS, timer_callback) != 0)
+    {
+        perror("wheel");
+        return 1;
+    }
+    fsm_wheel_clock(&wheel, &timer_clock);
+    run_ticks = fsm_wheel_ticks(&wheel, run_time_ns);
+    elevator_init(&elevator, &sched, start_timer);
+    if (fsm_stats_init(&stats, &elevator_def, elevator_state_names, elevator_event_names) != 0)
+    {
+        perror("stats");
+        return 1;
+    }
+    // 交互模式的事件很少，每个事件都记录延迟
+    stats.sample_mask = 0;
+    sched.stats = &stats;
+    if (fsm_loop_init(&loop, &sched) != 0)
+    {
+        perror("epoll");
+        return 1;
+    }
+    loop.round_cb = round_callback;
+    // 输入、定时器以及信号都在事件循环中处理
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGUSR2);
+    // 标准输入与终端共享文件状态，退出时恢复
+    int stdin_flags = fcntl(STDIN_FILENO, F_GETFL);
+    fcntl(STDIN_FILENO, F_SETFL, stdin_flags | O_NONBLOCK);
+    if (fsm_loop_add(&loop, &input_io, STDIN_FILENO, EPOLLIN, input_callback, NULL) != 0
+        || fsm_wheel_attach(&wheel, &loop, &wheel_io) != 0
+        || fsm_loop_signal_init(&loop, &signal_io, &mask, signal_callback, NULL) != 0)
+    {
+        perror("event loop (stdin must be a terminal, pipe or socket)");
+        return 1;
+    }
+    if (restore_path != NULL && snapshot_restore(restore_path) != 0)
+    {
+        return 1;
+    }
+    DBG_LOGI("The Elevator floor range : [%d] to [%d]", MIN_FLOOR, MAX_FLOOR);
+    DBG_LOGI("Current_floor = %d", elevator.current_floor);
+    DBG_LOGI("Waiting for new target floor: ");
+
+    fsm_loop_run(&loop);
+
+    print_latency("Timer", &loop.timer_latency);
+    print_latency("Event", &loop.event_latency);
+    fsm_stats_prometheus(&stats, stdout, "elevator");
+    if (checkpoint_path != NULL)
+    {
+        checkpoint_finish();
+    }
+    fsm_stats_free(&stats);
+    fsm_loop_close(&loop);
+    fsm_wheel_free(&wheel);
+    fcntl(STDIN_FILENO, F_SETFL, stdin_flags);
     return 0;
-}
\ No newline at end of file
+}
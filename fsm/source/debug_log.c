@@ -1,6 +1,7 @@
 ﻿#include <stdio.h>
 #include "debug_log.h"
 
+int dbg_log_threshold = DBG_LOG_LEVEL;
 
 void print_hex_table(uint8_t *data, uint16_t len)
 {
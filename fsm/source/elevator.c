@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include "debug_log.h"
+#include "elevator.h"
+
+_Static_assert(FLOOR_COUNT <= 32, "pending bitmap is 32 bits");
+
+/**
+ * @brief   清除当前楼层的请求
+ * @return  清除之后的请求位图
+*/
+static uint32_t clear_current(stc_elevator_t *elevator)
+{
+    uint32_t bit = FLOOR_BIT(elevator->current_floor);
+    return __atomic_and_fetch(&elevator->pending, ~bit, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief   投递唤醒事件，队列已满时记录下来等待重新投递
+*/
+static int post_wake(stc_elevator_t *elevator)
+{
+    if (fsm_post(&elevator->fsm, EVENT_REQUEST) != 0)
+    {
+        __atomic_store_n(&elevator->wake_pending, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+    return 0;
+}
+
+// 上升动作
+static void go_up_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    DBG_LOGI("\t🔼 Going UP, current_floor = %d", elevator->current_floor);
+    // 启动定时器(启动电梯)
+    elevator->start_timer(elevator, TIMER_RUN);
+    elevator->current_floor++;
+    elevator->dir = 1;
+    elevator->departing = 0;
+}
+
+// 下降动作
+static void go_down_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    DBG_LOGI("\t🔽 Going DOWN, current_floor = %d", elevator->current_floor);
+    // 启动定时器(启动电梯)
+    elevator->start_timer(elevator, TIMER_RUN);
+    elevator->current_floor--;
+    elevator->dir = -1;
+    elevator->departing = 0;
+}
+
+// 到达指定楼层动作
+static void arrive_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    uint32_t pending = clear_current(elevator);
+    DBG_LOGI("\t⏸  === Arrived target floor: %d", elevator->current_floor);
+    if (elevator->stop != NULL)
+    {
+        elevator->stop(elevator);
+        pending = __atomic_load_n(&elevator->pending, __ATOMIC_ACQUIRE);
+    }
+    // 判断到达之后登记的请求没有投递唤醒事件，空闲后自己唤醒
+    if (pending != 0)
+    {
+        post_wake(elevator);
+    }
+}
+
+// 中途停靠动作
+static void stop_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    clear_current(elevator);
+    DBG_LOGI("\t⏹  Stop at floor: %d", elevator->current_floor);
+    if (elevator->stop != NULL)
+    {
+        elevator->stop(elevator);
+    }
+    elevator->start_timer(elevator, TIMER_STOP);
+}
+
+// 停靠结束并且没有请求
+static void close_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    DBG_LOGI("\t⏸  === Stopped at floor: %d", elevator->current_floor);
+    if (__atomic_load_n(&elevator->pending, __ATOMIC_ACQUIRE) != 0)
+    {
+        post_wake(elevator);
+    }
+}
+
+/**
+ * @brief   按 LOOK 顺序选择运行方向: 优先保持原方向，前方没有请求时掉头
+ * @return  EVENT_UP / EVENT_DOWN，没有请求时返回 EVENT_ARRIVE
+*/
+static en_event_t next_direction(const stc_elevator_t *elevator, uint32_t pending)
+{
+    uint32_t bit = FLOOR_BIT(elevator->current_floor);
+    uint32_t above = pending & ~((bit << 1) - 1);
+    uint32_t below = pending & (bit - 1);
+    if (above && (elevator->dir >= 0 || !below))
+    {
+        return EVENT_UP;
+    }
+    return below ? EVENT_DOWN : EVENT_ARRIVE;
+}
+
+// 空闲时收到请求，当前楼层的请求直接服务，再选择运行方向
+static void request_action(void *ctx)
+{
+    stc_elevator_t *elevator = ctx;
+    if (elevator->departing)
+    {
+        return;
+    }
+    uint32_t pending = __atomic_load_n(&elevator->pending, __ATOMIC_ACQUIRE);
+    if (pending & FLOOR_BIT(elevator->current_floor))
+    {
+        pending = clear_current(elevator);
+        if (elevator->stop != NULL)
+        {
+            elevator->stop(elevator);
+            pending = __atomic_load_n(&elevator->pending, __ATOMIC_ACQUIRE);
+        }
+    }
+    en_event_t event = next_direction(elevator, pending);
+    if (event == EVENT_ARRIVE)
+    {
+        return;
+    }
+    if (fsm_post(&elevator->fsm, event) == 0)
+    {
+        elevator->departing = 1;
+    }
+    else
+    {
+        // 队列已满，稍后重新投递唤醒事件，再次选择方向
+        __atomic_store_n(&elevator->wake_pending, 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief   状态表
+ * @note    每个 [现态][条件] 组合都必须列出，没有转移的组合次态为 FSM_NONE，
+ *          遗漏或者重复的组合在编译期报错
+ * @note    运行中收到同方向的事件时重复执行当前动作，继续运行一层
+ * @note    运行中到达请求的楼层: 还有其他请求时停靠(STATE_STOPPED)，停靠结束后继续运行或者掉头；
+ *          没有其他请求时到达并空闲
+*/
+#define FSM_MAP(X)                                                                  \
+    X(STATE_IDLE,        EVENT_UP,           go_up_action,   STATE_GOING_UP)        \
+    X(STATE_IDLE,        EVENT_DOWN,         go_down_action, STATE_GOING_DOWN)      \
+    X(STATE_IDLE,        EVENT_ARRIVE,       NULL,           FSM_NONE)              \
+    X(STATE_IDLE,        EVENT_STOP,         NULL,           FSM_NONE)              \
+    X(STATE_IDLE,        EVENT_REQUEST,      request_action, STATE_IDLE)            \
+    X(STATE_GOING_UP,    EVENT_UP,           go_up_action,   STATE_GOING_UP)        \
+    X(STATE_GOING_UP,    EVENT_DOWN,         NULL,           FSM_NONE)              \
+    X(STATE_GOING_UP,    EVENT_ARRIVE,       arrive_action,  STATE_IDLE)            \
+    X(STATE_GOING_UP,    EVENT_STOP,         stop_action,    STATE_STOPPED)         \
+    X(STATE_GOING_UP,    EVENT_REQUEST,      NULL,           FSM_NONE)              \
+    X(STATE_GOING_DOWN,  EVENT_UP,           NULL,           FSM_NONE)              \
+    X(STATE_GOING_DOWN,  EVENT_DOWN,         go_down_action, STATE_GOING_DOWN)      \
+    X(STATE_GOING_DOWN,  EVENT_ARRIVE,       arrive_action,  STATE_IDLE)            \
+    X(STATE_GOING_DOWN,  EVENT_STOP,         stop_action,    STATE_STOPPED)         \
+    X(STATE_GOING_DOWN,  EVENT_REQUEST,      NULL,           FSM_NONE)              \
+    X(STATE_STOPPED,     EVENT_UP,           go_up_action,   STATE_GOING_UP)        \
+    X(STATE_STOPPED,     EVENT_DOWN,         go_down_action, STATE_GOING_DOWN)      \
+    X(STATE_STOPPED,     EVENT_ARRIVE,       close_action,   STATE_IDLE)            \
+    X(STATE_STOPPED,     EVENT_STOP,         stop_action,    STATE_STOPPED)         \
+    X(STATE_STOPPED,     EVENT_REQUEST,      NULL,           FSM_NONE)
+
+// 稠密状态表 fsm_map[现态][条件]
+FSM_DENSE_TABLE(fsm_map, FSM_MAP, STATE_COUNT, EVENT_COUNT);
+
+const stc_fsm_def_t elevator_def = FSM_DEF_DENSE(fsm_map);
+
+const char *const elevator_state_names[STATE_COUNT] =
+{
+    [STATE_IDLE]        = "IDLE",
+    [STATE_GOING_UP]    = "GOING_UP",
+    [STATE_GOING_DOWN]  = "GOING_DOWN",
+    [STATE_STOPPED]     = "STOPPED",
+};
+
+const char *const elevator_event_names[EVENT_COUNT] =
+{
+    [EVENT_UP]          = "UP",
+    [EVENT_DOWN]        = "DOWN",
+    [EVENT_ARRIVE]      = "ARRIVE",
+    [EVENT_STOP]        = "STOP",
+    [EVENT_REQUEST]     = "REQUEST",
+};
+
+void elevator_init(stc_elevator_t *elevator, stc_fsm_sched_t *sched,
+                   void (*start_timer)(stc_elevator_t *, en_timer_t))
+{
+    fsm_instance_init(&elevator->fsm, &elevator_def, sched, STATE_IDLE, elevator);
+    elevator->current_floor = 0;
+    elevator->dir = 0;
+    elevator->pending = 0;
+    elevator->departing = 0;
+    elevator->wake_pending = 0;
+    elevator->start_timer = start_timer;
+    elevator->stop = NULL;
+}
+
+int elevator_request(stc_elevator_t *elevator, int floor)
+{
+    // 重复的请求只置位一次；只有位图从空变为非空时需要唤醒，其余情况电梯运行中会自己处理
+    // 之前的唤醒事件投递失败时由本次请求重新投递
+    uint32_t old = __atomic_fetch_or(&elevator->pending, FLOOR_BIT(floor), __ATOMIC_ACQ_REL);
+    if (old == 0)
+    {
+        return post_wake(elevator);
+    }
+    return elevator_wake(elevator);
+}
+
+int elevator_wake(stc_elevator_t *elevator)
+{
+    // 先读一次，没有等待的唤醒事件时不写共享的缓存行
+    if (__atomic_load_n(&elevator->wake_pending, __ATOMIC_ACQUIRE)
+        && __atomic_exchange_n(&elevator->wake_pending, 0, __ATOMIC_ACQ_REL))
+    {
+        return post_wake(elevator);
+    }
+    return 0;
+}
+
+uint32_t elevator_action_effect(fsm_action_t action)
+{
+    if (action == go_up_action)
+    {
+        return EFFECT_MOVE_UP;
+    }
+    if (action == go_down_action)
+    {
+        return EFFECT_MOVE_DOWN;
+    }
+    if (action == arrive_action || action == stop_action)
+    {
+        return EFFECT_CLEAR;
+    }
+    if (action == request_action)
+    {
+        return EFFECT_CLEAR | EFFECT_DISPATCH;
+    }
+    // close_action 以及 NULL 只打印或者没有动作
+    return 0;
+}
+
+void elevator_tick(stc_elevator_t *elevator)
+{
+    en_state_t state = (en_state_t)__atomic_load_n(&elevator->fsm.state, __ATOMIC_RELAXED);
+    if (state == STATE_IDLE)
+    {
+        return;
+    }
+    uint32_t bit = FLOOR_BIT(elevator->current_floor);
+    uint32_t pending = __atomic_load_n(&elevator->pending, __ATOMIC_ACQUIRE);
+    en_event_t event;
+    if (state == STATE_STOPPED)
+    {
+        // 停靠期间又请求了当前楼层时重新停靠，否则继续运行或者掉头
+        event = (pending & bit) ? EVENT_STOP : next_direction(elevator, pending);
+    }
+    else if (pending & bit) // 到达请求的楼层
+    {
+        event = (pending & ~bit) ? EVENT_STOP : EVENT_ARRIVE;
+    }
+    else // 继续执行当前动作
+    {
+        event = state == STATE_GOING_UP ? EVENT_UP : EVENT_DOWN;
+    }
+    if (fsm_post(&elevator->fsm, event) != 0)
+    {
+        // 队列已满，停靠一次的时间之后重新判断
+        elevator->start_timer(elevator, TIMER_STOP);
+    }
+}
@@ -0,0 +1,302 @@
+#include <stdlib.h>
+#include "elevator_group.h"
+#include "fsm_loop.h"
+
+/**
+ * @brief   停靠位图中最高/最低的楼层，位图不能为0
+*/
+static int stops_highest(uint32_t stops)
+{
+    return 31 - __builtin_clz(stops) + MIN_FLOOR;
+}
+
+static int stops_lowest(uint32_t stops)
+{
+    return __builtin_ctz(stops) + MIN_FLOOR;
+}
+
+/**
+ * @brief   [low, high] 范围内的停靠楼层数量
+*/
+static uint32_t stops_between(uint32_t stops, int low, int high)
+{
+    if (low > high)
+    {
+        return 0;
+    }
+    uint32_t mask = (uint32_t)(((2ull << (high - MIN_FLOOR)) - 1) & ~((1ull << (low - MIN_FLOOR)) - 1));
+    return (uint32_t)__builtin_popcount(stops & mask);
+}
+
+/**
+ * @brief   按 LOOK 顺序估算电梯到达 floor 需要运行的楼层数
+ * @param   [in] dir    乘客的方向: 1 上行，-1 下行
+*/
+static uint32_t look_distance(const stc_group_car_t *car, uint32_t stops, int floor, int dir)
+{
+    int pos = car->elevator.current_floor;
+    if (stops == 0)
+    {
+        return (uint32_t)abs(floor - pos);
+    }
+    int top = stops_highest(stops);
+    int bottom = stops_lowest(stops);
+    top = top > pos ? top : pos;
+    bottom = bottom < pos ? bottom : pos;
+    if (car->elevator.dir >= 0)
+    {
+        // 在前方且同向，或者在扫描的最远处之外
+        if (floor >= pos && (dir > 0 || floor >= top))
+        {
+            return (uint32_t)(floor - pos);
+        }
+        if (dir < 0)
+        {
+            return (uint32_t)((top - pos) + (top - floor));
+        }
+        bottom = bottom < floor ? bottom : floor;
+        return (uint32_t)((top - pos) + (top - bottom) + (floor - bottom));
+    }
+    if (floor <= pos && (dir < 0 || floor <= bottom))
+    {
+        return (uint32_t)(pos - floor);
+    }
+    if (dir > 0)
+    {
+        return (uint32_t)((pos - bottom) + (floor - bottom));
+    }
+    top = top > floor ? top : floor;
+    return (uint32_t)((pos - bottom) + (top - bottom) + (top - floor));
+}
+
+/**
+ * @brief   估算电梯到达出发楼层的时间(tick)，包括沿途的停靠
+*/
+static uint64_t look_eta(const stc_elevator_group_t *group, const stc_group_car_t *car, int origin, int dir)
+{
+    int pos = car->elevator.current_floor;
+    uint32_t stops = __atomic_load_n(&car->elevator.pending, __ATOMIC_RELAXED);
+    uint64_t eta = (uint64_t)look_distance(car, stops, origin, dir) * group->floor_ticks;
+    stops &= ~FLOOR_BIT(origin);
+    eta += (uint64_t)stops_between(stops, pos < origin ? pos : origin, pos < origin ? origin : pos)
+         * group->stop_ticks;
+    return eta;
+}
+
+uint32_t group_policy_nearest(const stc_elevator_group_t *group, int origin, int dest)
+{
+    (void)dest;
+    uint32_t best = 0;
+    uint64_t best_cost = UINT64_MAX;
+    for (uint32_t i = 0; i < group->ncars; i++)
+    {
+        const stc_group_car_t *car = &group->cars[i];
+        // 距离相同时选择负载少的电梯
+        uint64_t cost = ((uint64_t)abs(origin - car->elevator.current_floor) << 32) | car->load;
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint32_t group_policy_look(const stc_elevator_group_t *group, int origin, int dest)
+{
+    int dir = dest > origin ? 1 : -1;
+    uint32_t best = 0;
+    uint64_t best_cost = UINT64_MAX;
+    for (uint32_t i = 0; i < group->ncars; i++)
+    {
+        uint64_t cost = look_eta(group, &group->cars[i], origin, dir);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint32_t group_policy_destination(const stc_elevator_group_t *group, int origin, int dest)
+{
+    int dir = dest > origin ? 1 : -1;
+    int low = origin < dest ? origin : dest;
+    int high = origin < dest ? dest : origin;
+    uint32_t best = 0;
+    uint64_t best_cost = UINT64_MAX;
+    for (uint32_t i = 0; i < group->ncars; i++)
+    {
+        const stc_group_car_t *car = &group->cars[i];
+        uint32_t stops = __atomic_load_n(&car->elevator.pending, __ATOMIC_RELAXED);
+        // 到达出发楼层 + 乘坐(运行以及中途停靠)
+        uint64_t cost = look_eta(group, car, origin, dir);
+        cost += (uint64_t)(high - low) * group->floor_ticks
+              + stops_between(stops, low + 1, high - 1) * group->stop_ticks;
+        // 新增的停靠使已分配的乘客多等一次停靠
+        uint32_t added = !(stops & FLOOR_BIT(origin)) + !(stops & FLOOR_BIT(dest));
+        cost += (uint64_t)added * car->load * group->stop_ticks;
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief   电梯状态机启动运行一层楼或者停靠的定时器
+*/
+static void group_start_timer(stc_elevator_t *elevator, en_timer_t timer)
+{
+    stc_group_car_t *car = (stc_group_car_t *)elevator;
+    stc_elevator_group_t *group = car->group;
+    group->clock.start(group->clock.impl, timer == TIMER_RUN ? group->floor_ticks : group->stop_ticks, car, timer);
+}
+
+/**
+ * @brief   在当前楼层停靠: 轿厢内到达的乘客离开，等待的乘客进入并登记目标楼层
+*/
+static void car_service(stc_group_car_t *car)
+{
+    stc_elevator_group_t *group = car->group;
+    int floor = car->elevator.current_floor;
+    uint64_t now = *group->clock.now;
+
+    uint32_t *link = &car->riding;
+    while (*link != GROUP_NIL)
+    {
+        stc_group_call_t *call = &group->calls[*link];
+        if (call->dest != floor)
+        {
+            link = &call->next;
+            continue;
+        }
+        uint32_t index = *link;
+        *link = call->next;
+        fsm_hist_add(&group->journey, now - call->call_time);
+        call->next = group->free;
+        group->free = index;
+        car->load--;
+    }
+
+    link = &car->waiting;
+    while (*link != GROUP_NIL)
+    {
+        stc_group_call_t *call = &group->calls[*link];
+        if (call->origin != floor)
+        {
+            link = &call->next;
+            continue;
+        }
+        uint32_t index = *link;
+        *link = call->next;
+        fsm_hist_add(&group->wait, now - call->call_time);
+        call->next = car->riding;
+        car->riding = index;
+        elevator_request(&car->elevator, call->dest);
+    }
+}
+
+/**
+ * @brief   电梯状态机在请求的楼层停靠
+*/
+static void group_stop(stc_elevator_t *elevator)
+{
+    car_service((stc_group_car_t *)elevator);
+}
+
+int elevator_group_init(stc_elevator_group_t *group, uint32_t ncars, uint32_t capacity, stc_fsm_sched_t *sched,
+                        const stc_fsm_clock_t *clock, uint32_t floor_ticks, uint32_t stop_ticks, group_policy_t policy)
+{
+    group->cars = calloc(ncars, sizeof(stc_group_car_t));
+    group->calls = malloc((size_t)capacity * sizeof(stc_group_call_t));
+    if (group->cars == NULL || group->calls == NULL)
+    {
+        free(group->cars);
+        free(group->calls);
+        return -1;
+    }
+    group->ncars = ncars;
+    group->capacity = capacity;
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        group->calls[i].next = i + 1 < capacity ? i + 1 : GROUP_NIL;
+    }
+    group->free = capacity ? 0 : GROUP_NIL;
+    group->clock = *clock;
+    group->floor_ticks = floor_ticks;
+    group->stop_ticks = stop_ticks;
+    group->policy = policy;
+    group->rejected = 0;
+    fsm_hist_init(&group->wait);
+    fsm_hist_init(&group->journey);
+    fsm_hist_init(&group->decide);
+    for (uint32_t i = 0; i < ncars; i++)
+    {
+        stc_group_car_t *car = &group->cars[i];
+        elevator_init(&car->elevator, sched, group_start_timer);
+        car->elevator.stop = group_stop;
+        car->group = group;
+        car->waiting = GROUP_NIL;
+        car->riding = GROUP_NIL;
+    }
+    return 0;
+}
+
+void elevator_group_free(stc_elevator_group_t *group)
+{
+    free(group->cars);
+    free(group->calls);
+    group->cars = NULL;
+    group->calls = NULL;
+    group->ncars = 0;
+    group->capacity = 0;
+}
+
+int elevator_group_call(stc_elevator_group_t *group, int origin, int dest)
+{
+    if (origin < MIN_FLOOR || origin > MAX_FLOOR || dest < MIN_FLOOR || dest > MAX_FLOOR || origin == dest
+        || group->ncars == 0)
+    {
+        return -1;
+    }
+    uint32_t index = group->free;
+    if (index == GROUP_NIL)
+    {
+        group->rejected++;
+        return -1;
+    }
+    uint64_t start = fsm_loop_now();
+    uint32_t car_index = group->policy(group, origin, dest);
+    fsm_hist_add(&group->decide, fsm_loop_now() - start);
+
+    stc_group_car_t *car = &group->cars[car_index];
+    stc_group_call_t *call = &group->calls[index];
+    group->free = call->next;
+    call->origin = (int16_t)origin;
+    call->dest = (int16_t)dest;
+    call->call_time = *group->clock.now;
+    call->next = car->waiting;
+    car->waiting = index;
+    car->load++;
+    // 电梯空闲或者正在出发楼层停靠时乘客直接进入轿厢，否则登记出发楼层
+    uint32_t state = car->elevator.fsm.state;
+    if ((state == STATE_IDLE || state == STATE_STOPPED) && car->elevator.current_floor == origin)
+    {
+        car_service(car);
+    }
+    else
+    {
+        elevator_request(&car->elevator, origin);
+    }
+    return (int)car_index;
+}
+
+void elevator_group_expire(void *arg, uint32_t data)
+{
+    (void)data;
+    elevator_tick(arg);
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+#include "elevator_soa.h"
+
+// 没有事件(表的最后一列)
+#define EVENT_NONE      EVENT_COUNT
+
+// 数组按缓存行对齐
+#define SOA_ALIGN       64
+
+/**
+ * @brief   x86 上同时生成 AVX2 以及通用版本，运行时按 CPU 选择
+ * @note    每部电梯的楼层位以及状态表的读取需要按元素的移位以及 gather，SSE2 不能向量化
+*/
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define SOA_KERNEL      __attribute__((target_clones("avx2", "default")))
+#else
+#define SOA_KERNEL
+#endif
+
+static void *soa_alloc(size_t count, size_t size)
+{
+    size_t bytes = (count * size + SOA_ALIGN - 1) / SOA_ALIGN * SOA_ALIGN;
+    void *ptr = aligned_alloc(SOA_ALIGN, bytes ? bytes : SOA_ALIGN);
+    if (ptr != NULL)
+    {
+        memset(ptr, 0, bytes);
+    }
+    return ptr;
+}
+
+int elevator_soa_init(stc_elevator_soa_t *soa, size_t count)
+{
+    soa->count = count;
+    soa->stops = 0;
+    soa->state = soa_alloc(count, sizeof(uint32_t));
+    soa->floor = soa_alloc(count, sizeof(uint32_t));
+    soa->dir = soa_alloc(count, sizeof(int32_t));
+    soa->pending = soa_alloc(count, sizeof(uint32_t));
+    if (soa->state == NULL || soa->floor == NULL || soa->dir == NULL || soa->pending == NULL)
+    {
+        elevator_soa_free(soa);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        soa->state[i] = STATE_IDLE;
+        soa->floor[i] = (uint32_t)(0 - MIN_FLOOR);
+    }
+    // 由状态表生成转移，没有转移时保持现态
+    for (uint32_t s = 0; s < STATE_COUNT; s++)
+    {
+        for (uint32_t e = 0; e <= EVENT_COUNT; e++)
+        {
+            const stc_fsm_entry_t *entry = e < EVENT_COUNT ? fsm_def_lookup(&elevator_def, s, e) : NULL;
+            soa->next[s][e] = (uint8_t)(entry != NULL ? entry->next_state : s);
+            soa->effect[s][e] = (uint8_t)(entry != NULL ? elevator_action_effect(entry->action) : 0);
+        }
+    }
+    return 0;
+}
+
+void elevator_soa_free(stc_elevator_soa_t *soa)
+{
+    free(soa->state);
+    free(soa->floor);
+    free(soa->dir);
+    free(soa->pending);
+    soa->state = NULL;
+    soa->floor = NULL;
+    soa->dir = NULL;
+    soa->pending = NULL;
+    soa->count = 0;
+}
+
+SOA_KERNEL void elevator_soa_tick(stc_elevator_soa_t *soa)
+{
+    uint32_t *restrict state = soa->state;
+    uint32_t *restrict floor = soa->floor;
+    int32_t *restrict dir = soa->dir;
+    uint32_t *restrict pending = soa->pending;
+    // 表展开为32位，便于向量化时按下标读取
+    uint32_t next[STATE_COUNT * (EVENT_COUNT + 1)];
+    uint32_t effect[STATE_COUNT * (EVENT_COUNT + 1)];
+    for (uint32_t s = 0; s < STATE_COUNT; s++)
+    {
+        for (uint32_t e = 0; e <= EVENT_COUNT; e++)
+        {
+            next[s * (EVENT_COUNT + 1) + e] = soa->next[s][e];
+            effect[s * (EVENT_COUNT + 1) + e] = soa->effect[s][e];
+        }
+    }
+
+    uint32_t stops = 0;
+    for (size_t i = 0; i < soa->count; i++)
+    {
+        uint32_t s = state[i];
+        uint32_t f = floor[i];
+        uint32_t p = pending[i];
+        int32_t d = dir[i];
+        uint32_t bit = 1u << (f & 31);
+
+        // next_direction: 优先保持原方向，前方没有请求时掉头
+        uint32_t above = p & ~((bit << 1) - 1);
+        uint32_t below = p & (bit - 1);
+        uint32_t go_up = (uint32_t)(above != 0) & ((uint32_t)(d >= 0) | (uint32_t)(below == 0));
+        uint32_t go = go_up | (uint32_t)(below != 0);
+        uint32_t look = go_up ? EVENT_UP : (go ? EVENT_DOWN : EVENT_ARRIVE);
+        // elevator_tick: 运行中到达请求的楼层时停靠或者到达，否则继续；停靠结束时按 LOOK 顺序出发
+        uint32_t at = (p & bit) != 0;
+        uint32_t run = at ? ((p & ~bit) != 0 ? EVENT_STOP : EVENT_ARRIVE)
+                          : (s == STATE_GOING_UP ? EVENT_UP : EVENT_DOWN);
+        uint32_t stopped = at ? EVENT_STOP : look;
+        // 空闲时有请求: EVENT_REQUEST(elevator_request 唤醒)
+        uint32_t event = s == STATE_IDLE ? (p != 0 ? EVENT_REQUEST : EVENT_NONE)
+                       : (s == STATE_STOPPED ? stopped : run);
+
+        uint32_t index = s * (EVENT_COUNT + 1) + event;
+        uint32_t e1 = effect[index];
+        s = next[index];
+        // request_action 清除当前楼层后投递 LOOK 方向的事件，在同一个tick中分派
+        uint32_t dispatch = (e1 / EFFECT_DISPATCH) & go;
+        index = s * (EVENT_COUNT + 1) + (dispatch ? look : EVENT_NONE);
+        uint32_t e2 = effect[index];
+        s = next[index];
+
+        uint32_t e = e1 | e2;
+        uint32_t clear = (e & EFFECT_CLEAR) ? bit : 0;
+        stops += (p & clear) != 0;
+        p &= ~clear;
+        uint32_t up = (e & EFFECT_MOVE_UP) != 0;
+        uint32_t down = (e & EFFECT_MOVE_DOWN) != 0;
+        f = f + up - down;
+        d = up ? 1 : (down ? -1 : d);
+
+        state[i] = s;
+        floor[i] = f;
+        dir[i] = d;
+        pending[i] = p;
+    }
+    soa->stops += stops;
+}
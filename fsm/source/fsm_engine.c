@@ -0,0 +1,176 @@
+#include "fsm_engine.h"
+#include "fsm_log.h"
+#include "fsm_stats.h"
+
+_Static_assert((FSM_QUEUE_SIZE & (FSM_QUEUE_SIZE - 1)) == 0, "FSM_QUEUE_SIZE must be a power of 2");
+
+void fsm_sched_init(stc_fsm_sched_t *sched)
+{
+    sched->ready = NULL;
+    sched->dispatched = 0;
+    sched->ignored = 0;
+    sched->stats = NULL;
+    sched->log = NULL;
+}
+
+void fsm_instance_init(stc_fsm_instance_t *fsm, const stc_fsm_def_t *def, stc_fsm_sched_t *sched,
+                       uint32_t state, void *ctx)
+{
+    fsm->state = state;
+    fsm->scheduled = 0;
+    fsm->head = 0;
+    fsm->tail = 0;
+    fsm->ctx = ctx;
+    fsm->def = def;
+    fsm->sched = sched;
+    fsm->next = NULL;
+    fsm->entered = 0;
+    fsm->id = 0;
+    for (uint32_t i = 0; i < FSM_QUEUE_SIZE; i++)
+    {
+        fsm->slots[i].seq = i;
+        fsm->slots[i].event = 0;
+        fsm->slots[i].posted = 0;
+    }
+}
+
+/**
+ * @brief   把实例压入就绪链表
+*/
+static void sched_push(stc_fsm_sched_t *sched, stc_fsm_instance_t *fsm)
+{
+    stc_fsm_instance_t *head = __atomic_load_n(&sched->ready, __ATOMIC_RELAXED);
+    do
+    {
+        fsm->next = head;
+    } while (!__atomic_compare_exchange_n(&sched->ready, &head, fsm, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+int fsm_post(stc_fsm_instance_t *fsm, uint32_t event)
+{
+    // 有界MPSC队列: 槽位序号等于写位置时可写，写完后序号加1表示可读
+    uint32_t pos = __atomic_load_n(&fsm->tail, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        stc_fsm_slot_t *slot = &fsm->slots[pos & (FSM_QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&fsm->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                slot->event = event;
+                // 开启统计时按写位置抽样记录投递时间
+                stc_fsm_stats_t *stats = fsm->sched->stats;
+                slot->posted = stats != NULL && (pos & stats->sample_mask) == 0 ? fsm_stats_now() : 0;
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return -1;
+        }
+        else
+        {
+            pos = __atomic_load_n(&fsm->tail, __ATOMIC_RELAXED);
+        }
+    }
+    // 第一个把 scheduled 置1的投递者负责把实例加入就绪链表
+    if (!__atomic_exchange_n(&fsm->scheduled, 1, __ATOMIC_SEQ_CST))
+    {
+        sched_push(fsm->sched, fsm);
+    }
+    return 0;
+}
+
+/**
+ * @brief   取出一个事件
+ * @return  成功返回0，队列为空返回-1
+*/
+static int queue_pop(stc_fsm_instance_t *fsm, uint32_t *event, uint64_t *posted)
+{
+    stc_fsm_slot_t *slot = &fsm->slots[fsm->head & (FSM_QUEUE_SIZE - 1)];
+    if ((int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - (fsm->head + 1)) < 0)
+    {
+        return -1;
+    }
+    *event = slot->event;
+    *posted = slot->posted;
+    __atomic_store_n(&slot->seq, fsm->head + FSM_QUEUE_SIZE, __ATOMIC_RELEASE);
+    fsm->head++;
+    return 0;
+}
+
+static int queue_empty(const stc_fsm_instance_t *fsm)
+{
+    const stc_fsm_slot_t *slot = &fsm->slots[fsm->head & (FSM_QUEUE_SIZE - 1)];
+    return (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - (fsm->head + 1)) < 0;
+}
+
+size_t fsm_sched_run(stc_fsm_sched_t *sched)
+{
+    stc_fsm_instance_t *list = __atomic_exchange_n(&sched->ready, NULL, __ATOMIC_ACQUIRE);
+    // 链表是后进先出，反转后按投递顺序处理
+    stc_fsm_instance_t *fifo = NULL;
+    while (list != NULL)
+    {
+        stc_fsm_instance_t *next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+
+    // 开启统计时每轮读取一次时钟，作为本轮状态切换的时间
+    uint64_t round = sched->stats != NULL ? fsm_stats_now() : 0;
+    size_t count = 0;
+    while (fifo != NULL)
+    {
+        stc_fsm_instance_t *fsm = fifo;
+        fifo = fifo->next;
+        uint32_t event;
+        uint64_t posted;
+        uint32_t n = 0;
+        stc_fsm_stats_t *stats = sched->stats != NULL && sched->stats->def == fsm->def ? sched->stats : NULL;
+        while (n < FSM_BATCH_SIZE && queue_pop(fsm, &event, &posted) == 0)
+        {
+            n++;
+            const stc_fsm_entry_t *entry = fsm_def_lookup(fsm->def, fsm->state, event);
+            if (stats != NULL)
+            {
+                fsm_stats_record(stats, fsm, event, entry != NULL ? entry->next_state : FSM_NONE, posted, round);
+            }
+            if (sched->log != NULL)
+            {
+                fsm_log_dispatch(sched->log, fsm, event, entry != NULL ? entry->next_state : FSM_NONE);
+            }
+            if (entry == NULL)
+            {
+                sched->ignored++;
+                continue;
+            }
+            // 执行动作，切换状态
+            if (entry->action != NULL)
+            {
+                entry->action(fsm->ctx);
+            }
+            fsm->state = entry->next_state;
+            sched->dispatched++;
+        }
+        count += n;
+
+        if (n == FSM_BATCH_SIZE && !queue_empty(fsm))
+        {
+            // 还有事件，保持 scheduled 并放到下一轮
+            sched_push(sched, fsm);
+            continue;
+        }
+        // 先清除 scheduled 再检查队列，避免与投递者同时错过
+        __atomic_store_n(&fsm->scheduled, 0, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (!queue_empty(fsm) && !__atomic_exchange_n(&fsm->scheduled, 1, __ATOMIC_SEQ_CST))
+        {
+            sched_push(sched, fsm);
+        }
+    }
+    return count;
+}
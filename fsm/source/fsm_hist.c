@@ -0,0 +1,61 @@
+#include <string.h>
+#include "fsm_hist.h"
+
+void fsm_hist_init(stc_fsm_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT64_MAX;
+}
+
+void fsm_hist_merge(stc_fsm_hist_t *dst, const stc_fsm_hist_t *src)
+{
+    dst->count += src->count;
+    dst->sum += src->sum;
+    dst->min = src->min < dst->min ? src->min : dst->min;
+    dst->max = src->max > dst->max ? src->max : dst->max;
+    for (uint32_t i = 0; i < FSM_HIST_BUCKETS; i++)
+    {
+        dst->buckets[i] += src->buckets[i];
+    }
+}
+
+uint64_t fsm_hist_bucket_low(uint32_t index)
+{
+    if (index < FSM_HIST_SUB)
+    {
+        return index;
+    }
+    uint32_t exp = index / FSM_HIST_SUB + FSM_HIST_SUB_BITS - 1;
+    uint64_t sub = index % FSM_HIST_SUB;
+    return (1ull << exp) | (sub << (exp - FSM_HIST_SUB_BITS));
+}
+
+uint64_t fsm_hist_percentile(const stc_fsm_hist_t *hist, double p)
+{
+    if (hist->count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)hist->count + 0.5);
+    rank = rank < 1 ? 1 : rank > hist->count ? hist->count : rank;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < FSM_HIST_BUCKETS; i++)
+    {
+        seen += hist->buckets[i];
+        if (seen >= rank)
+        {
+            // 取桶的中间值，并限制在实际的最小值以及最大值之间
+            uint64_t low = fsm_hist_bucket_low(i);
+            uint64_t high = i + 1 < FSM_HIST_BUCKETS ? fsm_hist_bucket_low(i + 1) - 1 : UINT64_MAX;
+            uint64_t v = low + (high - low) / 2;
+            v = v < hist->min ? hist->min : v;
+            return v > hist->max ? hist->max : v;
+        }
+    }
+    return hist->max;
+}
+
+double fsm_hist_mean(const stc_fsm_hist_t *hist)
+{
+    return hist->count ? (double)hist->sum / (double)hist->count : 0.0;
+}
@@ -0,0 +1,226 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fsm_log.h"
+#include "fsm_loop.h"
+
+_Static_assert(sizeof(stc_fsm_log_record_t) == 16, "log record must be 16 bytes");
+_Static_assert(sizeof(stc_fsm_log_header_t) == 16, "log header must be 16 bytes");
+
+/**
+ * @brief   写入全部数据，被信号打断或者只写入一部分时继续
+*/
+static int log_write(int fd, const void *data, size_t size)
+{
+    const char *p = data;
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+int fsm_log_open(stc_fsm_log_t *log, const char *path, const stc_fsm_def_t *def)
+{
+    memset(log, 0, offsetof(stc_fsm_log_t, buffer));
+    log->fd = -1;
+    if (def->nstates >= FSM_LOG_NONE || def->nevents > UINT8_MAX)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    stc_fsm_log_header_t header = {
+        .magic = FSM_LOG_MAGIC,
+        .version = FSM_LOG_VERSION,
+        .record_size = sizeof(stc_fsm_log_record_t),
+        .nstates = (uint16_t)def->nstates,
+        .nevents = (uint16_t)def->nevents,
+    };
+    if (log_write(fd, &header, sizeof(header)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    log->fd = fd;
+    log->base = fsm_loop_now();
+    return 0;
+}
+
+int fsm_log_flush(stc_fsm_log_t *log)
+{
+    if (log->count == 0)
+    {
+        return 0;
+    }
+    if (log_write(log->fd, log->buffer, log->count * sizeof(stc_fsm_log_record_t)) != 0)
+    {
+        log->error = 1;
+    }
+    log->count = 0;
+    return log->error ? -1 : 0;
+}
+
+int fsm_log_close(stc_fsm_log_t *log)
+{
+    if (log->map != NULL)
+    {
+        munmap(log->map, log->map_size);
+        log->map = NULL;
+        log->records = NULL;
+    }
+    if (log->fd < 0)
+    {
+        return log->error ? -1 : 0;
+    }
+    fsm_log_flush(log);
+    if (close(log->fd) != 0)
+    {
+        log->error = 1;
+    }
+    log->fd = -1;
+    return log->error ? -1 : 0;
+}
+
+/**
+ * @brief   追加一条记录到缓冲区，缓冲区满时写入文件
+*/
+static void log_append(stc_fsm_log_t *log, uint8_t source, uint32_t data, uint8_t event, uint8_t before,
+                       uint8_t after)
+{
+    stc_fsm_log_record_t *record = &log->buffer[log->count];
+    record->time = log->now != NULL ? *log->now : fsm_loop_now() - log->base;
+    record->data = data;
+    record->source = source;
+    record->event = event;
+    record->before = before;
+    record->after = after;
+    log->written++;
+    if (++log->count == FSM_LOG_BUFFER)
+    {
+        fsm_log_flush(log);
+    }
+}
+
+void fsm_log_input(stc_fsm_log_t *log, uint8_t source, uint32_t data)
+{
+    if (log->fd >= 0)
+    {
+        log_append(log, source, data, 0, 0, 0);
+    }
+}
+
+/**
+ * @brief   记录一次不一致
+*/
+static void log_mismatch(stc_fsm_log_t *log, size_t index)
+{
+    if (log->mismatches++ == 0)
+    {
+        log->first_mismatch = index;
+    }
+}
+
+void fsm_log_dispatch(stc_fsm_log_t *log, const stc_fsm_instance_t *fsm, uint32_t event, uint32_t next_state)
+{
+    uint8_t after = next_state == FSM_NONE ? FSM_LOG_NONE : (uint8_t)next_state;
+    if (log->records == NULL)
+    {
+        if (log->fd >= 0)
+        {
+            log_append(log, FSM_LOG_DISPATCH, fsm->id, (uint8_t)event, (uint8_t)fsm->state, after);
+        }
+        return;
+    }
+    // 回放: 与下一条分派记录比较，日志中下一条不是分派记录时，本次分派是多出来的，不跳过记录
+    log->checked++;
+    if (log->next >= log->nrecords || log->records[log->next].source != FSM_LOG_DISPATCH)
+    {
+        log_mismatch(log, log->next);
+        return;
+    }
+    const stc_fsm_log_record_t *record = &log->records[log->next];
+    if (record->data != fsm->id || record->event != event || record->before != fsm->state
+        || record->after != after)
+    {
+        log_mismatch(log, log->next);
+    }
+    log->next++;
+}
+
+int fsm_log_replay(stc_fsm_log_t *log, const char *path, const stc_fsm_def_t *def, stc_fsm_sched_t *sched,
+                   fsm_log_input_t input, void *ctx)
+{
+    memset(log, 0, offsetof(stc_fsm_log_t, buffer));
+    log->fd = -1;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(stc_fsm_log_header_t))
+    {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+    const stc_fsm_log_header_t *header = map;
+    if (header->magic != FSM_LOG_MAGIC || header->version != FSM_LOG_VERSION
+        || header->record_size != sizeof(stc_fsm_log_record_t) || header->nstates != def->nstates
+        || header->nevents != def->nevents)
+    {
+        munmap(map, (size_t)st.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    log->map = map;
+    log->map_size = (size_t)st.st_size;
+    log->records = (const stc_fsm_log_record_t *)(header + 1);
+    // 记录时异常退出可能留下不完整的最后一条记录，忽略
+    log->nrecords = ((size_t)st.st_size - sizeof(*header)) / sizeof(stc_fsm_log_record_t);
+    log->first_mismatch = log->nrecords;
+
+    stc_fsm_log_t *saved = sched->log;
+    sched->log = log;
+    while (log->next < log->nrecords)
+    {
+        // 连续的输入按顺序交给应用，然后分派到没有事件为止，与记录时一轮处理的输入相同
+        while (log->next < log->nrecords && log->records[log->next].source != FSM_LOG_DISPATCH)
+        {
+            input(ctx, &log->records[log->next++]);
+        }
+        while (fsm_sched_run(sched) > 0);
+        // 回放时没有分派的记录
+        while (log->next < log->nrecords && log->records[log->next].source == FSM_LOG_DISPATCH)
+        {
+            log_mismatch(log, log->next++);
+        }
+    }
+    sched->log = saved;
+    return 0;
+}
@@ -0,0 +1,189 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include "fsm_loop.h"
+
+uint64_t fsm_loop_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int fsm_loop_init(stc_fsm_loop_t *loop, stc_fsm_sched_t *sched)
+{
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    loop->running = 0;
+    loop->sched = sched;
+    loop->round_cb = NULL;
+    fsm_hist_init(&loop->timer_latency);
+    fsm_hist_init(&loop->event_latency);
+    return loop->epfd >= 0 ? 0 : -1;
+}
+
+void fsm_loop_close(stc_fsm_loop_t *loop)
+{
+    if (loop->epfd >= 0)
+    {
+        close(loop->epfd);
+        loop->epfd = -1;
+    }
+}
+
+int fsm_loop_add(stc_fsm_loop_t *loop, stc_fsm_io_t *io, int fd, uint32_t events, fsm_io_cb_t cb, void *arg)
+{
+    io->fd = fd;
+    io->cb = cb;
+    io->arg = arg;
+    io->loop = loop;
+    io->timer = 0;
+    io->deadline = 0;
+    io->interval = 0;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = io;
+    return epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+void fsm_loop_del(stc_fsm_io_t *io)
+{
+    if (io->fd >= 0)
+    {
+        epoll_ctl(io->loop->epfd, EPOLL_CTL_DEL, io->fd, NULL);
+        close(io->fd);
+        io->fd = -1;
+    }
+}
+
+int fsm_loop_timer_init(stc_fsm_loop_t *loop, stc_fsm_io_t *timer, fsm_io_cb_t cb, void *arg)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fsm_loop_add(loop, timer, fd, EPOLLIN, cb, arg) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    timer->timer = 1;
+    return 0;
+}
+
+int fsm_loop_timer_start(stc_fsm_io_t *timer, uint64_t delay_ns)
+{
+    // 使用绝对时间，到期时间同时用于计算延迟
+    timer->deadline = fsm_loop_now() + (delay_ns ? delay_ns : 1);
+    timer->interval = 0;
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(timer->deadline / 1000000000u);
+    its.it_value.tv_nsec = (long)(timer->deadline % 1000000000u);
+    return timerfd_settime(timer->fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int fsm_loop_timer_periodic(stc_fsm_io_t *timer, uint64_t interval_ns)
+{
+    interval_ns = interval_ns ? interval_ns : 1;
+    timer->deadline = fsm_loop_now() + interval_ns;
+    timer->interval = interval_ns;
+    struct itimerspec its;
+    its.it_value.tv_sec = (time_t)(timer->deadline / 1000000000u);
+    its.it_value.tv_nsec = (long)(timer->deadline % 1000000000u);
+    its.it_interval.tv_sec = (time_t)(interval_ns / 1000000000u);
+    its.it_interval.tv_nsec = (long)(interval_ns % 1000000000u);
+    return timerfd_settime(timer->fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int fsm_loop_timer_stop(stc_fsm_io_t *timer)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    timer->deadline = 0;
+    timer->interval = 0;
+    return timerfd_settime(timer->fd, 0, &its, NULL);
+}
+
+int fsm_loop_signal_init(stc_fsm_loop_t *loop, stc_fsm_io_t *io, const sigset_t *mask, fsm_io_cb_t cb, void *arg)
+{
+    if (sigprocmask(SIG_BLOCK, mask, NULL) != 0)
+    {
+        return -1;
+    }
+    int fd = signalfd(-1, mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fsm_loop_add(loop, io, fd, EPOLLIN, cb, arg) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+int fsm_loop_run(stc_fsm_loop_t *loop)
+{
+    struct epoll_event events[FSM_LOOP_EVENTS];
+    loop->running = 1;
+    while (loop->running)
+    {
+        int n = epoll_wait(loop->epfd, events, FSM_LOOP_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        uint64_t ready = fsm_loop_now();
+        for (int i = 0; i < n; i++)
+        {
+            stc_fsm_io_t *io = events[i].data.ptr;
+            if (io->timer)
+            {
+                // 定时器: 读取到期次数，记录延迟；已经被停止或者重新启动时读取失败，忽略
+                uint64_t expirations;
+                if (read(io->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+                {
+                    continue;
+                }
+                // 周期定时器按最后一次到期时间计算延迟
+                uint64_t due = io->deadline + (expirations - 1) * io->interval;
+                fsm_hist_add(&loop->timer_latency, ready > due ? ready - due : 0);
+                io->deadline = io->interval ? due + io->interval : 0;
+            }
+            io->cb(io, events[i].events);
+        }
+        // 本轮回调投递的事件全部分派完成
+        if (loop->sched != NULL)
+        {
+            size_t dispatched = 0;
+            size_t count;
+            while ((count = fsm_sched_run(loop->sched)) > 0)
+            {
+                dispatched += count;
+            }
+            if (dispatched > 0)
+            {
+                fsm_hist_add(&loop->event_latency, fsm_loop_now() - ready);
+            }
+        }
+        if (loop->round_cb != NULL)
+        {
+            loop->round_cb(loop);
+        }
+    }
+    return 0;
+}
+
+void fsm_loop_stop(stc_fsm_loop_t *loop)
+{
+    loop->running = 0;
+}
@@ -0,0 +1,251 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "fsm_pool.h"
+
+// 线程参数
+typedef struct
+{
+    stc_fsm_pool_t *pool;
+    uint32_t index;
+    int started;            // 线程是否创建成功
+    pthread_t thread;
+}stc_pool_arg_t;
+
+int fsm_pool_init(stc_fsm_pool_t *pool, uint32_t nworkers)
+{
+    cpu_set_t set;
+    int ncpus = 0;
+    int cpus[CPU_SETSIZE];
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                cpus[ncpus++] = cpu;
+            }
+        }
+    }
+    if (nworkers == 0)
+    {
+        nworkers = ncpus > 0 ? (uint32_t)ncpus : 1;
+    }
+    pool->workers = aligned_alloc(64, nworkers * sizeof(stc_fsm_pool_worker_t));
+    if (pool->workers == NULL)
+    {
+        return -1;
+    }
+    pool->nworkers = nworkers;
+    pool->fn = NULL;
+    pool->arg = NULL;
+    pool->remaining = 0;
+    for (uint32_t i = 0; i < nworkers; i++)
+    {
+        stc_fsm_pool_worker_t *w = &pool->workers[i];
+        w->top = 0;
+        w->bottom = 0;
+        w->jobs = NULL;
+        w->mask = 0;
+        w->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+        w->executed = 0;
+        w->stolen = 0;
+        w->cpu = ncpus > 0 ? cpus[i % (uint32_t)ncpus] : -1;
+    }
+    return 0;
+}
+
+void fsm_pool_free(stc_fsm_pool_t *pool)
+{
+    free(pool->workers);
+    pool->workers = NULL;
+    pool->nworkers = 0;
+}
+
+/**
+ * @brief   从自己队列的底部取出作业(只能由队列所属的线程调用)
+ * @return  成功返回1，队列为空返回0
+*/
+static int deque_pop(stc_fsm_pool_worker_t *w, uint64_t *job)
+{
+    int64_t b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&w->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&w->top, __ATOMIC_RELAXED);
+    if (t > b)
+    {
+        __atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    *job = __atomic_load_n(&w->jobs[b & w->mask], __ATOMIC_RELAXED);
+    if (t == b)
+    {
+        // 最后一个作业，与窃取的线程竞争
+        int won = __atomic_compare_exchange_n(&w->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+        return won;
+    }
+    return 1;
+}
+
+/**
+ * @brief   从其他线程队列的顶部窃取作业
+ * @return  成功返回1，队列为空或者与其他线程竞争失败返回0
+*/
+static int deque_steal(stc_fsm_pool_worker_t *w, uint64_t *job)
+{
+    int64_t t = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&w->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+    {
+        return 0;
+    }
+    *job = __atomic_load_n(&w->jobs[t & w->mask], __ATOMIC_RELAXED);
+    return __atomic_compare_exchange_n(&w->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   从随机的线程开始依次尝试窃取
+*/
+static int pool_steal(stc_fsm_pool_t *pool, uint32_t index, uint64_t *job)
+{
+    stc_fsm_pool_worker_t *self = &pool->workers[index];
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 7;
+    self->rng ^= self->rng << 17;
+    uint32_t start = (uint32_t)(self->rng % pool->nworkers);
+    for (uint32_t i = 0; i < pool->nworkers; i++)
+    {
+        uint32_t victim = (start + i) % pool->nworkers;
+        if (victim != index && deque_steal(&pool->workers[victim], job))
+        {
+            self->stolen++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   工作线程: 执行自己以及窃取的作业，直到所有作业完成
+*/
+static void pool_work(stc_fsm_pool_t *pool, uint32_t index)
+{
+    stc_fsm_pool_worker_t *w = &pool->workers[index];
+    while (__atomic_load_n(&pool->remaining, __ATOMIC_ACQUIRE) > 0)
+    {
+        uint64_t job;
+        if (deque_pop(w, &job) || pool_steal(pool, index, &job))
+        {
+            pool->fn(pool->arg, index, job);
+            w->executed++;
+            __atomic_fetch_sub(&pool->remaining, 1, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            // 剩余的作业都在其他线程上执行
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief   绑定当前线程到工作线程的CPU
+*/
+static void pool_bind(const stc_fsm_pool_worker_t *w)
+{
+    if (w->cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+static void *pool_thread(void *arg)
+{
+    stc_pool_arg_t *a = arg;
+    pool_bind(&a->pool->workers[a->index]);
+    pool_work(a->pool, a->index);
+    return NULL;
+}
+
+int fsm_pool_run(stc_fsm_pool_t *pool, uint64_t njobs, fsm_pool_fn_t fn, void *arg)
+{
+    uint32_t n = pool->nworkers;
+    uint64_t per = (njobs + n - 1) / n;
+    uint64_t capacity = 1;
+    while (capacity < per)
+    {
+        capacity <<= 1;
+    }
+    stc_pool_arg_t *args = malloc(n * sizeof(stc_pool_arg_t));
+    int failed = args == NULL;
+    for (uint32_t i = 0; i < n && !failed; i++)
+    {
+        pool->workers[i].jobs = malloc(capacity * sizeof(uint64_t));
+        failed = pool->workers[i].jobs == NULL;
+    }
+    if (failed)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            free(pool->workers[i].jobs);
+            pool->workers[i].jobs = NULL;
+        }
+        free(args);
+        return -1;
+    }
+
+    // 作业按编号连续均分，编号小的在队列底部，先被自己执行
+    for (uint32_t i = 0; i < n; i++)
+    {
+        stc_fsm_pool_worker_t *w = &pool->workers[i];
+        uint64_t lo = njobs * i / n;
+        uint64_t hi = njobs * (i + 1) / n;
+        for (uint64_t j = 0; j < hi - lo; j++)
+        {
+            w->jobs[j] = hi - 1 - j;
+        }
+        w->mask = capacity - 1;
+        w->top = 0;
+        w->bottom = (int64_t)(hi - lo);
+    }
+    pool->fn = fn;
+    pool->arg = arg;
+    __atomic_store_n(&pool->remaining, njobs, __ATOMIC_RELEASE);
+
+    // 创建失败的线程的作业由其他线程窃取
+    for (uint32_t i = 1; i < n; i++)
+    {
+        args[i].pool = pool;
+        args[i].index = i;
+        args[i].started = pthread_create(&args[i].thread, NULL, pool_thread, &args[i]) == 0;
+    }
+    cpu_set_t saved;
+    int restore = sched_getaffinity(0, sizeof(saved), &saved) == 0;
+    pool_bind(&pool->workers[0]);
+    pool_work(pool, 0);
+    if (restore)
+    {
+        sched_setaffinity(0, sizeof(saved), &saved);
+    }
+    for (uint32_t i = 1; i < n; i++)
+    {
+        if (args[i].started)
+        {
+            pthread_join(args[i].thread, NULL);
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        free(pool->workers[i].jobs);
+        pool->workers[i].jobs = NULL;
+    }
+    free(args);
+    return 0;
+}
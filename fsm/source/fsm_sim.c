@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include "fsm_sim.h"
+
+/**
+ * @brief   a 是否早于 b，到期时间相同时比较启动顺序
+*/
+static inline int event_before(const stc_fsm_sim_event_t *a, const stc_fsm_sim_event_t *b)
+{
+    return a->time < b->time || (a->time == b->time && (int32_t)(a->seq - b->seq) < 0);
+}
+
+int fsm_sim_init(stc_fsm_sim_t *sim, uint32_t capacity, stc_fsm_sched_t *sched, fsm_sim_cb_t expire)
+{
+    capacity = capacity ? capacity : 16;
+    sim->heap = malloc((size_t)capacity * sizeof(stc_fsm_sim_event_t));
+    if (sim->heap == NULL)
+    {
+        return -1;
+    }
+    sim->now = 0;
+    sim->seq = 0;
+    sim->size = 0;
+    sim->capacity = capacity;
+    sim->expire = expire;
+    sim->sched = sched;
+    sim->events = 0;
+    return 0;
+}
+
+void fsm_sim_free(stc_fsm_sim_t *sim)
+{
+    free(sim->heap);
+    sim->heap = NULL;
+    sim->size = 0;
+    sim->capacity = 0;
+}
+
+int fsm_sim_start(stc_fsm_sim_t *sim, uint64_t delay, void *arg, uint32_t data)
+{
+    if (sim->size == sim->capacity)
+    {
+        stc_fsm_sim_event_t *heap = realloc(sim->heap, (size_t)sim->capacity * 2 * sizeof(*heap));
+        if (heap == NULL)
+        {
+            return -1;
+        }
+        sim->heap = heap;
+        sim->capacity *= 2;
+    }
+    stc_fsm_sim_event_t event = { sim->now + delay, sim->seq++, data, arg };
+    // 上浮: 父节点下移，最后一次写入
+    uint32_t i = sim->size++;
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (!event_before(&event, &sim->heap[parent]))
+        {
+            break;
+        }
+        sim->heap[i] = sim->heap[parent];
+        i = parent;
+    }
+    sim->heap[i] = event;
+    return 0;
+}
+
+/**
+ * @brief   取出堆顶
+*/
+static stc_fsm_sim_event_t sim_pop(stc_fsm_sim_t *sim)
+{
+    stc_fsm_sim_event_t top = sim->heap[0];
+    stc_fsm_sim_event_t last = sim->heap[--sim->size];
+    // 下沉: 较早的子节点上移，最后一次写入
+    uint32_t i = 0;
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= sim->size)
+        {
+            break;
+        }
+        if (child + 1 < sim->size && event_before(&sim->heap[child + 1], &sim->heap[child]))
+        {
+            child++;
+        }
+        if (!event_before(&sim->heap[child], &last))
+        {
+            break;
+        }
+        sim->heap[i] = sim->heap[child];
+        i = child;
+    }
+    if (sim->size > 0)
+    {
+        sim->heap[i] = last;
+    }
+    return top;
+}
+
+int fsm_sim_step(stc_fsm_sim_t *sim)
+{
+    if (sim->size == 0)
+    {
+        return 0;
+    }
+    stc_fsm_sim_event_t event = sim_pop(sim);
+    sim->now = event.time;
+    sim->events++;
+    sim->expire(event.arg, event.data);
+    if (sim->sched != NULL)
+    {
+        while (fsm_sched_run(sim->sched) > 0);
+    }
+    return 1;
+}
+
+size_t fsm_sim_run(stc_fsm_sim_t *sim, uint64_t until)
+{
+    size_t count = 0;
+    while (sim->size > 0 && sim->heap[0].time <= until)
+    {
+        fsm_sim_step(sim);
+        count++;
+    }
+    if (sim->now < until)
+    {
+        sim->now = until;
+    }
+    return count;
+}
+
+static int sim_clock_start(void *impl, uint64_t ticks, void *arg, uint32_t data)
+{
+    return fsm_sim_start(impl, ticks, arg, data);
+}
+
+void fsm_sim_clock(stc_fsm_sim_t *sim, stc_fsm_clock_t *clock)
+{
+    clock->impl = sim;
+    clock->now = &sim->now;
+    clock->start = sim_clock_start;
+}
@@ -0,0 +1,463 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "fsm_snap.h"
+
+_Static_assert(sizeof(stc_fsm_snap_header_t) == 32, "snapshot header must be 32 bytes");
+_Static_assert(sizeof(stc_fsm_snap_section_t) == 24, "snapshot section must be 24 bytes");
+
+/**
+ * @brief   写入全部数据，被信号打断或者只写入一部分时继续
+*/
+static int snap_write_all(int fd, const void *data, size_t size)
+{
+    const char *p = data;
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static void snap_flush(stc_fsm_snap_t *snap)
+{
+    if (snap->used > 0 && snap_write_all(snap->fd, snap->buffer, snap->used) != 0)
+    {
+        snap->error = 1;
+    }
+    snap->used = 0;
+}
+
+/**
+ * @brief   经过缓冲区写入
+*/
+static void snap_bytes(stc_fsm_snap_t *snap, const void *data, size_t size)
+{
+    const char *p = data;
+    snap->offset += size;
+    while (size > 0)
+    {
+        size_t n = sizeof(snap->buffer) - snap->used;
+        n = n < size ? n : size;
+        memcpy(snap->buffer + snap->used, p, n);
+        snap->used += (uint32_t)n;
+        p += n;
+        size -= n;
+        if (snap->used == sizeof(snap->buffer))
+        {
+            snap_flush(snap);
+        }
+    }
+}
+
+/**
+ * @brief   填充到8字节对齐
+*/
+static void snap_align(stc_fsm_snap_t *snap)
+{
+    static const char zero[8];
+    if (snap->offset & 7)
+    {
+        snap_bytes(snap, zero, 8 - (snap->offset & 7));
+    }
+}
+
+int fsm_snap_begin(stc_fsm_snap_t *snap, const char *path, uint64_t generation)
+{
+    snap->fd = -1;
+    snap->error = 0;
+    snap->offset = 0;
+    snap->nsections = 0;
+    snap->used = 0;
+    memset(&snap->header, 0, sizeof(snap->header));
+    snap->header.generation = generation;
+    // 临时文件带进程号，多个写入者不会互相覆盖
+    int n = snprintf(snap->path, sizeof(snap->path), "%s.%d.tmp", path, (int)getpid());
+    if (n < 0 || (size_t)n >= sizeof(snap->path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    snap->fd = open(snap->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (snap->fd < 0)
+    {
+        return -1;
+    }
+    // 文件头在提交时写入
+    snap_bytes(snap, &snap->header, sizeof(snap->header));
+    return 0;
+}
+
+int fsm_snap_section(stc_fsm_snap_t *snap, uint32_t type, uint32_t size)
+{
+    if (snap->nsections == FSM_SNAP_SECTIONS)
+    {
+        snap->error = 1;
+        return -1;
+    }
+    snap_align(snap);
+    stc_fsm_snap_section_t *section = &snap->sections[snap->nsections++];
+    section->type = type;
+    section->size = size;
+    section->count = 0;
+    section->offset = snap->offset;
+    return 0;
+}
+
+void fsm_snap_put(stc_fsm_snap_t *snap, const void *records, uint64_t count)
+{
+    if (snap->nsections == 0)
+    {
+        snap->error = 1;
+        return;
+    }
+    stc_fsm_snap_section_t *section = &snap->sections[snap->nsections - 1];
+    snap_bytes(snap, records, (size_t)(count * section->size));
+    section->count += count;
+}
+
+void fsm_snap_put_instance(stc_fsm_snap_t *snap, const stc_fsm_instance_t *fsm)
+{
+    stc_fsm_snap_instance_t record;
+    memset(&record, 0, sizeof(record));
+    record.id = fsm->id;
+    record.state = __atomic_load_n(&fsm->state, __ATOMIC_RELAXED);
+    // 从读位置开始，已经发布的槽位都是尚未分派的事件
+    for (uint32_t pos = fsm->head; record.npending < FSM_QUEUE_SIZE; pos++)
+    {
+        const stc_fsm_slot_t *slot = &fsm->slots[pos & (FSM_QUEUE_SIZE - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1)
+        {
+            break;
+        }
+        record.pending[record.npending++] = slot->event;
+    }
+    fsm_snap_put(snap, &record, 1);
+}
+
+/**
+ * @brief   仿真器定时器的到期顺序
+*/
+static int sim_event_cmp(const void *a, const void *b)
+{
+    const stc_fsm_sim_event_t *x = a;
+    const stc_fsm_sim_event_t *y = b;
+    if (x->time != y->time)
+    {
+        return x->time < y->time ? -1 : 1;
+    }
+    return (int32_t)(x->seq - y->seq) < 0 ? -1 : (x->seq != y->seq);
+}
+
+int fsm_snap_put_sim(stc_fsm_snap_t *snap, const stc_fsm_sim_t *sim, uint32_t (*id)(void *arg))
+{
+    if (fsm_snap_section(snap, FSM_SNAP_TIMERS, sizeof(stc_fsm_snap_timer_t)) != 0)
+    {
+        return -1;
+    }
+    stc_fsm_sim_event_t *events = malloc((sim->size ? sim->size : 1) * sizeof(stc_fsm_sim_event_t));
+    if (events == NULL)
+    {
+        snap->error = 1;
+        return -1;
+    }
+    // 堆只部分有序，按到期顺序排序
+    memcpy(events, sim->heap, sim->size * sizeof(stc_fsm_sim_event_t));
+    qsort(events, sim->size, sizeof(stc_fsm_sim_event_t), sim_event_cmp);
+    for (uint32_t i = 0; i < sim->size; i++)
+    {
+        stc_fsm_snap_timer_t record = {
+            .remaining = events[i].time > sim->now ? events[i].time - sim->now : 0,
+            .id = id(events[i].arg),
+            .data = events[i].data,
+        };
+        fsm_snap_put(snap, &record, 1);
+    }
+    free(events);
+    return 0;
+}
+
+// 时间轮中运行的定时器，按到期时间排序
+typedef struct
+{
+    uint64_t expires;
+    uint32_t index;
+}stc_wheel_running_t;
+
+static int wheel_running_cmp(const void *a, const void *b)
+{
+    const stc_wheel_running_t *x = a;
+    const stc_wheel_running_t *y = b;
+    if (x->expires != y->expires)
+    {
+        return x->expires < y->expires ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+int fsm_snap_put_wheel(stc_fsm_snap_t *snap, const stc_fsm_wheel_t *wheel, uint32_t (*id)(void *arg))
+{
+    if (fsm_snap_section(snap, FSM_SNAP_TIMERS, sizeof(stc_fsm_snap_timer_t)) != 0)
+    {
+        return -1;
+    }
+    stc_wheel_running_t *running = malloc((wheel->count ? wheel->count : 1) * sizeof(stc_wheel_running_t));
+    if (running == NULL)
+    {
+        snap->error = 1;
+        return -1;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < wheel->capacity && n < wheel->count; i++)
+    {
+        if (wheel->nodes[i].slot != UINT16_MAX)
+        {
+            running[n].expires = wheel->nodes[i].expires;
+            running[n++].index = i;
+        }
+    }
+    qsort(running, n, sizeof(stc_wheel_running_t), wheel_running_cmp);
+    // now 可能落后于当前时间，剩余时间按当前的tick计算，已经到期还没有处理的定时器剩余时间为0
+    uint64_t current = fsm_wheel_current(wheel);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const stc_fsm_timer_node_t *node = &wheel->nodes[running[i].index];
+        stc_fsm_snap_timer_t record = {
+            .remaining = node->expires > current ? node->expires - current : 0,
+            .id = id(node->arg),
+            .data = node->data,
+        };
+        fsm_snap_put(snap, &record, 1);
+    }
+    free(running);
+    return 0;
+}
+
+int fsm_snap_commit(stc_fsm_snap_t *snap, const char *path)
+{
+    snap_align(snap);
+    snap->header.magic = FSM_SNAP_MAGIC;
+    snap->header.version = FSM_SNAP_VERSION;
+    snap->header.nsections = (uint16_t)snap->nsections;
+    snap->header.table = snap->offset;
+    snap_bytes(snap, snap->sections, snap->nsections * sizeof(stc_fsm_snap_section_t));
+    snap_flush(snap);
+    if (!snap->error && (pwrite(snap->fd, &snap->header, sizeof(snap->header), 0) != sizeof(snap->header)
+                         || fsync(snap->fd) != 0))
+    {
+        snap->error = 1;
+    }
+    if (close(snap->fd) != 0)
+    {
+        snap->error = 1;
+    }
+    snap->fd = -1;
+    // 重命名是原子的，读取者只会看到完整的快照
+    if (snap->error || rename(snap->path, path) != 0)
+    {
+        unlink(snap->path);
+        return -1;
+    }
+    return 0;
+}
+
+int fsm_snap_write(const char *path, uint64_t generation, fsm_snap_fill_t fill, void *ctx)
+{
+    stc_fsm_snap_t *snap = malloc(sizeof(stc_fsm_snap_t));
+    if (snap == NULL)
+    {
+        return -1;
+    }
+    int ret = -1;
+    if (fsm_snap_begin(snap, path, generation) == 0)
+    {
+        if (fill(snap, ctx) != 0)
+        {
+            snap->error = 1;
+        }
+        ret = fsm_snap_commit(snap, path);
+    }
+    free(snap);
+    return ret;
+}
+
+int fsm_snap_open(stc_fsm_snap_map_t *map, const char *path)
+{
+    memset(map, 0, sizeof(*map));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(stc_fsm_snap_header_t))
+    {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        return -1;
+    }
+    map->map = p;
+    map->size = (size_t)st.st_size;
+    map->header = p;
+    const stc_fsm_snap_header_t *header = map->header;
+    if (header->magic != FSM_SNAP_MAGIC || header->version != FSM_SNAP_VERSION || (header->table & 7)
+        || header->table > map->size
+        || (map->size - header->table) / sizeof(stc_fsm_snap_section_t) < header->nsections)
+    {
+        fsm_snap_close(map);
+        errno = EINVAL;
+        return -1;
+    }
+    map->sections = (const stc_fsm_snap_section_t *)((const char *)p + header->table);
+    return 0;
+}
+
+void fsm_snap_close(stc_fsm_snap_map_t *map)
+{
+    if (map->map != NULL)
+    {
+        munmap(map->map, map->size);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+const void *fsm_snap_find(const stc_fsm_snap_map_t *map, uint32_t type, uint32_t size, uint64_t *count)
+{
+    for (uint32_t i = 0; i < map->header->nsections; i++)
+    {
+        const stc_fsm_snap_section_t *section = &map->sections[i];
+        if (section->type != type)
+        {
+            continue;
+        }
+        // 记录的大小不同说明格式不兼容，越界说明文件损坏
+        if (section->size != size || section->offset > map->header->table
+            || (map->header->table - section->offset) / size < section->count)
+        {
+            return NULL;
+        }
+        *count = section->count;
+        return (const char *)map->map + section->offset;
+    }
+    return NULL;
+}
+
+int fsm_snap_restore_instance(stc_fsm_instance_t *fsm, const stc_fsm_snap_instance_t *record)
+{
+    if (record->id != fsm->id || record->state >= fsm->def->nstates || record->npending > FSM_QUEUE_SIZE)
+    {
+        return -1;
+    }
+    fsm->state = record->state;
+    for (uint32_t i = 0; i < record->npending; i++)
+    {
+        if (record->pending[i] >= fsm->def->nevents || fsm_post(fsm, record->pending[i]) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int fsm_snap_restore_timers(const stc_fsm_snap_map_t *map, const stc_fsm_clock_t *clock,
+                            void *(*arg)(uint32_t id))
+{
+    uint64_t count;
+    const stc_fsm_snap_timer_t *timers = fsm_snap_find(map, FSM_SNAP_TIMERS, sizeof(stc_fsm_snap_timer_t), &count);
+    if (timers == NULL)
+    {
+        return -1;
+    }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        void *p = arg(timers[i].id);
+        if (p != NULL && clock->start(clock->impl, timers[i].remaining, p, timers[i].data) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void fsm_checkpoint_init(stc_fsm_checkpoint_t *cp, const char *path, fsm_snap_fill_t fill, void *ctx)
+{
+    memset(cp, 0, sizeof(*cp));
+    cp->path = path;
+    cp->fill = fill;
+    cp->ctx = ctx;
+    cp->version = UINT64_MAX;
+}
+
+int fsm_checkpoint_start(stc_fsm_checkpoint_t *cp, uint64_t version)
+{
+    // 上一个检查点还在写入，或者状态没有变化
+    if (fsm_checkpoint_wait(cp, 0) != 0 || version == cp->version)
+    {
+        cp->skipped++;
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        cp->failed++;
+        return -1;
+    }
+    if (pid == 0)
+    {
+        // 子进程: 写入 fork 时刻的状态，不执行父进程的 atexit 以及刷新 stdio 缓冲区
+        _exit(fsm_snap_write(cp->path, cp->generation, cp->fill, cp->ctx) == 0 ? 0 : 1);
+    }
+    cp->child = pid;
+    cp->generation++;
+    cp->version = version;
+    return 0;
+}
+
+int fsm_checkpoint_wait(stc_fsm_checkpoint_t *cp, int block)
+{
+    if (cp->child == 0)
+    {
+        return 0;
+    }
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(cp->child, &status, block ? 0 : WNOHANG)) < 0 && errno == EINTR);
+    if (pid == 0)
+    {
+        return 1;
+    }
+    if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+    {
+        cp->written++;
+    }
+    else
+    {
+        cp->failed++;
+        // 失败后下一次不跳过
+        cp->version = UINT64_MAX;
+    }
+    cp->child = 0;
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fsm_loop.h"
+#include "fsm_stats.h"
+
+_Static_assert((FSM_STATS_SAMPLE & (FSM_STATS_SAMPLE - 1)) == 0, "FSM_STATS_SAMPLE must be a power of 2");
+
+// 导出的分位数
+static const double stats_quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+int fsm_stats_init(stc_fsm_stats_t *stats, const stc_fsm_def_t *def, const char *const *state_names,
+                   const char *const *event_names)
+{
+    stats->def = def;
+    stats->state_names = state_names;
+    stats->event_names = event_names;
+    stats->sample_mask = FSM_STATS_SAMPLE - 1;
+    stats->transitions = calloc((size_t)def->nstates * def->nevents, sizeof(uint64_t));
+    stats->dwell = malloc(def->nstates * sizeof(stc_fsm_hist_t));
+    stats->latency = malloc(def->nevents * sizeof(stc_fsm_hist_t));
+    if (stats->transitions == NULL || stats->dwell == NULL || stats->latency == NULL)
+    {
+        fsm_stats_free(stats);
+        return -1;
+    }
+    fsm_stats_reset(stats);
+    return 0;
+}
+
+void fsm_stats_free(stc_fsm_stats_t *stats)
+{
+    free(stats->transitions);
+    free(stats->dwell);
+    free(stats->latency);
+    stats->transitions = NULL;
+    stats->dwell = NULL;
+    stats->latency = NULL;
+}
+
+void fsm_stats_reset(stc_fsm_stats_t *stats)
+{
+    memset(stats->transitions, 0, (size_t)stats->def->nstates * stats->def->nevents * sizeof(uint64_t));
+    for (uint32_t i = 0; i < stats->def->nstates; i++)
+    {
+        fsm_hist_init(&stats->dwell[i]);
+    }
+    for (uint32_t i = 0; i < stats->def->nevents; i++)
+    {
+        fsm_hist_init(&stats->latency[i]);
+    }
+}
+
+uint64_t fsm_stats_now(void)
+{
+    return fsm_loop_now();
+}
+
+/**
+ * @brief   单个写入者的计数: 原子写入使其他线程的快照读取不会读到撕裂的值，不需要读改写指令
+*/
+static inline void stats_add(uint64_t *counter, uint64_t v)
+{
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t stats_load(const uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   fsm_hist_add 的单写入者原子版本
+ * @note    最后写样本数(release)，快照先读样本数，桶的总和不少于读到的样本数
+*/
+static void stats_hist_add(stc_fsm_hist_t *hist, uint64_t v)
+{
+    stats_add(&hist->buckets[fsm_hist_index(v)], 1);
+    stats_add(&hist->sum, v);
+    if (v < stats_load(&hist->min))
+    {
+        __atomic_store_n(&hist->min, v, __ATOMIC_RELAXED);
+    }
+    if (v > stats_load(&hist->max))
+    {
+        __atomic_store_n(&hist->max, v, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&hist->count, hist->count + 1, __ATOMIC_RELEASE);
+}
+
+void fsm_stats_record(stc_fsm_stats_t *stats, stc_fsm_instance_t *fsm, uint32_t event, uint32_t next_state,
+                      uint64_t posted, uint64_t now)
+{
+    stats_add(&stats->transitions[(size_t)fsm->state * stats->def->nevents + event], 1);
+    // 没有抽样或者开启统计之前投递的事件没有投递时间
+    if (posted != 0)
+    {
+        uint64_t dispatched = fsm_stats_now();
+        stats_hist_add(&stats->latency[event], dispatched > posted ? dispatched - posted : 0);
+    }
+    if (next_state != FSM_NONE && next_state != fsm->state)
+    {
+        if (fsm->entered != 0)
+        {
+            stats_hist_add(&stats->dwell[fsm->state], now > fsm->entered ? now - fsm->entered : 0);
+        }
+        fsm->entered = now;
+    }
+    else if (fsm->entered == 0)
+    {
+        fsm->entered = now;
+    }
+}
+
+/**
+ * @brief   读取 src 的快照并累加到 dst
+*/
+static void stats_hist_merge(stc_fsm_hist_t *dst, const stc_fsm_hist_t *src)
+{
+    // 先读样本数，百分位数不会超出桶的范围
+    dst->count += __atomic_load_n(&src->count, __ATOMIC_ACQUIRE);
+    dst->sum += stats_load(&src->sum);
+    uint64_t min = stats_load(&src->min);
+    uint64_t max = stats_load(&src->max);
+    dst->min = min < dst->min ? min : dst->min;
+    dst->max = max > dst->max ? max : dst->max;
+    for (uint32_t i = 0; i < FSM_HIST_BUCKETS; i++)
+    {
+        dst->buckets[i] += stats_load(&src->buckets[i]);
+    }
+}
+
+void fsm_stats_merge(stc_fsm_stats_t *dst, const stc_fsm_stats_t *src)
+{
+    const stc_fsm_def_t *def = src->def;
+    for (size_t i = 0; i < (size_t)def->nstates * def->nevents; i++)
+    {
+        dst->transitions[i] += stats_load(&src->transitions[i]);
+    }
+    for (uint32_t i = 0; i < def->nstates; i++)
+    {
+        stats_hist_merge(&dst->dwell[i], &src->dwell[i]);
+    }
+    for (uint32_t i = 0; i < def->nevents; i++)
+    {
+        stats_hist_merge(&dst->latency[i], &src->latency[i]);
+    }
+}
+
+/**
+ * @brief   输出名称，没有名称时输出编号
+*/
+static void stats_name(FILE *out, const char *const *names, uint32_t index)
+{
+    if (names != NULL)
+    {
+        fputs(names[index], out);
+    }
+    else
+    {
+        fprintf(out, "%u", index);
+    }
+}
+
+/**
+ * @brief   输出 Prometheus summary 的一组样本(秒)
+*/
+static void prometheus_summary(FILE *out, const char *prefix, const char *metric, const char *label,
+                               const char *const *names, uint32_t index, const stc_fsm_hist_t *hist)
+{
+    for (size_t q = 0; q < sizeof(stats_quantiles) / sizeof(stats_quantiles[0]); q++)
+    {
+        fprintf(out, "%s_%s{%s=\"", prefix, metric, label);
+        stats_name(out, names, index);
+        fprintf(out, "\",quantile=\"%g\"} %.9f\n", stats_quantiles[q],
+                fsm_hist_percentile(hist, stats_quantiles[q] * 100) * 1e-9);
+    }
+    fprintf(out, "%s_%s_sum{%s=\"", prefix, metric, label);
+    stats_name(out, names, index);
+    fprintf(out, "\"} %.9f\n", hist->sum * 1e-9);
+    fprintf(out, "%s_%s_count{%s=\"", prefix, metric, label);
+    stats_name(out, names, index);
+    fprintf(out, "\"} %llu\n", (unsigned long long)hist->count);
+}
+
+void fsm_stats_prometheus(const stc_fsm_stats_t *stats, FILE *out, const char *prefix)
+{
+    const stc_fsm_def_t *def = stats->def;
+    fprintf(out, "# HELP %s_transitions_total Events dispatched per [state][event]; next=\"none\" if ignored.\n",
+            prefix);
+    fprintf(out, "# TYPE %s_transitions_total counter\n", prefix);
+    for (uint32_t s = 0; s < def->nstates; s++)
+    {
+        for (uint32_t e = 0; e < def->nevents; e++)
+        {
+            const stc_fsm_entry_t *entry = fsm_def_lookup(def, s, e);
+            fprintf(out, "%s_transitions_total{state=\"", prefix);
+            stats_name(out, stats->state_names, s);
+            fputs("\",event=\"", out);
+            stats_name(out, stats->event_names, e);
+            fputs("\",next=\"", out);
+            if (entry != NULL)
+            {
+                stats_name(out, stats->state_names, entry->next_state);
+            }
+            else
+            {
+                fputs("none", out);
+            }
+            fprintf(out, "\"} %llu\n", (unsigned long long)stats->transitions[(size_t)s * def->nevents + e]);
+        }
+    }
+    fprintf(out, "# HELP %s_dwell_seconds Time spent in a state before leaving it.\n", prefix);
+    fprintf(out, "# TYPE %s_dwell_seconds summary\n", prefix);
+    for (uint32_t s = 0; s < def->nstates; s++)
+    {
+        prometheus_summary(out, prefix, "dwell_seconds", "state", stats->state_names, s, &stats->dwell[s]);
+    }
+    fprintf(out, "# HELP %s_latency_seconds Time from posting an event to dispatching it.\n", prefix);
+    fprintf(out, "# TYPE %s_latency_seconds summary\n", prefix);
+    for (uint32_t e = 0; e < def->nevents; e++)
+    {
+        prometheus_summary(out, prefix, "latency_seconds", "event", stats->event_names, e, &stats->latency[e]);
+    }
+}
+
+/**
+ * @brief   输出 JSON 字符串形式的名称
+*/
+static void json_name(FILE *out, const char *const *names, uint32_t index)
+{
+    fputc('"', out);
+    stats_name(out, names, index);
+    fputc('"', out);
+}
+
+static void json_hist(FILE *out, const stc_fsm_hist_t *hist)
+{
+    fprintf(out, "{\"count\": %llu, \"sum\": %llu, \"min\": %llu, \"max\": %llu", (unsigned long long)hist->count,
+            (unsigned long long)hist->sum, (unsigned long long)(hist->count ? hist->min : 0),
+            (unsigned long long)hist->max);
+    for (size_t q = 0; q < sizeof(stats_quantiles) / sizeof(stats_quantiles[0]); q++)
+    {
+        fprintf(out, ", \"p%g\": %llu", stats_quantiles[q] * 100,
+                (unsigned long long)fsm_hist_percentile(hist, stats_quantiles[q] * 100));
+    }
+    fputc('}', out);
+}
+
+void fsm_stats_json(const stc_fsm_stats_t *stats, FILE *out)
+{
+    const stc_fsm_def_t *def = stats->def;
+    fputs("{\"transitions\": [", out);
+    const char *sep = "";
+    for (uint32_t s = 0; s < def->nstates; s++)
+    {
+        for (uint32_t e = 0; e < def->nevents; e++)
+        {
+            const stc_fsm_entry_t *entry = fsm_def_lookup(def, s, e);
+            fprintf(out, "%s\n  {\"state\": ", sep);
+            json_name(out, stats->state_names, s);
+            fputs(", \"event\": ", out);
+            json_name(out, stats->event_names, e);
+            fputs(", \"next\": ", out);
+            if (entry != NULL)
+            {
+                json_name(out, stats->state_names, entry->next_state);
+            }
+            else
+            {
+                fputs("null", out);
+            }
+            fprintf(out, ", \"count\": %llu}", (unsigned long long)stats->transitions[(size_t)s * def->nevents + e]);
+            sep = ",";
+        }
+    }
+    fputs("],\n \"dwell_ns\": {", out);
+    for (uint32_t s = 0; s < def->nstates; s++)
+    {
+        fputs(s ? ",\n  " : "\n  ", out);
+        json_name(out, stats->state_names, s);
+        fputs(": ", out);
+        json_hist(out, &stats->dwell[s]);
+    }
+    fputs("},\n \"latency_ns\": {", out);
+    for (uint32_t e = 0; e < def->nevents; e++)
+    {
+        fputs(e ? ",\n  " : "\n  ", out);
+        json_name(out, stats->event_names, e);
+        fputs(": ", out);
+        json_hist(out, &stats->latency[e]);
+    }
+    fputs("}}\n", out);
+}
@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fsm_table.h"
+
+// 构建时每个状态的规则
+typedef struct
+{
+    uint32_t state;
+    uint32_t count;         // 有效规则数量
+    uint32_t first;         // 在排序后的规则数组中的起始位置
+}stc_sparse_row_t;
+
+static int row_cmp(const void *a, const void *b)
+{
+    const stc_fsm_row_t *x = *(const stc_fsm_row_t *const *)a;
+    const stc_fsm_row_t *y = *(const stc_fsm_row_t *const *)b;
+    if (x->state != y->state) return x->state < y->state ? -1 : 1;
+    return x->event < y->event ? -1 : x->event > y->event;
+}
+
+// 规则多的状态先放置，减少空洞
+static int count_cmp(const void *a, const void *b)
+{
+    const stc_sparse_row_t *x = a;
+    const stc_sparse_row_t *y = b;
+    if (x->count != y->count) return x->count > y->count ? -1 : 1;
+    return x->state < y->state ? -1 : x->state > y->state;
+}
+
+/**
+ * @brief   扩大 check/entries，新的位置标记为空闲
+*/
+static int sparse_grow(stc_fsm_sparse_t *table, uint32_t size)
+{
+    if (size <= table->size)
+    {
+        return 0;
+    }
+    uint32_t cap = table->size ? table->size : 64;
+    while (cap < size)
+    {
+        cap *= 2;
+    }
+    uint32_t *check = realloc(table->check, cap * sizeof(*check));
+    if (check == NULL)
+    {
+        return -1;
+    }
+    table->check = check;
+    stc_fsm_entry_t *entries = realloc(table->entries, cap * sizeof(*entries));
+    if (entries == NULL)
+    {
+        return -1;
+    }
+    table->entries = entries;
+    for (uint32_t i = table->size; i < cap; i++)
+    {
+        check[i] = FSM_NONE;
+        entries[i].action = NULL;
+        entries[i].next_state = FSM_NONE;
+    }
+    table->size = cap;
+    return 0;
+}
+
+int fsm_sparse_build(stc_fsm_sparse_t *table, const stc_fsm_row_t *rows, size_t count,
+                     uint32_t nstates, uint32_t nevents)
+{
+    memset(table, 0, sizeof(*table));
+    table->nstates = nstates;
+    table->nevents = nevents;
+    table->base = calloc(nstates ? nstates : 1, sizeof(*table->base));
+    const stc_fsm_row_t **sorted = malloc((count ? count : 1) * sizeof(*sorted));
+    stc_sparse_row_t *states = calloc(nstates ? nstates : 1, sizeof(*states));
+    int ret = -1;
+    if (table->base == NULL || sorted == NULL || states == NULL)
+    {
+        goto out;
+    }
+
+    // 按 [现态][条件] 排序，同时检查范围以及重复
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (rows[i].state >= nstates || rows[i].event >= nevents)
+        {
+            goto out;
+        }
+        if (rows[i].next_state != FSM_NONE)
+        {
+            sorted[n++] = &rows[i];
+        }
+    }
+    qsort(sorted, n, sizeof(*sorted), row_cmp);
+    for (uint32_t s = 0; s < nstates; s++)
+    {
+        states[s].state = s;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i > 0 && sorted[i]->state == sorted[i - 1]->state && sorted[i]->event == sorted[i - 1]->event)
+        {
+            goto out;
+        }
+        stc_sparse_row_t *st = &states[sorted[i]->state];
+        if (st->count++ == 0)
+        {
+            st->first = (uint32_t)i;
+        }
+    }
+    qsort(states, nstates, sizeof(*states), count_cmp);
+
+    // 查找时不做边界检查，保证任何 base + event 都在数组内
+    if (sparse_grow(table, nevents) != 0)
+    {
+        goto out;
+    }
+    uint32_t lowest = 0;
+    for (uint32_t s = 0; s < nstates && states[s].count > 0; s++)
+    {
+        const stc_fsm_row_t *const *row = &sorted[states[s].first];
+        // 首次适配: 从最低的空闲位置开始找一个所有规则都不冲突的偏移
+        while (table->check[lowest] != FSM_NONE)
+        {
+            lowest++;
+        }
+        uint32_t base = lowest > row[0]->event ? lowest - row[0]->event : 0;
+        for (;; base++)
+        {
+            if (sparse_grow(table, base + nevents) != 0)
+            {
+                goto out;
+            }
+            uint32_t k = 0;
+            while (k < states[s].count && table->check[base + row[k]->event] == FSM_NONE)
+            {
+                k++;
+            }
+            if (k == states[s].count)
+            {
+                break;
+            }
+        }
+        table->base[states[s].state] = base;
+        for (uint32_t k = 0; k < states[s].count; k++)
+        {
+            table->check[base + row[k]->event] = row[k]->state;
+            table->entries[base + row[k]->event].action = row[k]->action;
+            table->entries[base + row[k]->event].next_state = row[k]->next_state;
+        }
+    }
+
+    // 去掉末尾没有用到的空间
+    uint32_t used = nevents ? nevents : 1;
+    for (uint32_t s = 0; s < nstates; s++)
+    {
+        if (table->base[s] + nevents > used)
+        {
+            used = table->base[s] + nevents;
+        }
+    }
+    uint32_t *check = realloc(table->check, used * sizeof(*check));
+    stc_fsm_entry_t *entries = check != NULL ? realloc(table->entries, used * sizeof(*entries)) : NULL;
+    table->check = check != NULL ? check : table->check;
+    table->entries = entries != NULL ? entries : table->entries;
+    table->size = used;
+    ret = 0;
+
+out:
+    free(sorted);
+    free(states);
+    if (ret != 0)
+    {
+        fsm_sparse_free(table);
+    }
+    return ret;
+}
+
+void fsm_sparse_free(stc_fsm_sparse_t *table)
+{
+    free(table->base);
+    free(table->check);
+    free(table->entries);
+    memset(table, 0, sizeof(*table));
+}
+
+const stc_fsm_row_t *fsm_linear_lookup(const stc_fsm_row_t *rows, size_t count,
+                                       uint32_t state, uint32_t event)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (rows[i].state == state && rows[i].event == event)
+        {
+            return rows[i].next_state != FSM_NONE ? &rows[i] : NULL;
+        }
+    }
+    return NULL;
+}
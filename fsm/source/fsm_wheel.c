@@ -0,0 +1,320 @@
+#include <stdlib.h>
+#include "fsm_wheel.h"
+
+_Static_assert(FSM_WHEEL_BITS * FSM_WHEEL_LEVELS < 64, "wheel range must fit in 64 bits");
+_Static_assert(FSM_WHEEL_LEVELS * FSM_WHEEL_SLOTS < UINT16_MAX, "slot index must fit in 16 bits");
+
+// 空闲节点的槽
+#define SLOT_FREE       UINT16_MAX
+// 最大延迟
+#define MAX_TICKS       ((1ull << (FSM_WHEEL_BITS * FSM_WHEEL_LEVELS)) - 1)
+
+void fsm_wheel_post(void *arg, uint32_t data)
+{
+    fsm_post(arg, data);
+}
+
+int fsm_wheel_init(stc_fsm_wheel_t *wheel, uint32_t capacity, uint64_t tick_ns, fsm_wheel_cb_t expire)
+{
+    wheel->nodes = malloc((size_t)capacity * sizeof(stc_fsm_timer_node_t));
+    if (wheel->nodes == NULL)
+    {
+        return -1;
+    }
+    wheel->tick_ns = tick_ns ? tick_ns : 1;
+    wheel->base_ns = 0;
+    wheel->now = 0;
+    wheel->count = 0;
+    wheel->capacity = capacity;
+    wheel->expire = expire != NULL ? expire : fsm_wheel_post;
+    wheel->io = NULL;
+    wheel->armed = 0;
+    for (uint32_t i = 0; i < FSM_WHEEL_LEVELS * FSM_WHEEL_SLOTS; i++)
+    {
+        wheel->slots[i] = FSM_WHEEL_NIL;
+    }
+    // 所有节点串成空闲链表
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        wheel->nodes[i].next = i + 1 < capacity ? i + 1 : FSM_WHEEL_NIL;
+        wheel->nodes[i].slot = SLOT_FREE;
+        wheel->nodes[i].gen = 1;
+    }
+    wheel->free = capacity ? 0 : FSM_WHEEL_NIL;
+    return 0;
+}
+
+void fsm_wheel_free(stc_fsm_wheel_t *wheel)
+{
+    free(wheel->nodes);
+    wheel->nodes = NULL;
+    wheel->capacity = 0;
+    wheel->free = FSM_WHEEL_NIL;
+}
+
+/**
+ * @brief   根据到期时间把节点放入对应的层和槽
+*/
+static void wheel_place(stc_fsm_wheel_t *wheel, uint32_t index)
+{
+    stc_fsm_timer_node_t *node = &wheel->nodes[index];
+    uint64_t delta = node->expires - wheel->now;
+    uint32_t level = 0;
+    while (level + 1 < FSM_WHEEL_LEVELS && delta >= (1ull << (FSM_WHEEL_BITS * (level + 1))))
+    {
+        level++;
+    }
+    uint32_t slot = level * FSM_WHEEL_SLOTS
+                  + (uint32_t)((node->expires >> (FSM_WHEEL_BITS * level)) & (FSM_WHEEL_SLOTS - 1));
+    node->slot = (uint16_t)slot;
+    node->prev = FSM_WHEEL_NIL;
+    node->next = wheel->slots[slot];
+    if (node->next != FSM_WHEEL_NIL)
+    {
+        wheel->nodes[node->next].prev = index;
+    }
+    wheel->slots[slot] = index;
+}
+
+/**
+ * @brief   把节点从所在的槽中移除
+*/
+static void wheel_unlink(stc_fsm_wheel_t *wheel, uint32_t index)
+{
+    stc_fsm_timer_node_t *node = &wheel->nodes[index];
+    if (node->prev != FSM_WHEEL_NIL)
+    {
+        wheel->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        wheel->slots[node->slot] = node->next;
+    }
+    if (node->next != FSM_WHEEL_NIL)
+    {
+        wheel->nodes[node->next].prev = node->prev;
+    }
+}
+
+/**
+ * @brief   回收节点，代数加1使旧句柄失效
+*/
+static void wheel_release(stc_fsm_wheel_t *wheel, uint32_t index)
+{
+    stc_fsm_timer_node_t *node = &wheel->nodes[index];
+    node->slot = SLOT_FREE;
+    node->gen = (uint16_t)(node->gen + 1) ? (uint16_t)(node->gen + 1) : 1;
+    node->next = wheel->free;
+    wheel->free = index;
+    wheel->count--;
+}
+
+/**
+ * @brief   把高层一个槽中的定时器重新分配到低层
+*/
+static void wheel_cascade(stc_fsm_wheel_t *wheel, uint32_t slot)
+{
+    uint32_t index = wheel->slots[slot];
+    wheel->slots[slot] = FSM_WHEEL_NIL;
+    while (index != FSM_WHEEL_NIL)
+    {
+        uint32_t next = wheel->nodes[index].next;
+        wheel_place(wheel, index);
+        index = next;
+    }
+}
+
+/**
+ * @brief   设定 timerfd 在 tick 到期
+*/
+static void wheel_arm(stc_fsm_wheel_t *wheel, uint64_t tick)
+{
+    uint64_t deadline = wheel->base_ns + tick * wheel->tick_ns;
+    uint64_t now = fsm_loop_now();
+    fsm_loop_timer_start(wheel->io, deadline > now ? deadline - now : 1);
+    wheel->armed = tick;
+}
+
+/**
+ * @brief   低层下一圈开始的tick，此时需要把高层的定时器分配下来
+*/
+static uint64_t wheel_boundary(const stc_fsm_wheel_t *wheel)
+{
+    return (wheel->now | (FSM_WHEEL_SLOTS - 1)) + 1;
+}
+
+/**
+ * @brief   下一次需要推进的tick: 低层这一圈内下一个非空的槽，没有时为这一圈结束
+ * @note    高层的定时器最早在低层下一圈开始时分配下来，不会更早到期
+*/
+static uint64_t wheel_next(const stc_fsm_wheel_t *wheel)
+{
+    uint64_t boundary = wheel_boundary(wheel);
+    for (uint64_t tick = wheel->now + 1; tick < boundary; tick++)
+    {
+        if (wheel->slots[tick & (FSM_WHEEL_SLOTS - 1)] != FSM_WHEEL_NIL)
+        {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+uint64_t fsm_wheel_current(const stc_fsm_wheel_t *wheel)
+{
+    if (wheel->io == NULL)
+    {
+        return wheel->now;
+    }
+    uint64_t tick = (fsm_loop_now() - wheel->base_ns) / wheel->tick_ns;
+    return tick > wheel->now ? tick : wheel->now;
+}
+
+fsm_timer_t fsm_wheel_start(stc_fsm_wheel_t *wheel, uint64_t ticks, void *arg, uint32_t data)
+{
+    uint32_t index = wheel->free;
+    if (index == FSM_WHEEL_NIL)
+    {
+        return 0;
+    }
+    // timerfd 只在到期时唤醒，now 可能落后于当前时间，延迟从当前时间开始计算
+    uint64_t current = fsm_wheel_current(wheel);
+    if (wheel->io != NULL && wheel->count == 0)
+    {
+        // 空闲时 timerfd 没有运行，先追上当前时间
+        wheel->now = current;
+        wheel->armed = 0;
+    }
+    stc_fsm_timer_node_t *node = &wheel->nodes[index];
+    wheel->free = node->next;
+    wheel->count++;
+    ticks = ticks ? ticks : 1;
+    node->expires = current + ticks;
+    if (node->expires - wheel->now > MAX_TICKS)
+    {
+        node->expires = wheel->now + MAX_TICKS;
+    }
+    node->arg = arg;
+    node->data = data;
+    wheel_place(wheel, index);
+    if (wheel->io != NULL)
+    {
+        // 比设定的时间早时提前设定，高层的定时器在这一圈结束时再处理
+        uint64_t boundary = wheel_boundary(wheel);
+        uint64_t tick = node->expires < boundary ? node->expires : boundary;
+        if (wheel->armed == 0 || tick < wheel->armed)
+        {
+            wheel_arm(wheel, tick);
+        }
+    }
+    return ((uint64_t)node->gen << 32) | index;
+}
+
+int fsm_wheel_cancel(stc_fsm_wheel_t *wheel, fsm_timer_t timer)
+{
+    uint32_t index = (uint32_t)timer;
+    if (timer == 0 || index >= wheel->capacity)
+    {
+        return -1;
+    }
+    stc_fsm_timer_node_t *node = &wheel->nodes[index];
+    if (node->slot == SLOT_FREE || node->gen != (uint16_t)(timer >> 32))
+    {
+        return -1;
+    }
+    wheel_unlink(wheel, index);
+    wheel_release(wheel, index);
+    return 0;
+}
+
+size_t fsm_wheel_advance(stc_fsm_wheel_t *wheel, uint64_t tick)
+{
+    size_t expired = 0;
+    while (wheel->now < tick)
+    {
+        if (wheel->count == 0)
+        {
+            // 没有定时器，直接跳到目标时间
+            wheel->now = tick;
+            break;
+        }
+        wheel->now++;
+        uint32_t index = (uint32_t)(wheel->now & (FSM_WHEEL_SLOTS - 1));
+        if (index == 0)
+        {
+            // 低层转完一圈，依次把上一层的当前槽分配下来
+            for (uint32_t level = 1; level < FSM_WHEEL_LEVELS; level++)
+            {
+                uint32_t i = (uint32_t)((wheel->now >> (FSM_WHEEL_BITS * level)) & (FSM_WHEEL_SLOTS - 1));
+                wheel_cascade(wheel, level * FSM_WHEEL_SLOTS + i);
+                if (i != 0)
+                {
+                    break;
+                }
+            }
+        }
+        // 每次取出槽内第一个节点，回调中可以取消同一个槽中的其他定时器
+        uint32_t head;
+        while ((head = wheel->slots[index]) != FSM_WHEEL_NIL)
+        {
+            stc_fsm_timer_node_t *node = &wheel->nodes[head];
+            void *arg = node->arg;
+            uint32_t data = node->data;
+            wheel_unlink(wheel, head);
+            wheel_release(wheel, head);
+            wheel->expire(arg, data);
+            expired++;
+        }
+    }
+    return expired;
+}
+
+/**
+ * @brief   timerfd 回调: 推进到当前时间，然后设定下一次到期的时间，没有定时器时停止 timerfd
+ * @note    定时器被取消后可能多唤醒一次，推进之后重新计算
+*/
+static void wheel_tick_callback(stc_fsm_io_t *io, uint32_t events)
+{
+    (void)events;
+    stc_fsm_wheel_t *wheel = io->arg;
+    wheel->armed = 0;
+    fsm_wheel_advance(wheel, (fsm_loop_now() - wheel->base_ns) / wheel->tick_ns);
+    if (wheel->count == 0)
+    {
+        fsm_loop_timer_stop(io);
+    }
+    else
+    {
+        // 回调中启动的定时器已经设定过，这里按所有定时器重新计算
+        wheel_arm(wheel, wheel_next(wheel));
+    }
+}
+
+int fsm_wheel_attach(stc_fsm_wheel_t *wheel, stc_fsm_loop_t *loop, stc_fsm_io_t *io)
+{
+    if (fsm_loop_timer_init(loop, io, wheel_tick_callback, wheel) != 0)
+    {
+        return -1;
+    }
+    wheel->io = io;
+    wheel->base_ns = fsm_loop_now();
+    wheel->now = 0;
+    wheel->armed = 0;
+    if (wheel->count > 0)
+    {
+        wheel_arm(wheel, wheel_next(wheel));
+    }
+    return 0;
+}
+
+static int wheel_clock_start(void *impl, uint64_t ticks, void *arg, uint32_t data)
+{
+    return fsm_wheel_start(impl, ticks, arg, data) != 0 ? 0 : -1;
+}
+
+void fsm_wheel_clock(stc_fsm_wheel_t *wheel, stc_fsm_clock_t *clock)
+{
+    clock->impl = wheel;
+    clock->now = &wheel->now;
+    clock->start = wheel_clock_start;
+}